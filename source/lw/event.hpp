@@ -2,6 +2,7 @@
 
 #include "lw/event/BasicStream.hpp"
 #include "lw/event/Emitter.hpp"
+#include "lw/event/Framer.hpp"
 #include "lw/event/Idle.hpp"
 #include "lw/event/Loop.hpp"
 #include "lw/event/Promise.hpp"
@@ -1,7 +1,14 @@
 
+#include <cerrno>
 #include <cstdlib>
 #include <uv.h>
 
+#ifdef __linux__
+#   include <fcntl.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
 #include "lw/event/BasicStream.hpp"
 #include "lw/event/Promise.impl.hpp"
 
@@ -18,6 +25,232 @@ namespace _details {
         Promise< std::size_t > promise;
         std::size_t size;
     };
+
+    struct ShutdownRequest {
+        ShutdownRequest(void){
+            request.data = (void*)this;
+        }
+
+        uv_shutdown_t request;
+        Promise<> promise;
+    };
+
+    struct PipeRequest {
+        PipeRequest(void):
+            bytes_written(0),
+            pending_writes(0),
+            paused(false),
+            ended(false)
+        {}
+
+        Promise<std::size_t> promise;
+        std::size_t bytes_written;
+        std::size_t pending_writes;
+        bool paused;
+        bool ended;
+    };
+
+    struct ExactReadRequest {
+        ExactReadRequest(memory::Buffer&& _buffer):
+            buffer(std::move(_buffer)),
+            filled(0)
+        {}
+
+        memory::Buffer buffer;
+        memory::Buffer view;
+        std::size_t filled;
+        Promise<memory::Buffer> promise;
+    };
+
+#ifdef __linux__
+    /// @brief The most chunks moved in one go before letting the loop do other work.
+    const int SPLICES_PER_TURN = 16;
+
+    struct SplicePump {
+        SplicePump(void):
+            in_fd(-1),
+            out_fd(-1),
+            total(0),
+            error(0),
+            open_handles(0)
+        {
+            in_poll.data = (void*)this;
+            out_poll.data = (void*)this;
+        }
+
+        ~SplicePump(void){
+            if (in_fd >= 0) {
+                ::close(in_fd);
+            }
+            if (out_fd >= 0) {
+                ::close(out_fd);
+            }
+        }
+
+        uv_poll_t in_poll;
+        uv_poll_t out_poll;
+        int in_fd;                          ///< Our own copy of the source's descriptor.
+        int out_fd;                         ///< Our own copy of the destination's descriptor.
+        std::size_t total;
+        int error;                          ///< A libuv error code, or 0.
+        int open_handles;
+        Promise<std::size_t> promise;
+        std::shared_ptr<void> source;       ///< Keeps the source stream alive during the splice.
+        std::shared_ptr<void> destination;  ///< Keeps the destination alive during the splice.
+    };
+
+    // ------------------------------------------------------------------------------------------ //
+
+    inline bool is_fifo(const int fd){
+        struct stat info;
+        return ::fstat(fd, &info) == 0 && S_ISFIFO(info.st_mode);
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Closes the poll handles, settling the promise once both are gone.
+    void finish_splice(SplicePump* pump, const int error){
+        pump->error = error;
+        for (uv_poll_t* poll : {&pump->in_poll, &pump->out_poll}) {
+            uv_close((uv_handle_t*)poll, [](uv_handle_t* handle){
+                auto* pump = (SplicePump*)handle->data;
+                if (--pump->open_handles > 0) {
+                    return;
+                }
+
+                std::unique_ptr<SplicePump> owner(pump);
+                if (pump->error) {
+                    pump->promise.reject(LW_UV_ERROR(StreamError, pump->error));
+                }
+                else {
+                    pump->promise.resolve(pump->total);
+                }
+            });
+        }
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    void splice_step(SplicePump* pump);
+
+    /// @brief Waits for room in the destination, then carries on splicing.
+    void wait_writable(SplicePump* pump){
+        const int res = uv_poll_start(
+            &pump->out_poll,
+            UV_WRITABLE,
+            [](uv_poll_t* handle, int status, int){
+                auto* pump = (SplicePump*)handle->data;
+                uv_poll_stop(handle);
+                if (status < 0) {
+                    finish_splice(pump, status);
+                }
+                else {
+                    splice_step(pump);
+                }
+            }
+        );
+        if (res < 0) {
+            finish_splice(pump, res);
+        }
+    }
+
+    /// @brief Waits for data in the source, then for room in the destination.
+    void wait_readable(SplicePump* pump){
+        const int res = uv_poll_start(
+            &pump->in_poll,
+            UV_READABLE,
+            [](uv_poll_t* handle, int status, int){
+                auto* pump = (SplicePump*)handle->data;
+                uv_poll_stop(handle);
+                if (status < 0) {
+                    finish_splice(pump, status);
+                }
+                else {
+                    wait_writable(pump);
+                }
+            }
+        );
+        if (res < 0) {
+            finish_splice(pump, res);
+        }
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Moves data between the descriptors without blocking until one side is not ready.
+    void splice_step(SplicePump* pump){
+        const std::size_t chunk_size = 64 * 1024;
+        for (int i = 0; i < SPLICES_PER_TURN; ++i) {
+            ssize_t moved = ::splice(
+                pump->in_fd, nullptr,
+                pump->out_fd, nullptr,
+                chunk_size,
+                SPLICE_F_MOVE | SPLICE_F_NONBLOCK | SPLICE_F_MORE
+            );
+            if (moved > 0) {
+                pump->total += moved;
+            }
+            else if (moved == 0) {
+                finish_splice(pump, 0); // End of the input.
+                return;
+            }
+            else if (errno == EAGAIN) {
+                // One side is not ready, wait for data to read and then for space to write it.
+                wait_readable(pump);
+                return;
+            }
+            else if (errno != EINTR) {
+                finish_splice(pump, -errno);
+                return;
+            }
+        }
+
+        // Still going, so give the rest of the loop a turn before the next batch.
+        wait_writable(pump);
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Splices from one descriptor to another on the loop thread, driven by readiness.
+    ///
+    /// The descriptors are duplicated so polling them does not clash with the streams' own
+    /// watchers.
+    Future<std::size_t> splice(
+        uv_loop_t* loop,
+        const int in_fd,
+        const int out_fd,
+        std::shared_ptr<void> source,
+        std::shared_ptr<void> destination
+    ){
+        std::unique_ptr<SplicePump> pump(new SplicePump());
+        pump->in_fd = ::dup(in_fd);
+        pump->out_fd = pump->in_fd < 0 ? -1 : ::dup(out_fd);
+        if (pump->in_fd < 0 || pump->out_fd < 0) {
+            throw LW_UV_ERROR(StreamError, -errno);
+        }
+
+        int res = uv_poll_init(loop, &pump->in_poll, pump->in_fd);
+        if (res < 0) {
+            throw LW_UV_ERROR(StreamError, res);
+        }
+        ++pump->open_handles;
+        res = uv_poll_init(loop, &pump->out_poll, pump->out_fd);
+        if (res < 0) {
+            // The first handle has to be closed through the loop before the pump can go.
+            uv_close((uv_handle_t*)&pump.release()->in_poll, [](uv_handle_t* handle){
+                delete (SplicePump*)handle->data;
+            });
+            throw LW_UV_ERROR(StreamError, res);
+        }
+        ++pump->open_handles;
+
+        pump->source      = std::move(source);
+        pump->destination = std::move(destination);
+        auto future = pump->promise.future();
+        splice_step(pump.release());
+        return future;
+    }
+#endif
 }
 
 // ---------------------------------------------------------------------------------------------- //
@@ -42,9 +275,12 @@ BasicStream::_State::~_State(void){
 
 void BasicStream::state(const std::shared_ptr<_State>& state){
     m_state = state;
-    m_state->handle->data   = (void*)m_state.get();
-    m_state->read_count     = 0;
-    m_state->read_callback  = nullptr;
+    m_state->handle->data       = (void*)m_state.get();
+    m_state->read_count         = 0;
+    m_state->high_water_mark    = 64 * 1024;
+    m_state->read_callback      = nullptr;
+    m_state->pull_buffer        = nullptr;
+    m_state->read_allocator     = nullptr;
 }
 
 // ---------------------------------------------------------------------------------------------- //
@@ -60,6 +296,42 @@ void BasicStream::stop_read( void ){
 
 // ---------------------------------------------------------------------------------------------- //
 
+Future<std::size_t> BasicStream::read_some(memory::Buffer& buffer){
+    if (m_state->read_callback || m_state->pull_promise) {
+        throw StreamError(1, "Cannot pull from a stream that is already being read.");
+    }
+    if (buffer.size() == 0) {
+        throw StreamError(2, "Cannot pull into an empty buffer.");
+    }
+
+    m_state->pull_buffer    = &buffer;
+    m_state->pull_promise   = std::make_unique<Promise<std::size_t>>();
+    auto future = m_state->pull_promise->future();
+    try {
+        _read_start();
+    }
+    catch (...) {
+        m_state->pull_buffer = nullptr;
+        m_state->pull_promise.reset();
+        throw;
+    }
+    return future;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+Future<memory::Buffer> BasicStream::read_exactly(const std::size_t bytes){
+    if (bytes == 0) {
+        throw StreamError(2, "Cannot pull into an empty buffer.");
+    }
+
+    auto request = std::make_shared<_details::ExactReadRequest>(_allocate(bytes));
+    _read_exactly(request);
+    return request->promise.future();
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
 Future< std::size_t > BasicStream::write( buffer_ptr_t buffer ){
     auto write_req = std::make_shared< _details::WriteRequest >();
     write_req->size = buffer->size();
@@ -95,13 +367,194 @@ Future< std::size_t > BasicStream::write( buffer_ptr_t buffer ){
 
 // ---------------------------------------------------------------------------------------------- //
 
+Future<std::size_t> BasicStream::write(chain_ptr_t chain){
+    auto write_req = std::make_shared<_details::WriteRequest>();
+    write_req->size = chain->size();
+    const std::vector<uv_buf_t> buffers = chain->uv_buffers();
+    int res = uv_write(
+        &write_req->request,
+        m_state->handle,
+        buffers.data(), buffers.size(),
+        [](uv_write_t* req, int status){
+            auto* write_req = (_details::WriteRequest*)req->data;
+            if (status < 0) {
+                write_req->promise.reject(LW_UV_ERROR(StreamError, status));
+            }
+            else {
+                write_req->promise.resolve(write_req->size);
+            }
+        }
+    );
+
+    if (res < 0) {
+        throw LW_UV_ERROR(StreamError, res);
+    }
+
+    // Hold the chain, and with it the memory being written, until the write is done.
+    return write_req->promise.future()
+        .then([write_req, chain](const std::size_t bytes_written){
+            return bytes_written;
+        })
+    ;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+Future<> BasicStream::shutdown(void){
+    auto shutdown_req = std::make_shared<_details::ShutdownRequest>();
+    int res = uv_shutdown(
+        &shutdown_req->request,
+        m_state->handle,
+        [](uv_shutdown_t* req, int status){
+            auto* shutdown_req = (_details::ShutdownRequest*)req->data;
+            if (status < 0) {
+                shutdown_req->promise.reject(LW_UV_ERROR(StreamError, status));
+            }
+            else {
+                shutdown_req->promise.resolve();
+            }
+        }
+    );
+
+    if (res < 0) {
+        throw LW_UV_ERROR(StreamError, res);
+    }
+
+    auto state = m_state;
+    return shutdown_req->promise.future().then([shutdown_req, state](){});
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+Future<std::size_t> BasicStream::pipe_to(BasicStream& destination){
+    auto source = m_state;
+    auto sink   = destination.m_state;
+
+#ifdef __linux__
+    // When both ends are plain descriptors and one of them is a pipe, the kernel can move the data
+    // for us without it ever entering userspace. A checksum has to see the data, so it keeps the
+    // copy through userspace.
+    uv_os_fd_t in_fd    = -1;
+    uv_os_fd_t out_fd   = -1;
+    if (
+        !source->read_callback && !source->pull_promise && !source->read_digest &&
+        uv_stream_get_write_queue_size(sink->handle) == 0 &&
+        uv_fileno((uv_handle_t*)source->handle, &in_fd) == 0 &&
+        uv_fileno((uv_handle_t*)sink->handle, &out_fd) == 0 &&
+        (_details::is_fifo(in_fd) || _details::is_fifo(out_fd))
+    ){
+        return _details::splice(source->handle->loop, in_fd, out_fd, source, sink);
+    }
+#endif
+
+    auto pipe_req = std::make_shared<_details::PipeRequest>();
+    auto finish = [pipe_req](){
+        if (pipe_req->ended && pipe_req->pending_writes == 0 && !pipe_req->promise.is_finished()) {
+            pipe_req->promise.resolve(pipe_req->bytes_written);
+        }
+    };
+    auto fail = [pipe_req, source](const error::Exception& err){
+        if (pipe_req->promise.is_finished()) {
+            return;
+        }
+        if (!pipe_req->ended) {
+            pipe_req->ended = true;
+            uv_read_stop(source->handle);
+            source->read_callback = nullptr;
+        }
+        pipe_req->promise.reject(err);
+    };
+
+    read([pipe_req, source, sink, finish, fail](const buffer_ptr_t& buffer){
+        ++pipe_req->pending_writes;
+        try {
+            BasicStream(sink).write(buffer).then(
+                [pipe_req, source, sink, finish](const std::size_t bytes){
+                    --pipe_req->pending_writes;
+                    pipe_req->bytes_written += bytes;
+                    if (
+                        pipe_req->paused && !pipe_req->ended &&
+                        uv_stream_get_write_queue_size(sink->handle) <= sink->high_water_mark / 2
+                    ){
+                        pipe_req->paused = false;
+                        BasicStream(source)._read_start();
+                    }
+                    finish();
+                },
+                [pipe_req, fail](const error::Exception& err){
+                    --pipe_req->pending_writes;
+                    fail(err);
+                }
+            );
+        }
+        catch (const error::Exception& err) {
+            --pipe_req->pending_writes;
+            fail(err);
+            return;
+        }
+
+        // Apply backpressure if the destination is falling behind.
+        if (uv_stream_get_write_queue_size(sink->handle) > sink->high_water_mark) {
+            pipe_req->paused = true;
+            uv_read_stop(source->handle);
+        }
+    }).then(
+        [pipe_req, finish](const std::size_t){
+            pipe_req->ended = true;
+            finish();
+        },
+        fail
+    );
+
+    return pipe_req->promise.future();
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+std::size_t BasicStream::write_queue_size(void) const {
+    return uv_stream_get_write_queue_size(m_state->handle);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+int BasicStream::fileno(void) const {
+    uv_os_fd_t fd = -1;
+    if (uv_fileno((const uv_handle_t*)m_state->handle, &fd) < 0) {
+        return -1;
+    }
+    return fd;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
 Future<std::size_t> BasicStream::_read(void){
+    if (m_state->pull_promise) {
+        m_state->read_callback = nullptr;
+        throw StreamError(1, "Cannot read from a stream that is already being pulled from.");
+    }
+
+    try {
+        _read_start();
+    }
+    catch (...) {
+        m_state->read_callback = nullptr;
+        throw;
+    }
+
+    return m_state->read_promise.future();
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void BasicStream::_read_start(void){
     int res = uv_read_start(
         m_state->handle,
         [](uv_handle_t* handle, std::size_t size, uv_buf_t* out_buffer){
-            // Allocate a buffer for libuv to read into.
+            // Allocate a buffer for libuv to read into, using the caller's if they are pulling.
             auto state = ((_State*)handle->data)->shared_from_this();
-            memory::Buffer& buffer = BasicStream( state )._next_read_buffer();
+            memory::Buffer& buffer = state->pull_buffer
+                ? *state->pull_buffer
+                : BasicStream( state )._next_read_buffer();
             *out_buffer = uv_buf_init((char*)buffer.data(), buffer.size());
         },
         [](uv_stream_t* handle, long int size, const uv_buf_t* buffer){
@@ -109,14 +562,34 @@ Future<std::size_t> BasicStream::_read(void){
             auto state  = ((_State*)handle->data)->shared_from_this();
             auto stream = BasicStream(state);
 
+            if (state->pull_promise) {
+                // The data went straight into the caller's buffer.
+                stream._finish_pull(size);
+                return;
+            }
+
+            if (size <= 0 && buffer->base) {
+                // Nothing was read into the buffer, so it can go straight back to the pool.
+                stream._release_read_buffer(buffer->base);
+            }
+
             if (size == UV_EOF) {
                 // End of file, trigger a stop.
                 stream._stop_read();
                 state.reset();
             }
-            else {
+            else if (size < 0) {
+                // Read failed, stop reading and report it.
+                uv_read_stop(handle);
+                stream._fail_read(LW_UV_ERROR(StreamError, size));
+                state.reset();
+            }
+            else if (size > 0) {
                 // More data is available, update our state and call back.
                 state->read_count += size;
+                if (state->read_digest) {
+                    state->read_digest->update(buffer->base, size);
+                }
                 state->read_callback(
                     buffer_ptr_t(
                         new memory::Buffer((memory::byte*)buffer->base, size),
@@ -132,16 +605,14 @@ Future<std::size_t> BasicStream::_read(void){
     );
 
     if (res < 0) {
-        m_state->read_callback = nullptr;
         throw LW_UV_ERROR(StreamError, res);
     }
-
-    return m_state->read_promise.future();
 }
 
 // ---------------------------------------------------------------------------------------------- //
 
 void BasicStream::_stop_read( void ){
+    m_state->read_callback = nullptr;
     m_state->read_promise.resolve( m_state->read_count );
     m_state->read_promise.reset();
     m_state->read_count = 0;
@@ -149,9 +620,76 @@ void BasicStream::_stop_read( void ){
 
 // ---------------------------------------------------------------------------------------------- //
 
+void BasicStream::_finish_pull(const long int size){
+    if (size == 0) {
+        return; // Nothing read yet, keep waiting.
+    }
+
+    // Pause the stream until the next pull so nothing gets buffered in between.
+    uv_read_stop(m_state->handle);
+    memory::Buffer* buffer = m_state->pull_buffer;
+    m_state->pull_buffer = nullptr;
+    auto promise = std::move(m_state->pull_promise);
+    if (size == UV_EOF) {
+        promise->resolve(0);
+    }
+    else if (size < 0) {
+        promise->reject(LW_UV_ERROR(StreamError, size));
+    }
+    else {
+        if (m_state->read_digest) {
+            m_state->read_digest->update(buffer->data(), size);
+        }
+        promise->resolve((std::size_t)size);
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void BasicStream::_read_exactly(const std::shared_ptr<_details::ExactReadRequest>& request){
+    request->view = memory::Buffer(
+        request->buffer.data() + request->filled,
+        request->buffer.size() - request->filled
+    );
+
+    auto state = m_state;
+    read_some(request->view).then(
+        [state, request](const std::size_t bytes){
+            if (bytes == 0) {
+                request->promise.reject(
+                    StreamError(UV_EOF, "Stream ended before enough data was read.")
+                );
+                return;
+            }
+
+            request->filled += bytes;
+            if (request->filled == request->buffer.size()) {
+                request->promise.resolve(std::move(request->buffer));
+            }
+            else {
+                BasicStream(state)._read_exactly(request);
+            }
+        },
+        [request](const error::Exception& err){
+            request->promise.reject(err);
+        }
+    );
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void BasicStream::_fail_read(const error::Exception& err){
+    m_state->read_callback = nullptr;
+    m_state->read_count = 0;
+    m_state->read_promise.reject(err);
+    m_state->read_promise.reset();
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
 memory::Buffer& BasicStream::_next_read_buffer( void ){
     if( m_state->idle_read_buffers.size() == 0 ){
-        m_state->idle_read_buffers.emplace_back( memory::Buffer( 1024 ) );
+        m_state->idle_read_buffers.emplace_back( _allocate( 1024 ) );
     }
     m_state->active_read_buffers.splice(
         m_state->active_read_buffers.end(),
@@ -163,6 +701,12 @@ memory::Buffer& BasicStream::_next_read_buffer( void ){
 
 // ---------------------------------------------------------------------------------------------- //
 
+memory::Buffer BasicStream::_allocate(const std::size_t size){
+    return memory::Buffer(size, m_state->read_allocator);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
 void BasicStream::_release_read_buffer( const void* base ){
     for(
         auto it = m_state->active_read_buffers.begin();
@@ -2,6 +2,7 @@
 
 #include <functional>
 #include <list>
+#include <memory>
 #include <type_traits>
 
 #include "lw/error.hpp"
@@ -15,12 +16,19 @@ namespace event {
 
 LW_DEFINE_EXCEPTION(StreamError);
 
+namespace _details {
+    struct ExactReadRequest;
+}
+
 /// @brief Base class for asynchronous streams.
 class BasicStream {
 public:
     /// @brief With streams, all buffers must be pointers.
     typedef std::shared_ptr<const memory::Buffer> buffer_ptr_t;
 
+    /// @brief Chains are written by pointer too, so they live until the write is done.
+    typedef std::shared_ptr<const memory::BufferChain> chain_ptr_t;
+
     /// @brief Read callback functor type.
     ///
     /// @param buffer The buffer containing the read data.
@@ -63,6 +71,33 @@ public:
 
     // ------------------------------------------------------------------------------------------ //
 
+    /// @brief Reads the next available chunk of data directly into the given buffer.
+    ///
+    /// The stream only reads while a pull is outstanding, so no data is buffered between calls. It
+    /// is up to the caller to ensure the lifetime of the given buffer exceeds that of the read.
+    ///
+    /// @param buffer The buffer to read into. At most `buffer.size()` bytes will be read.
+    ///
+    /// @throws StreamError If the stream is already being read, or `buffer` is empty.
+    ///
+    /// @return A promise for the number of bytes read, which will be 0 at the end of the stream.
+    Future<std::size_t> read_some(memory::Buffer& buffer);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Reads exactly the given number of bytes from the stream.
+    ///
+    /// @param bytes The number of bytes to read.
+    ///
+    /// @throws StreamError If the stream is already being read, or `bytes` is 0.
+    ///
+    /// @return
+    ///     A promise for a buffer holding exactly `bytes` bytes. The promise is rejected if the
+    ///     stream ends first.
+    Future<memory::Buffer> read_exactly(const std::size_t bytes);
+
+    // ------------------------------------------------------------------------------------------ //
+
     /// @brief Writes the data in the given buffer.
     ///
     /// @param buffer The data to write.
@@ -70,6 +105,95 @@ public:
     /// @return A promise to write the data. The value will be the number of bytes written.
     Future<std::size_t> write(buffer_ptr_t buffer);
 
+    /// @brief Writes every piece of a chain, in order, with a single request.
+    ///
+    /// @param chain The data to write.
+    ///
+    /// @return A promise to write the data. The value will be the number of bytes written.
+    Future<std::size_t> write(chain_ptr_t chain);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Shuts down the writing side of the stream once all pending writes complete.
+    ///
+    /// @return A promise to have shut down the stream.
+    Future<> shutdown(void);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Forwards everything read from this stream into `destination`.
+    ///
+    /// The read buffers are handed directly to `destination.write` without copying them. Reading is
+    /// paused whenever the destination's write queue grows beyond its high-water mark and resumes
+    /// once it has drained below half of that mark.
+    ///
+    /// On Linux, if both streams are backed by raw descriptors and at least one of them is a pipe,
+    /// the data is moved in kernel space with nonblocking `splice(2)` calls instead, made from the
+    /// loop whenever both sides are ready. A stream with `digest_reads` set is always copied
+    /// through userspace so the checksum sees the data.
+    ///
+    /// @param destination The stream to write all the data into.
+    ///
+    /// @return
+    ///     A promise for the total number of bytes written to `destination`, resolved once this
+    ///     stream reaches its end and every write has completed.
+    Future<std::size_t> pipe_to(BasicStream& destination);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Sets the number of queued write bytes at which piped sources will pause.
+    ///
+    /// @param bytes The new high-water mark for this stream's write queue.
+    void high_water_mark(const std::size_t bytes){
+        m_state->high_water_mark = bytes;
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Gets the number of queued write bytes at which piped sources will pause.
+    std::size_t high_water_mark(void) const {
+        return m_state->high_water_mark;
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Sets where the stream gets the buffers it reads into.
+    ///
+    /// A `memory::BufferPool` here recycles read buffers between streams, and they go back to it
+    /// once the stream and every chunk handed out from them are gone. Only buffers allocated after
+    /// the call are affected. The allocator must outlive them.
+    ///
+    /// @param allocator The allocator to use, or null for plain buffers.
+    void read_allocator(memory::Allocator* allocator){
+        m_state->read_allocator = allocator;
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Gets the number of bytes queued for writing but not yet written.
+    std::size_t write_queue_size(void) const;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Gets the operating system descriptor behind the stream.
+    ///
+    /// Anything written straight to the descriptor bypasses the stream's write queue.
+    ///
+    /// @return The descriptor, or -1 if the stream is not open or has none.
+    int fileno(void) const;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Folds everything read from the stream into a checksum.
+    ///
+    /// Data is added as it arrives, before it is handed to readers. Spliced data never reaches
+    /// userspace, so set this before `pipe_to` to keep it off the `splice(2)` path.
+    ///
+    /// @param digest The checksum to add to, or null to stop.
+    void digest_reads(const std::shared_ptr<memory::Crc32c>& digest){
+        m_state->read_digest = digest;
+    }
+
     // ------------------------------------------------------------------------------------------ //
 
 protected:
@@ -77,9 +201,16 @@ protected:
     struct _State : public std::enable_shared_from_this<_State>{
         ~_State(void);
 
-        uv_stream_s*    handle;         ///< The underlying stream handle.
-        std::size_t     read_count;     ///< The running tally of bytes read.
-        read_callback_t read_callback;  ///< The functor to call with read data.
+        uv_stream_s*    handle;             ///< The underlying stream handle.
+        std::size_t     read_count;         ///< The running tally of bytes read.
+        std::size_t     high_water_mark;    ///< Write queue size at which piping pauses.
+        read_callback_t read_callback;      ///< The functor to call with read data.
+        memory::Buffer* pull_buffer;        ///< Caller's buffer for the pending pull.
+        memory::Allocator* read_allocator;  ///< Where read buffers come from, or null for `new[]`.
+
+        std::shared_ptr<memory::Crc32c> read_digest;    ///< Checksum of everything read.
+
+        std::unique_ptr<Promise<std::size_t>> pull_promise; ///< Promise for the pending pull.
 
         Promise<std::size_t> read_promise;              ///< The read promise.
         std::list<memory::Buffer> idle_read_buffers;    ///< List of available read buffers.
@@ -137,6 +268,35 @@ private:
 
     // ------------------------------------------------------------------------------------------ //
 
+    /// @brief Starts libuv reading into the stream's read buffers.
+    ///
+    /// Unlike `_read`, this does not touch the read promise so it can be used to resume a paused
+    /// read.
+    void _read_start(void);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Completes the pending pull with the result of a read.
+    ///
+    /// @param size The number of bytes read, or a libuv error code.
+    void _finish_pull(const long int size);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Pulls data into the remainder of the request's buffer until it is full.
+    ///
+    /// @param request The exact read request to fill.
+    void _read_exactly(const std::shared_ptr<_details::ExactReadRequest>& request);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Rejects the read promise and resets the promise and read count.
+    ///
+    /// @param err The error to reject the read with.
+    void _fail_read(const error::Exception& err);
+
+    // ------------------------------------------------------------------------------------------ //
+
     /// @brief Resolves the read promise and resets the promise and read count.
     void _stop_read( void );
 
@@ -151,6 +311,15 @@ private:
 
     // ------------------------------------------------------------------------------------------ //
 
+    /// @brief Allocates a buffer of exactly the given size from the read allocator.
+    ///
+    /// @param size The number of bytes needed.
+    ///
+    /// @return The new buffer.
+    memory::Buffer _allocate(const std::size_t size);
+
+    // ------------------------------------------------------------------------------------------ //
+
     /// @brief Releases the given buffer, making it available to read into again.
     ///
     /// @param base A pointer to the first byte in the buffer.
@@ -0,0 +1,304 @@
+
+#include <algorithm>
+#include <cstring>
+
+#include "lw/event/Framer.hpp"
+#include "lw/event/Promise.impl.hpp"
+
+namespace lw {
+namespace event {
+
+const std::size_t Framer::default_max_frame_size;
+
+// ---------------------------------------------------------------------------------------------- //
+
+void Framer::_emit_view(
+    const buffer_ptr_t& chunk,
+    const std::size_t offset,
+    const std::size_t size
+){
+    _check_frame_size(size);
+    buffer_ptr_t frame(
+        new memory::Buffer((memory::byte*)chunk->data() + offset, size),
+        [chunk](memory::Buffer* buffer){ delete buffer; }
+    );
+    ++m_frame_count;
+    m_frame_callback(frame);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void Framer::_emit_partial(void){
+    // Hand the reassembly storage over to the frame rather than copying it again.
+    auto storage = std::make_shared<std::vector<memory::byte>>(std::move(m_partial));
+    m_partial.clear();
+    buffer_ptr_t frame(
+        new memory::Buffer(storage->data(), storage->size()),
+        [storage](memory::Buffer* buffer){ delete buffer; }
+    );
+    ++m_frame_count;
+    m_frame_callback(frame);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void Framer::_append_partial(const memory::byte* data, const std::size_t size){
+    _check_frame_size(m_partial.size() + size);
+    m_partial.insert(m_partial.end(), data, data + size);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void Framer::_check_frame_size(const std::size_t size) const {
+    if (size > m_max_frame_size) {
+        throw FramingError(1, "Frame exceeds the maximum frame size.");
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+Future<std::size_t> Framer::_read(BasicStream& stream){
+    auto failure = std::make_shared<std::unique_ptr<error::Exception>>();
+    const std::size_t start_count = m_frame_count;
+    auto source = std::make_shared<BasicStream>(stream);
+
+    return stream.read([this, source, failure](const buffer_ptr_t& chunk){
+        try {
+            feed(chunk);
+        }
+        catch (const error::Exception& err) {
+            *failure = std::make_unique<error::Exception>(err);
+            source->stop_read();
+        }
+    }).then([this, failure, start_count](const std::size_t) -> std::size_t {
+        if (*failure) {
+            throw **failure;
+        }
+        if (has_partial_frame()) {
+            throw FramingError(2, "Stream ended in the middle of a frame.");
+        }
+        return m_frame_count - start_count;
+    });
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void LengthPrefixFramer::feed(const buffer_ptr_t& chunk){
+    const memory::byte* data = chunk->data();
+    const std::size_t size = chunk->size();
+    std::size_t pos = 0;
+
+    while (pos < size) {
+        if (m_in_frame) {
+            // Continue reassembling a frame which began in an earlier chunk.
+            const std::size_t available = std::min(m_frame_size - m_partial.size(), size - pos);
+            _append_partial(data + pos, available);
+            pos += available;
+            if (m_partial.size() == m_frame_size) {
+                m_in_frame = false;
+                _emit_partial();
+            }
+            continue;
+        }
+
+        std::uint64_t frame_size = 0;
+        if (m_header_size > 0) {
+            // The prefix was split across chunks, gather the rest of it a byte at a time.
+            std::size_t header_size = 0;
+            while (pos < size && header_size == 0) {
+                m_header[m_header_size++] = data[pos++];
+                header_size = _decode(m_header, m_header_size, frame_size);
+            }
+            if (header_size == 0) {
+                return;
+            }
+            m_header_size = 0;
+        }
+        else {
+            const std::size_t header_size = _decode(data + pos, size - pos, frame_size);
+            if (header_size == 0) {
+                m_header_size = size - pos;
+                std::memcpy(m_header, data + pos, m_header_size);
+                return;
+            }
+            pos += header_size;
+        }
+
+        _check_frame_size(frame_size);
+        if (size - pos >= frame_size) {
+            _emit_view(chunk, pos, frame_size);
+            pos += frame_size;
+        }
+        else {
+            m_frame_size = frame_size;
+            m_in_frame = true;
+            m_partial.reserve(frame_size);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+std::size_t LengthPrefixFramer::encode(
+    const prefix_type prefix,
+    const std::uint64_t size,
+    memory::byte* out
+){
+    if (prefix == U32_BE) {
+        if (size > 0xffffffffull) {
+            throw FramingError(3, "Frame size does not fit in a 32-bit length prefix.");
+        }
+        out[0] = (memory::byte)(size >> 24);
+        out[1] = (memory::byte)(size >> 16);
+        out[2] = (memory::byte)(size >> 8);
+        out[3] = (memory::byte)(size);
+        return 4;
+    }
+
+    std::uint64_t value = size;
+    std::size_t i = 0;
+    do {
+        out[i] = (memory::byte)(value & 0x7f);
+        value >>= 7;
+        if (value) {
+            out[i] |= 0x80;
+        }
+        ++i;
+    } while (value);
+    return i;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+std::size_t LengthPrefixFramer::_decode(
+    const memory::byte* data,
+    const std::size_t size,
+    std::uint64_t& frame_size
+){
+    if (m_prefix == U32_BE) {
+        if (size < 4) {
+            return 0;
+        }
+        frame_size =
+            ((std::uint64_t)data[0] << 24) |
+            ((std::uint64_t)data[1] << 16) |
+            ((std::uint64_t)data[2] << 8)  |
+            ((std::uint64_t)data[3]);
+        return 4;
+    }
+
+    std::uint64_t value = 0;
+    const std::size_t max_size = sizeof(m_header);
+    for (std::size_t i = 0; i < size && i < max_size; ++i) {
+        value |= (std::uint64_t)(data[i] & 0x7f) << (7 * i);
+        if (!(data[i] & 0x80)) {
+            frame_size = value;
+            return i + 1;
+        }
+    }
+    if (size >= max_size) {
+        throw FramingError(4, "Malformed variable-length prefix.");
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+DelimiterFramer::DelimiterFramer(const std::string& delimiter, const std::size_t max_frame_size):
+    Framer(max_frame_size),
+    m_delimiter(delimiter)
+{
+    if (m_delimiter.empty()) {
+        throw FramingError(5, "Frame delimiter cannot be empty.");
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void DelimiterFramer::feed(const buffer_ptr_t& chunk){
+    const memory::byte* data = chunk->data();
+    const std::size_t size = chunk->size();
+    std::size_t pos = 0;
+
+    if (!m_partial.empty()) {
+        // Finish off the frame started in an earlier chunk, minding delimiters split between them.
+        const std::size_t split = _find_split(data, size);
+        if (split) {
+            m_partial.resize(m_partial.size() - split);
+            pos = m_delimiter.size() - split;
+        }
+        else {
+            const memory::byte* found = _find(data, data + size);
+            if (!found) {
+                _append_partial(data, size);
+                return;
+            }
+            _append_partial(data, found - data);
+            pos = (found - data) + m_delimiter.size();
+        }
+        _emit_partial();
+    }
+
+    while (pos < size) {
+        const memory::byte* found = _find(data + pos, data + size);
+        if (!found) {
+            _append_partial(data + pos, size - pos);
+            return;
+        }
+        _emit_view(chunk, pos, found - (data + pos));
+        pos = (found - data) + m_delimiter.size();
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+const memory::byte* DelimiterFramer::_find(
+    const memory::byte* begin,
+    const memory::byte* end
+) const {
+    // `memchr` is vectorized by the C library, so lean on it to skip to candidate positions.
+    const std::size_t delimiter_size = m_delimiter.size();
+    const memory::byte first = (memory::byte)m_delimiter[0];
+    if (delimiter_size == 1) {
+        return (const memory::byte*)std::memchr(begin, first, end - begin);
+    }
+
+    while ((std::size_t)(end - begin) >= delimiter_size) {
+        const memory::byte* candidate = (const memory::byte*)std::memchr(
+            begin,
+            first,
+            (end - begin) - delimiter_size + 1
+        );
+        if (!candidate) {
+            return nullptr;
+        }
+        if (std::memcmp(candidate + 1, m_delimiter.data() + 1, delimiter_size - 1) == 0) {
+            return candidate;
+        }
+        begin = candidate + 1;
+    }
+    return nullptr;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+std::size_t DelimiterFramer::_find_split(const memory::byte* data, const std::size_t size) const {
+    const std::size_t delimiter_size = m_delimiter.size();
+    for (
+        std::size_t split = std::min(delimiter_size - 1, m_partial.size());
+        split > 0;
+        --split
+    ){
+        if (
+            size >= delimiter_size - split &&
+            std::memcmp(&*(m_partial.end() - split), m_delimiter.data(), split) == 0 &&
+            std::memcmp(data, m_delimiter.data() + split, delimiter_size - split) == 0
+        ){
+            return split;
+        }
+    }
+    return 0;
+}
+
+}
+}
@@ -0,0 +1,284 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "lw/error.hpp"
+#include "lw/event/BasicStream.hpp"
+#include "lw/event/Promise.hpp"
+#include "lw/memory.hpp"
+
+namespace lw {
+namespace event {
+
+LW_DEFINE_EXCEPTION_EX(FramingError, ::lw::event, StreamError);
+
+// ---------------------------------------------------------------------------------------------- //
+
+/// @brief Base class for splitting a sequence of stream chunks into whole frames.
+///
+/// Frames that fit entirely within one chunk are emitted as views over that chunk, keeping it alive
+/// for as long as the frame is referenced. Only frames which cross chunk boundaries are copied into
+/// a reassembly buffer.
+class Framer {
+public:
+    /// @brief Frames share the buffer pointer type used by streams.
+    typedef BasicStream::buffer_ptr_t buffer_ptr_t;
+
+    /// @brief Frame callback functor type.
+    ///
+    /// @param frame The buffer containing exactly one frame, without any framing bytes.
+    typedef std::function<void(buffer_ptr_t frame)> frame_callback_t;
+
+    /// @brief The largest frame accepted unless otherwise specified.
+    static const std::size_t default_max_frame_size = 16 * 1024 * 1024;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    virtual ~Framer(void){}
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Sets the functor to call with each complete frame.
+    ///
+    /// @tparam Func A functor matching `frame_callback_t`.
+    ///
+    /// @param func The functor to call with each frame.
+    template<typename Func>
+    void on_frame(Func&& func){
+        m_frame_callback = std::forward<Func>(func);
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Splits the given chunk into frames, calling the frame callback for each one.
+    ///
+    /// Any trailing partial frame is held onto until the next chunk arrives.
+    ///
+    /// @param chunk The next chunk of data from the stream.
+    ///
+    /// @throws FramingError If the data is malformed or a frame exceeds the maximum size.
+    virtual void feed(const buffer_ptr_t& chunk) = 0;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Reads the stream until its end, calling `func` with each frame.
+    ///
+    /// The framer must outlive the read.
+    ///
+    /// @tparam Func A functor matching `frame_callback_t`.
+    ///
+    /// @param stream   The stream to read frames from.
+    /// @param func     The functor to call with each frame.
+    ///
+    /// @return
+    ///     A promise for the number of frames read. It will be rejected if the stream fails, the
+    ///     framing is malformed, or the stream ends part way through a frame.
+    template<typename Func>
+    Future<std::size_t> read(BasicStream& stream, Func&& func){
+        on_frame(std::forward<Func>(func));
+        return _read(stream);
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Indicates if part of a frame is waiting for more data.
+    virtual bool has_partial_frame(void) const {
+        return !m_partial.empty();
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief The number of frames emitted so far.
+    std::size_t frame_count(void) const {
+        return m_frame_count;
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+protected:
+    /// @brief Constructs the framer.
+    ///
+    /// @param max_frame_size The largest frame, in bytes, to accept.
+    explicit Framer(const std::size_t max_frame_size):
+        m_max_frame_size(max_frame_size),
+        m_frame_count(0)
+    {}
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Emits a frame which lies entirely within `chunk` without copying it.
+    ///
+    /// @param chunk    The chunk containing the frame.
+    /// @param offset   The offset of the frame within the chunk.
+    /// @param size     The size of the frame.
+    void _emit_view(const buffer_ptr_t& chunk, const std::size_t offset, const std::size_t size);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Emits the reassembled partial frame and clears it.
+    void _emit_partial(void);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Appends bytes to the partial frame.
+    ///
+    /// @param data The bytes to append.
+    /// @param size The number of bytes to append.
+    ///
+    /// @throws FramingError If the partial frame would grow beyond the maximum frame size.
+    void _append_partial(const memory::byte* data, const std::size_t size);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Throws if `size` exceeds the maximum frame size.
+    void _check_frame_size(const std::size_t size) const;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    std::vector<memory::byte> m_partial; ///< Reassembly space for frames crossing chunks.
+
+    // ------------------------------------------------------------------------------------------ //
+
+private:
+    /// @brief Reads the stream, feeding every chunk to this framer.
+    Future<std::size_t> _read(BasicStream& stream);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    std::size_t m_max_frame_size;       ///< The largest frame allowed.
+    std::size_t m_frame_count;          ///< The number of frames emitted.
+    frame_callback_t m_frame_callback;  ///< The functor to call with each frame.
+};
+
+// ---------------------------------------------------------------------------------------------- //
+
+/// @brief Splits frames which are preceded by their length.
+class LengthPrefixFramer : public Framer {
+public:
+    /// @brief The encodings supported for the length prefix.
+    enum prefix_type {
+        U32_BE, ///< A 4-byte, big-endian unsigned integer.
+        VARINT  ///< An unsigned LEB128 variable-length integer, up to 64 bits.
+    };
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Constructs a length-prefix framer.
+    ///
+    /// @param prefix           The encoding of the length prefix.
+    /// @param max_frame_size   The largest frame, in bytes, to accept.
+    explicit LengthPrefixFramer(
+        const prefix_type prefix,
+        const std::size_t max_frame_size = default_max_frame_size
+    ):
+        Framer(max_frame_size),
+        m_prefix(prefix),
+        m_header_size(0),
+        m_frame_size(0),
+        m_in_frame(false)
+    {}
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @copydoc Framer::feed
+    void feed(const buffer_ptr_t& chunk) override;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @copydoc Framer::has_partial_frame
+    bool has_partial_frame(void) const override {
+        return m_in_frame || m_header_size > 0;
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Encodes a length prefix.
+    ///
+    /// @param prefix   The encoding to use.
+    /// @param size     The frame length to encode.
+    /// @param out      Space for the prefix, at least 10 bytes long.
+    ///
+    /// @return The number of bytes written to `out`.
+    static std::size_t encode(
+        const prefix_type prefix,
+        const std::uint64_t size,
+        memory::byte* out
+    );
+
+    // ------------------------------------------------------------------------------------------ //
+
+private:
+    /// @brief Attempts to decode a length prefix.
+    ///
+    /// @param data         The bytes which start with the prefix.
+    /// @param size         The number of bytes available.
+    /// @param frame_size   Set to the decoded frame size on success.
+    ///
+    /// @return The number of bytes in the prefix, or 0 if more bytes are needed.
+    std::size_t _decode(
+        const memory::byte* data,
+        const std::size_t size,
+        std::uint64_t& frame_size
+    );
+
+    // ------------------------------------------------------------------------------------------ //
+
+    prefix_type     m_prefix;       ///< The encoding of the length prefix.
+    memory::byte    m_header[10];   ///< Partial length prefix crossing chunks.
+    std::size_t     m_header_size;  ///< The number of bytes in `m_header`.
+    std::size_t     m_frame_size;   ///< The size of the frame being reassembled.
+    bool            m_in_frame;     ///< Flag indicating a frame is being reassembled.
+};
+
+// ---------------------------------------------------------------------------------------------- //
+
+/// @brief Splits frames which are terminated by a delimiter, such as a newline.
+class DelimiterFramer : public Framer {
+public:
+    /// @brief Constructs a delimiter framer.
+    ///
+    /// @param delimiter        The byte sequence ending each frame. It is not included in frames.
+    /// @param max_frame_size   The largest frame, in bytes, to accept.
+    explicit DelimiterFramer(
+        const std::string& delimiter,
+        const std::size_t max_frame_size = default_max_frame_size
+    );
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @copydoc Framer::feed
+    void feed(const buffer_ptr_t& chunk) override;
+
+    // ------------------------------------------------------------------------------------------ //
+
+private:
+    /// @brief Finds the next delimiter in the given range.
+    ///
+    /// @param begin    The first byte to search.
+    /// @param end      One past the last byte to search.
+    ///
+    /// @return A pointer to the start of the delimiter, or `nullptr` if there is none.
+    const memory::byte* _find(const memory::byte* begin, const memory::byte* end) const;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Checks if a delimiter straddles the partial frame and the start of a chunk.
+    ///
+    /// @param data The start of the new chunk.
+    /// @param size The size of the new chunk.
+    ///
+    /// @return The number of delimiter bytes found in the partial frame, or 0 if none.
+    std::size_t _find_split(const memory::byte* data, const std::size_t size) const;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    std::string m_delimiter; ///< The frame delimiter.
+};
+
+}
+}
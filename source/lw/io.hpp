@@ -1,4 +1,16 @@
 #pragma once
 
+#include "lw/io/address.hpp"
 #include "lw/io/File.hpp"
+#include "lw/io/FileCache.hpp"
+#include "lw/io/fs.hpp"
+#include "lw/io/GroupCommitWriter.hpp"
+#include "lw/io/LogWriter.hpp"
+#include "lw/io/MappedFile.hpp"
 #include "lw/io/Pipe.hpp"
+#include "lw/io/StatCache.hpp"
+#include "lw/io/Tcp.hpp"
+#include "lw/io/TcpServer.hpp"
+#include "lw/io/Udp.hpp"
+#include "lw/io/Uring.hpp"
+#include "lw/io/Watcher.hpp"
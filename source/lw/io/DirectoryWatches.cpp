@@ -0,0 +1,163 @@
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "lw/io/DirectoryWatches.hpp"
+#include "lw/io/Watcher.hpp"
+
+namespace lw {
+namespace io {
+namespace _details {
+
+std::string watched_directory(const std::string& path){
+    const std::size_t slash = path.find_last_of('/');
+    if (slash == std::string::npos) {
+        return std::string(".");
+    }
+    return slash == 0 ? std::string("/") : path.substr(0, slash);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+struct DirectoryWatches::_State : public std::enable_shared_from_this<DirectoryWatches::_State> {
+    struct Directory {
+        Directory(void):
+            references(0),
+            started(false)
+        {}
+
+        std::size_t references;
+        bool started;
+        std::vector<event::Promise<>> waiters;
+    };
+
+    _State(event::Loop& _loop, const change_callback_t& _on_change):
+        loop(_loop),
+        watcher(_loop, watcher_options()),
+        on_change(_on_change),
+        closed(false)
+    {
+        watcher.on(watcher.change_event, [this](const std::string& path, const int&){
+            changed(path);
+        });
+    }
+
+    event::Loop& loop;
+    Watcher watcher;
+    change_callback_t on_change;
+    std::unordered_map<std::string, Directory> directories;
+    bool closed;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    static Watcher::Options watcher_options(void){
+        // Report on the next turn of the loop, and never hold the loop open for it.
+        Watcher::Options options;
+        options.debounce    = event::Timeout::resolution(0);
+        options.keep_alive  = false;
+        return options;
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    void changed(const std::string& path){
+        if (directories.count(path)) {
+            on_change(path, true);
+            return;
+        }
+
+        // Bare names are watched through "." and reported back with it.
+        const bool relative = path.compare(0, 2, "./") == 0;
+        on_change(relative ? path.substr(2) : path, false);
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    void started(const std::string& directory){
+        auto it = directories.find(directory);
+        if (it == directories.end()) {
+            return;
+        }
+        it->second.started = true;
+        release(it->second.waiters);
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    static void release(std::vector<event::Promise<>>& waiters){
+        auto released = std::move(waiters);
+        waiters.clear();
+        for (auto& waiter : released) {
+            waiter.resolve();
+        }
+    }
+};
+
+// ---------------------------------------------------------------------------------------------- //
+
+DirectoryWatches::DirectoryWatches(event::Loop& loop, const change_callback_t& on_change):
+    m_state(std::make_shared<_State>(loop, on_change))
+{}
+
+// ---------------------------------------------------------------------------------------------- //
+
+DirectoryWatches::~DirectoryWatches(void){
+    close();
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+event::Future<> DirectoryWatches::watch(const std::string& directory){
+    if (m_state->closed) {
+        return event::resolve(m_state->loop);
+    }
+
+    _State::Directory& watched = m_state->directories[directory];
+    if (watched.references++ == 0) {
+        auto state = m_state;
+        m_state->watcher.watch(directory).then(
+            [state, directory](){ state->started(directory); },
+            [state, directory](const error::Exception&){ state->started(directory); }
+        );
+    }
+    if (watched.started) {
+        return event::resolve(m_state->loop);
+    }
+    watched.waiters.emplace_back();
+    return watched.waiters.back().future();
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void DirectoryWatches::unwatch(const std::string& directory){
+    auto it = m_state->directories.find(directory);
+    if (it == m_state->directories.end() || --it->second.references > 0) {
+        return;
+    }
+
+    auto waiters = std::move(it->second.waiters);
+    m_state->directories.erase(it);
+    m_state->watcher.unwatch(directory);
+    _State::release(waiters);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void DirectoryWatches::close(void){
+    if (m_state->closed) {
+        return;
+    }
+    m_state->closed = true;
+    auto directories = std::move(m_state->directories);
+    m_state->directories.clear();
+    m_state->watcher.close();
+
+    for (auto& directory : directories) {
+        _State::release(directory.second.waiters);
+    }
+}
+
+}
+}
+}
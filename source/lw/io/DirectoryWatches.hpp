@@ -0,0 +1,85 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "lw/event.hpp"
+
+namespace lw {
+namespace io {
+namespace _details {
+
+/// @brief The directory to watch for changes to a path, `.` for a bare name.
+///
+/// @param path The path to find the directory of.
+std::string watched_directory(const std::string& path);
+
+// ---------------------------------------------------------------------------------------------- //
+
+/// @brief Reference-counted directory watches shared by the entries of a cache.
+///
+/// Each directory is watched with an `io::Watcher` for as long as anything holds a reference to
+/// it. Changes are reported on the next turn of the loop, and the watches never keep the loop
+/// running. Directories which cannot be watched are still counted, so entries within them are
+/// simply never told of changes.
+class DirectoryWatches {
+public:
+    /// @brief Change callback functor type.
+    ///
+    /// @param path         The changed path, with any leading `./` removed, or the directory.
+    /// @param directory    True if the directory itself changed, so anything in it may have.
+    typedef std::function<void(const std::string& path, const bool directory)> change_callback_t;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Constructs an empty set of watches.
+    ///
+    /// @param loop         The event loop to watch on.
+    /// @param on_change    The functor to call with each change.
+    DirectoryWatches(event::Loop& loop, const change_callback_t& on_change);
+
+    /// @brief No copying.
+    DirectoryWatches(const DirectoryWatches&) = delete;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Stops every watch.
+    ~DirectoryWatches(void);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Takes a reference on a directory's watch, starting it if need be.
+    ///
+    /// @param directory The directory to watch.
+    ///
+    /// @return A promise resolved once the watch has started, or failed to.
+    event::Future<> watch(const std::string& directory);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Drops a reference on a directory's watch, stopping it with the last one.
+    ///
+    /// @param directory The directory given to `watch`.
+    void unwatch(const std::string& directory);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Stops every watch and drops every reference.
+    ///
+    /// Anyone still waiting for a watch to start is let go without it.
+    void close(void);
+
+    // ------------------------------------------------------------------------------------------ //
+
+private:
+    struct _State; ///< Type used for managing internal state.
+
+    // ------------------------------------------------------------------------------------------ //
+
+    std::shared_ptr<_State> m_state; ///< The watch state.
+};
+
+}
+}
+}
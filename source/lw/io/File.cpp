@@ -1,7 +1,19 @@
 
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
 #include <cstdlib>
 #include <cstring>
+#include <fcntl.h>
+#include <map>
+#include <sys/uio.h>
+#include <unistd.h>
 #include <uv.h>
+#include <vector>
+
+#ifdef __linux__
+#   include <sys/sendfile.h>
+#endif
 
 #include "lw/io/File.hpp"
 
@@ -17,33 +29,442 @@ inline FileError _wrap_uv_error( int err_code ){
 
 // -------------------------------------------------------------------------- //
 
-File::File( event::Loop& loop ):
-    m_loop( loop ),
-    m_handle( (uv_fs_s*)std::malloc( sizeof( uv_fs_s ) ) ),
-    m_promise( nullptr ),
-    m_file_descriptor( -1 ),
-    m_uv_buffer( (uv_buf_t*)std::malloc( sizeof( uv_buf_t ) ) )
-{
-    m_handle->data = (void*)this;
+namespace _details {
+    struct StreamRead : public std::enable_shared_from_this< StreamRead > {
+        typedef std::shared_ptr< memory::Buffer > chunk_ptr_t;
+
+        File* file;
+        std::size_t chunk_size;
+        std::size_t depth;
+        File::chunk_callback_t callback;
+        std::size_t next_read;
+        std::size_t next_delivery;
+        std::size_t in_flight;
+        std::uint64_t total;
+        bool ended;
+        bool failed;
+        std::map< std::size_t, std::pair< chunk_ptr_t, int > > ready;
+        std::vector< chunk_ptr_t > idle_chunks;
+        event::Promise< std::uint64_t > promise;
+
+        /// @brief Starts reads until `depth` are in flight or the end is found.
+        void fill( void ){
+            auto stream = shared_from_this();
+            while( in_flight < depth && !ended && !failed ){
+                chunk_ptr_t chunk;
+                if( idle_chunks.empty() ){
+                    chunk = std::make_shared< memory::Buffer >( file->allocate( chunk_size ) );
+                }
+                else {
+                    chunk = std::move( idle_chunks.back() );
+                    idle_chunks.pop_back();
+                }
+
+                const std::size_t index = next_read++;
+                ++in_flight;
+                file->read_at( (std::uint64_t)index * chunk_size, *chunk ).then(
+                    [ stream, index, chunk ]( int size ){
+                        stream->on_read( index, chunk, size );
+                    },
+                    [ stream ]( const error::Exception& err ){
+                        stream->on_error( err );
+                    }
+                );
+            }
+        }
+
+        /// @brief Delivers whatever chunks are now next in order.
+        void on_read( const std::size_t index, const chunk_ptr_t& chunk, const int size ){
+            --in_flight;
+            if( ended || failed ){
+                idle_chunks.push_back( chunk );
+                finish();
+                return;
+            }
+
+            ready.emplace( index, std::make_pair( chunk, size ) );
+            for(
+                auto it = ready.find( next_delivery );
+                it != ready.end() && !ended;
+                it = ready.find( next_delivery )
+            ){
+                chunk_ptr_t next = std::move( it->second.first );
+                const std::size_t next_size = (std::size_t)it->second.second;
+                ready.erase( it );
+                ++next_delivery;
+
+                // A short read means this chunk runs into the end of the file.
+                ended = next_size < chunk_size;
+                if( next_size == 0 ){
+                    idle_chunks.push_back( next );
+                    continue;
+                }
+
+                std::weak_ptr< StreamRead > weak_stream = shared_from_this();
+                total += next_size;
+                callback( File::buffer_ptr_t(
+                    new memory::Buffer( next->data(), next_size ),
+                    [ weak_stream, next ]( memory::Buffer* view ){
+                        delete view;
+                        if( auto stream = weak_stream.lock() ){
+                            stream->idle_chunks.push_back( next );
+                        }
+                    }
+                ) );
+            }
+
+            if( ended ){
+                for( auto& entry : ready ){
+                    idle_chunks.push_back( entry.second.first );
+                }
+                ready.clear();
+                finish();
+            }
+            else {
+                fill();
+            }
+        }
+
+        /// @brief Rejects the stream and stops issuing reads.
+        void on_error( const error::Exception& err ){
+            --in_flight;
+            if( !failed && !ended ){
+                failed = true;
+                promise.reject( err );
+            }
+        }
+
+        /// @brief Resolves the stream once the last outstanding read returns.
+        void finish( void ){
+            if( ended && !failed && in_flight == 0 && !promise.is_finished() ){
+                promise.resolve( total );
+            }
+        }
+    };
+
+    // ---------------------------------------------------------------------- //
+
+    struct WaitWritable {
+        uv_poll_t handle;
+        int fd;
+        int error;
+        event::Promise<> promise;
+
+        /// @brief Settles the wait once its handle has closed.
+        static void closed( uv_handle_t* handle ){
+            std::unique_ptr< WaitWritable > wait_req( (WaitWritable*)handle->data );
+            ::close( wait_req->fd );
+            if( wait_req->error < 0 ){
+                wait_req->promise.reject( _wrap_uv_error( wait_req->error ) );
+            }
+            else {
+                wait_req->promise.resolve();
+            }
+        }
+    };
+
+    /// @brief Waits on the loop for a descriptor to take more data.
+    ///
+    /// The descriptor is owned by a libuv stream, which already has it in the
+    /// loop's poller, so the wait is on a duplicate of it.
+    event::Future<> wait_writable( event::Loop& loop, const int fd ){
+        const int wait_fd = ::dup( fd );
+        if( wait_fd < 0 ){
+            throw _wrap_uv_error( -errno );
+        }
+
+        auto wait_req = new WaitWritable();
+        wait_req->handle.data   = (void*)wait_req;
+        wait_req->fd            = wait_fd;
+        wait_req->error         = 0;
+        auto future = wait_req->promise.future();
+
+        int res = uv_poll_init( loop.lowest_layer(), &wait_req->handle, wait_fd );
+        if( res < 0 ){
+            ::close( wait_fd );
+            delete wait_req;
+            throw _wrap_uv_error( res );
+        }
+
+        res = uv_poll_start(
+            &wait_req->handle,
+            UV_WRITABLE,
+            []( uv_poll_t* handle, int status, int ){
+                ((WaitWritable*)handle->data)->error = status;
+                uv_close( (uv_handle_t*)handle, &WaitWritable::closed );
+            }
+        );
+        if( res < 0 ){
+            wait_req->error = res;
+            uv_close( (uv_handle_t*)&wait_req->handle, &WaitWritable::closed );
+        }
+        return future;
+    }
+
+    // ---------------------------------------------------------------------- //
+
+#ifdef __linux__
+    /// @brief The most bytes `copy_file` moves per trip through the threadpool.
+    static const std::size_t COPY_CHUNK_SIZE = 16 * 1024 * 1024;
+
+    struct CopyFile {
+        uv_work_t request;
+        event::Loop* loop;
+        std::shared_ptr< File > source;
+        std::shared_ptr< File > destination;
+        File::progress_callback_t progress;
+        std::uint64_t total;
+        bool use_sendfile;
+        long int result;
+        event::Promise< std::uint64_t > promise;
+        std::shared_ptr< CopyFile > self;
+
+        /// @brief Copies the next chunk. Runs on the threadpool.
+        static void work( uv_work_t* req ){
+            auto& copy_req = *(CopyFile*)req->data;
+            const int in_fd = copy_req.source->lowest_layer();
+            const int out_fd = copy_req.destination->lowest_layer();
+            long int copied = -1;
+
+            if( !copy_req.use_sendfile ){
+                do {
+                    copied = ::copy_file_range(
+                        in_fd, nullptr, out_fd, nullptr, COPY_CHUNK_SIZE, 0
+                    );
+                } while( copied < 0 && errno == EINTR );
+
+                // Older kernels and some filesystem pairs cannot do this, but
+                // sendfile between two files works everywhere.
+                if(
+                    copied < 0 && copy_req.total == 0 &&
+                    (errno == ENOSYS || errno == EXDEV || errno == EINVAL ||
+                     errno == EOPNOTSUPP)
+                ){
+                    copy_req.use_sendfile = true;
+                }
+            }
+            if( copy_req.use_sendfile ){
+                do {
+                    copied = ::sendfile( out_fd, in_fd, nullptr, COPY_CHUNK_SIZE );
+                } while( copied < 0 && errno == EINTR );
+            }
+
+            copy_req.result = copied < 0 ? -errno : copied;
+        }
+
+        /// @brief Reports the chunk and starts the next, or settles the copy.
+        static void after_work( uv_work_t* req, int status ){
+            auto copy_req = std::move( ((CopyFile*)req->data)->self );
+            if( status < 0 || copy_req->result < 0 ){
+                copy_req->fail( status < 0 ? status : (int)copy_req->result );
+                return;
+            }
+            if( copy_req->result == 0 ){
+                copy_req->destination->close().then(
+                    [ copy_req ](){ copy_req->promise.resolve( copy_req->total ); },
+                    [ copy_req ]( const error::Exception& err ){
+                        copy_req->promise.reject( err );
+                    }
+                );
+                return;
+            }
+
+            copy_req->total += copy_req->result;
+            if( copy_req->progress ){
+                copy_req->progress( copy_req->total );
+            }
+            copy_req->next( copy_req );
+        }
+
+        void next( const std::shared_ptr< CopyFile >& copy_req ){
+            request.data = (void*)this;
+            self = copy_req;
+            int res = uv_queue_work( loop->lowest_layer(), &request, &work, &after_work );
+            if( res < 0 ){
+                self.reset();
+                fail( res );
+            }
+        }
+
+        void fail( const int err_code ){
+            promise.reject( _wrap_uv_error( err_code ) );
+        }
+    };
+#else
+    struct CopyFile {
+        uv_fs_t request;
+        std::string destination;
+        File::progress_callback_t progress;
+        event::Promise< std::uint64_t > promise;
+
+        /// @brief Looks up the size of the finished copy.
+        static void copied( uv_fs_t* req ){
+            auto& copy_req = *(CopyFile*)req->data;
+            const int result = req->result;
+            uv_fs_req_cleanup( req );
+            if( result < 0 ){
+                finish( req, result );
+                return;
+            }
+
+            int res = uv_fs_stat(
+                req->loop,
+                req,
+                copy_req.destination.c_str(),
+                []( uv_fs_t* req ){
+                    const int result = req->result;
+                    const std::uint64_t size = req->statbuf.st_size;
+                    uv_fs_req_cleanup( req );
+                    finish( req, result < 0 ? result : 0, size );
+                }
+            );
+            if( res < 0 ){
+                finish( req, res );
+            }
+        }
+
+        static void finish( uv_fs_t* req, const int result, const std::uint64_t size = 0 ){
+            std::unique_ptr< CopyFile > copy_req( (CopyFile*)req->data );
+            if( result < 0 ){
+                copy_req->promise.reject( _wrap_uv_error( result ) );
+                return;
+            }
+            if( copy_req->progress ){
+                copy_req->progress( size );
+            }
+            copy_req->promise.resolve( size );
+        }
+    };
+#endif
 }
 
 // -------------------------------------------------------------------------- //
 
-File::~File( void ){
-    if( m_file_descriptor ){
-        uv_fs_close( m_loop.lowest_layer(), m_handle, m_file_descriptor, nullptr );
+// Request buffers are handed to io_uring as they are, which relies on libuv's
+// promise that `uv_buf_t` matches `iovec` on Unix.
+static_assert(
+    sizeof( uv_buf_t ) == sizeof( iovec ) &&
+    offsetof( uv_buf_t, base ) == offsetof( iovec, iov_base ) &&
+    offsetof( uv_buf_t, len ) == offsetof( iovec, iov_len ),
+    "uv_buf_t must be layout-compatible with iovec."
+);
+
+// -------------------------------------------------------------------------- //
+
+/// @brief The most finished requests each file keeps around for reuse.
+static const std::size_t MAX_IDLE_REQUESTS = 64;
+
+// -------------------------------------------------------------------------- //
+
+/// @brief The most bytes `send_to` moves per trip through the threadpool.
+static const std::size_t SEND_CHUNK_SIZE = 1024 * 1024;
+
+// -------------------------------------------------------------------------- //
+
+// A page is a multiple of the logical block size on any device we run on.
+const std::size_t File::direct_alignment = 4096;
+
+/// @brief Where buffers for `DIRECT` files come from.
+static memory::AlignedAllocator direct_allocator( File::direct_alignment );
+
+// -------------------------------------------------------------------------- //
+
+struct File::_State {
+    _State( event::Loop& loop );
+    ~_State( void );
+
+    event::Loop& loop;
+    std::shared_ptr< Uring > uring;
+    int file_descriptor;
+    bool direct;
+    memory::Allocator* allocator;
+    std::size_t in_flight;
+    std::vector< std::unique_ptr< _Request > > idle_requests;
+    std::shared_ptr< memory::Crc32c > read_digest;
+    std::shared_ptr< memory::Crc32c > write_digest;
+    bool digesting;
+};
+
+// -------------------------------------------------------------------------- //
+
+struct File::_Request {
+    uv_fs_t handle;
+    Uring::Completion completion;
+    std::vector< uv_buf_t > buffers;
+    event::Promise< int > promise;
+    std::shared_ptr< _State > state;
+    std::shared_ptr< memory::Crc32c > digest;
+};
+
+// -------------------------------------------------------------------------- //
+
+struct File::_Send {
+    File* file;
+    event::Loop* loop;
+    int out_fd;
+    std::uint64_t offset;
+    std::uint64_t remaining;
+    std::uint64_t total;
+    progress_callback_t progress;
+    event::Promise< std::uint64_t > promise;
+
+    /// @brief Sends the next chunk, or resolves once everything is sent.
+    static void next( const std::shared_ptr< _Send >& send );
+
+    /// @brief Carries on after a chunk, waiting for the stream if it is full.
+    static void sent( const std::shared_ptr< _Send >& send, const int bytes );
+};
+
+// -------------------------------------------------------------------------- //
+
+File::_State::_State( event::Loop& _loop ):
+    loop( _loop ),
+    file_descriptor( -1 ),
+    direct( false ),
+    allocator( nullptr ),
+    in_flight( 0 ),
+    digesting( false )
+{}
+
+// -------------------------------------------------------------------------- //
+
+File::_State::~_State( void ){
+    // Every request holds the state, so nothing can be using the descriptor.
+    if( file_descriptor >= 0 ){
+        uv_fs_t handle;
+        uv_fs_close( loop.lowest_layer(), &handle, file_descriptor, nullptr );
+        uv_fs_req_cleanup( &handle );
     }
+}
+
+// -------------------------------------------------------------------------- //
 
-    uv_fs_req_cleanup( m_handle );
+File::File( event::Loop& loop ):
+    m_loop( loop ),
+    m_state( std::make_shared< _State >( loop ) )
+{}
 
-    std::free( m_uv_buffer );
-    std::free( m_handle );
+// -------------------------------------------------------------------------- //
+
+File::File( event::Loop& loop, const std::shared_ptr< Uring >& uring ):
+    File( loop )
+{
+    m_state->uring = uring;
 }
 
 // -------------------------------------------------------------------------- //
 
-event::Future<> File::open( const std::string& path, const std::ios::openmode mode ){
-    int flags = O_CREAT
+File::~File( void ){}
+
+// -------------------------------------------------------------------------- //
+
+event::Future<> File::open(
+    const std::string& path,
+    const std::ios::openmode mode,
+    const OpenFlags open_flags
+){
+    const bool direct = open_flags & DIRECT;
+    int flags = (open_flags & NO_CREATE ? 0 : O_CREAT)
         | (mode & std::ios::app     ? O_APPEND  : 0)
         | (mode & std::ios::trunc   ? O_TRUNC   : 0)
     ;
@@ -59,86 +480,113 @@ event::Future<> File::open( const std::string& path, const std::ios::openmode mo
         flags |= O_WRONLY;
     }
 
-    uv_fs_open(
+#ifdef O_DIRECT
+    if( direct ){
+        flags |= O_DIRECT;
+    }
+#endif
+
+    _Request& request = _acquire_request();
+    auto state = m_state;
+    return _submit( request, uv_fs_open(
         m_loop.lowest_layer(),
-        m_handle,
+        &request.handle,
         path.c_str(),
         flags,
         permissions,
-        &File::_open_cb
-    );
+        &File::_request_cb
+    ) )
+        .then([ state, direct ]( int file_descriptor ){
+            state->file_descriptor = file_descriptor;
+            state->direct = direct;
 
-    return _reset_promise();
+#ifdef F_NOCACHE
+            // Darwin has no O_DIRECT, but can turn off caching once open.
+            if( direct ){
+                ::fcntl( file_descriptor, F_NOCACHE, 1 );
+            }
+#endif
+        })
+    ;
 }
 
 // -------------------------------------------------------------------------- //
 
-void File::_open_cb( uv_fs_s* handle ){
-    int result = handle->result;
-    File* file = (File*)handle->data;
-    if( result < 0 ){
-        file->m_promise->reject( _wrap_uv_error( result ) );
-    }
-    else {
-        file->m_file_descriptor = result;
-        file->m_promise->resolve();
-    }
+event::Future<> File::close( void ){
+    _Request& request = _acquire_request();
+    auto state = m_state;
+    return _submit( request, uv_fs_close(
+        m_loop.lowest_layer(),
+        &request.handle,
+        m_state->file_descriptor,
+        &File::_request_cb
+    ) )
+        .then([ state ]( int ){
+            state->file_descriptor = -1;
+        })
+    ;
 }
 
 // -------------------------------------------------------------------------- //
 
-event::Future<> File::close( void ){
-    uv_fs_close(
-        m_loop.lowest_layer(),
-        m_handle,
-        m_file_descriptor,
-        &File::_close_cb
-    );
-    return _reset_promise();
+memory::Buffer File::allocate( const std::size_t size ){
+    if( m_state->direct ){
+        return memory::Buffer( size, direct_allocator );
+    }
+    // Pools round up to their size classes, but reads should stop at the size
+    // asked for.
+    return memory::Buffer( size, m_state->allocator );
 }
 
 // -------------------------------------------------------------------------- //
 
-void File::_close_cb( uv_fs_s* handle ){
-    int result = handle->result;
-    File* file = (File*)handle->data;
-    if( result < 0 ){
-        file->m_promise->reject( _wrap_uv_error( result ) );
-    }
-    else {
-        file->m_file_descriptor = -1;
-        file->m_promise->resolve();
-    }
+void File::allocator( memory::Allocator* allocator ){
+    m_state->allocator = allocator;
 }
 
 // -------------------------------------------------------------------------- //
 
 event::Future< int > File::read( memory::Buffer& data ){
-    *m_uv_buffer = uv_buf_init( (char*)data.data(), data.size() );
+    _Request& request = _acquire_request();
+    request.buffers.push_back( uv_buf_init( (char*)data.data(), data.size() ) );
+    return _read( request, -1 );
+}
 
-    uv_fs_read(
-        m_loop.lowest_layer(),
-        m_handle,
-        m_file_descriptor,
-        m_uv_buffer,
-        1,
-        -1,
-        &File::_read_cb
-    );
+// -------------------------------------------------------------------------- //
 
-    auto handlePtr = m_handle;
-    return _reset_promise()
-        .then< int >([ handlePtr ]( event::Promise< int >&& promise ){
-            promise.resolve( handlePtr->result );
+event::Future< memory::Buffer > File::read( const std::size_t bytes ){
+    auto dataPtr = std::make_shared< memory::Buffer >( allocate( bytes ) );
+    return read( *dataPtr )
+        .then([ dataPtr ]( int size ) mutable {
+            return memory::Buffer( std::move( *dataPtr ), size );
         })
     ;
 }
 
 // -------------------------------------------------------------------------- //
 
-event::Future< memory::Buffer > File::read( const std::size_t bytes ){
-    auto dataPtr = std::make_shared< memory::Buffer >( bytes );
-    return read( *dataPtr )
+event::Future<> File::write( const memory::Buffer& data ){
+    _Request& request = _acquire_request();
+    request.buffers.push_back( uv_buf_init( (char*)data.data(), data.size() ) );
+    return _write( request, -1 ).then([]( int ){});
+}
+
+// -------------------------------------------------------------------------- //
+
+event::Future< int > File::read_at( const std::uint64_t offset, memory::Buffer& data ){
+    _Request& request = _acquire_request();
+    request.buffers.push_back( uv_buf_init( (char*)data.data(), data.size() ) );
+    return _read( request, (std::int64_t)offset );
+}
+
+// -------------------------------------------------------------------------- //
+
+event::Future< memory::Buffer > File::read_at(
+    const std::uint64_t offset,
+    const std::size_t bytes
+){
+    auto dataPtr = std::make_shared< memory::Buffer >( allocate( bytes ) );
+    return read_at( offset, *dataPtr )
         .then([ dataPtr ]( int size ) mutable {
             return memory::Buffer( std::move( *dataPtr ), size );
         })
@@ -147,53 +595,574 @@ event::Future< memory::Buffer > File::read( const std::size_t bytes ){
 
 // -------------------------------------------------------------------------- //
 
-void File::_read_cb( uv_fs_s* handle ){
-    int result = handle->result;
-    File* file = (File*)handle->data;
-    if( result < 0 ){
-        file->m_promise->reject( _wrap_uv_error( result ) );
+event::Future<> File::write_at( const std::uint64_t offset, const memory::Buffer& data ){
+    _Request& request = _acquire_request();
+    request.buffers.push_back( uv_buf_init( (char*)data.data(), data.size() ) );
+    return _write( request, (std::int64_t)offset ).then([]( int ){});
+}
+
+// -------------------------------------------------------------------------- //
+
+event::Future< int > File::readv( const std::vector< memory::Buffer* >& buffers ){
+    _Request& request = _acquire_request();
+    for( memory::Buffer* data : buffers ){
+        request.buffers.push_back( uv_buf_init( (char*)data->data(), data->size() ) );
     }
-    else {
-        file->m_promise->resolve();
+    return _read( request, -1 );
+}
+
+// -------------------------------------------------------------------------- //
+
+event::Future< int > File::readv(
+    const std::uint64_t offset,
+    const std::vector< memory::Buffer* >& buffers
+){
+    _Request& request = _acquire_request();
+    for( memory::Buffer* data : buffers ){
+        request.buffers.push_back( uv_buf_init( (char*)data->data(), data->size() ) );
     }
+    return _read( request, (std::int64_t)offset );
 }
 
 // -------------------------------------------------------------------------- //
 
-event::Future<> File::write( const memory::Buffer& data ){
-    *m_uv_buffer = uv_buf_init( (char*)data.data(), data.size() );
+event::Future< int > File::writev( const std::vector< const memory::Buffer* >& buffers ){
+    _Request& request = _acquire_request();
+    for( const memory::Buffer* data : buffers ){
+        request.buffers.push_back( uv_buf_init( (char*)data->data(), data->size() ) );
+    }
+    return _write( request, -1 );
+}
 
-    uv_fs_write(
-        m_loop.lowest_layer(),
-        m_handle,
-        m_file_descriptor,
-        m_uv_buffer,
-        1,
-        -1,
-        &File::_write_cb
+// -------------------------------------------------------------------------- //
+
+event::Future< int > File::writev(
+    const std::uint64_t offset,
+    const std::vector< const memory::Buffer* >& buffers
+){
+    _Request& request = _acquire_request();
+    for( const memory::Buffer* data : buffers ){
+        request.buffers.push_back( uv_buf_init( (char*)data->data(), data->size() ) );
+    }
+    return _write( request, (std::int64_t)offset );
+}
+
+// -------------------------------------------------------------------------- //
+
+event::Future< int > File::writev( const memory::BufferChain& chain ){
+    _Request& request = _acquire_request();
+    chain.uv_buffers( request.buffers );
+    return _write( request, -1 );
+}
+
+// -------------------------------------------------------------------------- //
+
+event::Future< int > File::writev(
+    const std::uint64_t offset,
+    const memory::BufferChain& chain
+){
+    _Request& request = _acquire_request();
+    chain.uv_buffers( request.buffers );
+    return _write( request, (std::int64_t)offset );
+}
+
+// -------------------------------------------------------------------------- //
+
+event::Future< std::uint64_t > File::read_stream(
+    const std::size_t chunk_size,
+    const std::size_t depth,
+    const chunk_callback_t& callback
+){
+    if( chunk_size == 0 ){
+        throw FileError( 1, "Stream chunk size must be greater than zero." );
+    }
+    if( m_state->direct && chunk_size % direct_alignment != 0 ){
+        throw FileError(
+            7,
+            "Stream chunk size must be a multiple of the direct I/O alignment."
+        );
+    }
+
+    auto stream = std::make_shared< _details::StreamRead >();
+    stream->file            = this;
+    stream->chunk_size      = chunk_size;
+    stream->depth           = std::max< std::size_t >( depth, 1 );
+    stream->callback        = callback;
+    stream->next_read       = 0;
+    stream->next_delivery   = 0;
+    stream->in_flight       = 0;
+    stream->total           = 0;
+    stream->ended           = false;
+    stream->failed          = false;
+
+    auto future = stream->promise.future();
+    stream->fill();
+    return future;
+}
+
+// -------------------------------------------------------------------------- //
+
+event::Future< File::StreamDigest > File::read_stream_digest(
+    const std::size_t chunk_size,
+    const std::size_t depth,
+    const chunk_callback_t& callback
+){
+    // Chunks arrive in file order and still hot in cache, so fold them in here.
+    auto digest = std::make_shared< memory::Crc32c >();
+    return read_stream( chunk_size, depth, [ digest, callback ]( buffer_ptr_t chunk ){
+        digest->update( *chunk );
+        callback( std::move( chunk ) );
+    })
+        .then([ digest ]( std::uint64_t bytes ){
+            StreamDigest result;
+            result.bytes    = bytes;
+            result.crc32c   = digest->value();
+            return result;
+        })
+    ;
+}
+
+// -------------------------------------------------------------------------- //
+
+void File::digest_reads( const std::shared_ptr< memory::Crc32c >& digest ){
+    m_state->read_digest = digest;
+}
+
+// -------------------------------------------------------------------------- //
+
+void File::digest_writes( const std::shared_ptr< memory::Crc32c >& digest ){
+    m_state->write_digest = digest;
+}
+
+// -------------------------------------------------------------------------- //
+
+event::Future< std::uint64_t > File::send_to(
+    event::BasicStream& destination,
+    const std::uint64_t offset,
+    const std::uint64_t length,
+    const progress_callback_t& progress
+){
+    const int out_fd = destination.fileno();
+    if( out_fd < 0 ){
+        throw FileError( 9, "Destination stream has no descriptor to send to." );
+    }
+    if( destination.write_queue_size() > 0 ){
+        throw FileError( 10, "Destination stream still has writes queued." );
+    }
+
+    auto send = std::make_shared< _Send >();
+    send->file      = this;
+    send->loop      = &m_loop;
+    send->out_fd    = out_fd;
+    send->offset    = offset;
+    send->remaining = length;
+    send->total     = 0;
+    send->progress  = progress;
+
+    if( length == 0 ){
+        return event::resolve( m_loop, std::uint64_t( 0 ) );
+    }
+    auto future = send->promise.future();
+
+    // Failing to start the first chunk throws straight out of here.
+    _Send::next( send );
+    return future;
+}
+
+// -------------------------------------------------------------------------- //
+
+void File::_Send::next( const std::shared_ptr< _Send >& send ){
+    const std::size_t length =
+        (std::size_t)std::min< std::uint64_t >( send->remaining, SEND_CHUNK_SIZE );
+    send->file->_send_chunk( send->out_fd, send->offset, length ).then(
+        [ send ]( int bytes ){
+            sent( send, bytes );
+        },
+        [ send ]( const error::Exception& err ){
+            // Streams are non-blocking, so a full socket buffer shows up as an
+            // error instead of a short send.
+            if( err.error_code() != UV_EAGAIN ){
+                send->promise.reject( err );
+                return;
+            }
+            try {
+                _details::wait_writable( *send->loop, send->out_fd ).then([ send ](){
+                    try {
+                        next( send );
+                    }
+                    catch( const error::Exception& err ){
+                        send->promise.reject( err );
+                    }
+                });
+            }
+            catch( const error::Exception& wait_err ){
+                send->promise.reject( wait_err );
+            }
+        }
     );
+}
 
-    return _reset_promise();
+// -------------------------------------------------------------------------- //
+
+void File::_Send::sent( const std::shared_ptr< _Send >& send, const int bytes ){
+    send->offset    += bytes;
+    send->remaining -= bytes;
+    send->total     += bytes;
+    if( bytes > 0 && send->progress ){
+        send->progress( send->total );
+    }
+
+    // Sending nothing means the end of the file has been reached.
+    if( send->remaining == 0 || bytes == 0 ){
+        send->promise.resolve( send->total );
+        return;
+    }
+
+    try {
+        next( send );
+    }
+    catch( const error::Exception& err ){
+        send->promise.reject( err );
+    }
 }
 
 // -------------------------------------------------------------------------- //
 
-void File::_write_cb( uv_fs_s* handle ){
-    int result = handle->result;
-    File* file = (File*)handle->data;
-    if( result < 0 ){
-        file->m_promise->reject( _wrap_uv_error( result ) );
+event::Future<> File::sync( void ){
+    _Request& request = _acquire_request();
+    return _submit( request, uv_fs_fsync(
+        m_loop.lowest_layer(),
+        &request.handle,
+        m_state->file_descriptor,
+        &File::_request_cb
+    ) )
+        .then([]( int ){})
+    ;
+}
+
+// -------------------------------------------------------------------------- //
+
+event::Future<> File::datasync( void ){
+    _Request& request = _acquire_request();
+    return _submit( request, uv_fs_fdatasync(
+        m_loop.lowest_layer(),
+        &request.handle,
+        m_state->file_descriptor,
+        &File::_request_cb
+    ) )
+        .then([]( int ){})
+    ;
+}
+
+// -------------------------------------------------------------------------- //
+
+std::shared_ptr< MappedFile > File::map(
+    const std::uint64_t offset,
+    const std::size_t length
+){
+    return MappedFile::map( m_loop, m_state->file_descriptor, offset, length );
+}
+
+// -------------------------------------------------------------------------- //
+
+int File::lowest_layer( void ) const {
+    return m_state->file_descriptor;
+}
+
+// -------------------------------------------------------------------------- //
+
+std::size_t File::in_flight( void ) const {
+    return m_state->in_flight;
+}
+
+// -------------------------------------------------------------------------- //
+
+File::_Request& File::_acquire_request( void ){
+    std::unique_ptr< _Request > request;
+    if( m_state->idle_requests.empty() ){
+        request.reset( new _Request() );
+        request->handle.data = (void*)request.get();
+        request->completion.callback = &File::_uring_cb;
+        request->completion.data = (void*)request.get();
     }
     else {
-        file->m_promise->resolve();
+        request = std::move( m_state->idle_requests.back() );
+        m_state->idle_requests.pop_back();
+    }
+
+    request->buffers.clear();
+    request->digest.reset();
+    request->promise = event::Promise< int >();
+    request->state = m_state;
+    ++m_state->in_flight;
+    return *request.release();
+}
+
+// -------------------------------------------------------------------------- //
+
+void File::_release_request( _Request& request ){
+    auto state = std::move( request.state );
+    --state->in_flight;
+    if( request.digest ){
+        state->digesting = false;
+        request.digest.reset();
+    }
+    if( state->idle_requests.size() < MAX_IDLE_REQUESTS ){
+        state->idle_requests.emplace_back( &request );
+    }
+    else {
+        delete &request;
+    }
+}
+
+// -------------------------------------------------------------------------- //
+
+event::Future< int > File::_submit( _Request& request, const int result ){
+    if( result < 0 ){
+        _release_request( request );
+        throw _wrap_uv_error( result );
+    }
+    return request.promise.future();
+}
+
+// -------------------------------------------------------------------------- //
+
+template< typename Submit >
+event::Future< int > File::_submit_uring( _Request& request, Submit&& submit ){
+    try {
+        submit();
+    }
+    catch( const UringError& ){
+        _release_request( request );
+        throw;
+    }
+    return request.promise.future();
+}
+
+// -------------------------------------------------------------------------- //
+
+void File::_check_alignment( _Request& request, const std::int64_t offset ){
+    if( !m_state->direct ){
+        return;
+    }
+
+    const char* error = nullptr;
+    int error_code = 0;
+    if( offset > 0 && (std::uint64_t)offset % direct_alignment != 0 ){
+        error_code = 8;
+        error = "Direct I/O file offset is not aligned.";
+    }
+    for( const uv_buf_t& buffer : request.buffers ){
+        if( error ){
+            break;
+        }
+        if( (std::uintptr_t)buffer.base % direct_alignment != 0 ){
+            error_code = 6;
+            error = "Direct I/O buffer address is not aligned.";
+        }
+        else if( buffer.len % direct_alignment != 0 ){
+            error_code = 7;
+            error = "Direct I/O buffer length is not a multiple of the alignment.";
+        }
+    }
+
+    if( error ){
+        _release_request( request );
+        throw FileError( error_code, error );
+    }
+}
+
+// -------------------------------------------------------------------------- //
+
+void File::_start_digest(
+    _Request& request,
+    const std::shared_ptr< memory::Crc32c >& digest
+){
+    if( !digest ){
+        return;
+    }
+
+    // Completions can arrive out of order, so a second overlapping operation
+    // could fold its bytes in ahead of the first's.
+    if( m_state->digesting ){
+        _release_request( request );
+        throw FileError(
+            11,
+            "Another checksummed read or write is still in flight."
+        );
+    }
+    m_state->digesting = true;
+    request.digest = digest;
+}
+
+// -------------------------------------------------------------------------- //
+
+event::Future< int > File::_read( _Request& request, const std::int64_t offset ){
+    _check_alignment( request, offset );
+    if( offset < 0 ){
+        _start_digest( request, m_state->read_digest );
+    }
+    if( m_state->uring ){
+        return _submit_uring( request, [ & ](){
+            m_state->uring->read(
+                m_state->file_descriptor,
+                (const iovec*)request.buffers.data(),
+                request.buffers.size(),
+                offset,
+                request.completion
+            );
+        } );
+    }
+
+    return _submit( request, uv_fs_read(
+        m_loop.lowest_layer(),
+        &request.handle,
+        m_state->file_descriptor,
+        request.buffers.data(),
+        request.buffers.size(),
+        offset,
+        &File::_request_cb
+    ) );
+}
+
+// -------------------------------------------------------------------------- //
+
+event::Future< int > File::_write( _Request& request, const std::int64_t offset ){
+    _check_alignment( request, offset );
+    if( offset < 0 ){
+        _start_digest( request, m_state->write_digest );
+    }
+    if( m_state->uring ){
+        return _submit_uring( request, [ & ](){
+            m_state->uring->write(
+                m_state->file_descriptor,
+                (const iovec*)request.buffers.data(),
+                request.buffers.size(),
+                offset,
+                request.completion
+            );
+        } );
     }
+
+    return _submit( request, uv_fs_write(
+        m_loop.lowest_layer(),
+        &request.handle,
+        m_state->file_descriptor,
+        request.buffers.data(),
+        request.buffers.size(),
+        offset,
+        &File::_request_cb
+    ) );
+}
+
+// -------------------------------------------------------------------------- //
+
+event::Future< int > File::_send_chunk(
+    const int out_fd,
+    const std::uint64_t offset,
+    const std::size_t length
+){
+    _Request& request = _acquire_request();
+#ifdef __linux__
+    // When the kernel cannot send straight to the descriptor, libuv falls back
+    // to copying with blocking waits, which would hold a worker for as long as
+    // the stream stays full. Calling sendfile directly lets a full stream come
+    // back as EAGAIN so the wait can happen on the loop instead.
+    struct SendChunk {
+        uv_work_t work;
+        _Request* request;
+        int in_fd;
+        int out_fd;
+        off_t offset;
+        std::size_t length;
+        int result;
+    };
+
+    auto chunk_req = new SendChunk();
+    chunk_req->work.data    = (void*)chunk_req;
+    chunk_req->request      = &request;
+    chunk_req->in_fd        = m_state->file_descriptor;
+    chunk_req->out_fd       = out_fd;
+    chunk_req->offset       = (off_t)offset;
+    chunk_req->length       = length;
+    chunk_req->result       = 0;
+
+    int res = uv_queue_work(
+        m_loop.lowest_layer(),
+        &chunk_req->work,
+        []( uv_work_t* req ){
+            auto& chunk_req = *(SendChunk*)req->data;
+            ssize_t sent;
+            do {
+                sent = ::sendfile(
+                    chunk_req.out_fd,
+                    chunk_req.in_fd,
+                    &chunk_req.offset,
+                    chunk_req.length
+                );
+            } while( sent < 0 && errno == EINTR );
+            chunk_req.result = sent < 0 ? -errno : (int)sent;
+        },
+        []( uv_work_t* req, int status ){
+            std::unique_ptr< SendChunk > chunk_req( (SendChunk*)req->data );
+            _complete( *chunk_req->request, status < 0 ? status : chunk_req->result );
+        }
+    );
+    if( res < 0 ){
+        delete chunk_req;
+    }
+    return _submit( request, res );
+#else
+    return _submit( request, uv_fs_sendfile(
+        m_loop.lowest_layer(),
+        &request.handle,
+        out_fd,
+        m_state->file_descriptor,
+        (std::int64_t)offset,
+        length,
+        &File::_request_cb
+    ) );
+#endif
+}
+
+// -------------------------------------------------------------------------- //
+
+void File::_request_cb( uv_fs_s* handle ){
+    _Request& request = *(_Request*)handle->data;
+    const int result = handle->result;
+    uv_fs_req_cleanup( handle );
+    _complete( request, result );
 }
 
 // -------------------------------------------------------------------------- //
 
-event::Future<> File::_reset_promise( void ){
-    m_promise = std::make_unique< event::Promise<> >();
-    return m_promise->future();
+void File::_uring_cb( Uring::Completion& completion, int result ){
+    _complete( *(_Request*)completion.data, result );
+}
+
+// -------------------------------------------------------------------------- //
+
+void File::_complete( _Request& request, const int result ){
+    // Fold in exactly the bytes transferred, in the order they complete.
+    if( result > 0 && request.digest ){
+        std::size_t remaining = (std::size_t)result;
+        for( const auto& buffer : request.buffers ){
+            const std::size_t size = std::min( remaining, (std::size_t)buffer.len );
+            request.digest->update( buffer.base, size );
+            remaining -= size;
+        }
+    }
+
+    // Release the request before settling so continuations can reuse it.
+    auto promise = std::move( request.promise );
+    _release_request( request );
+
+    if( result < 0 ){
+        promise.reject( _wrap_uv_error( result ) );
+    }
+    else {
+        promise.resolve( result );
+    }
 }
 
 // -------------------------------------------------------------------------- //
@@ -201,15 +1170,74 @@ event::Future<> File::_reset_promise( void ){
 event::Future< std::shared_ptr< File > > open(
     event::Loop& loop,
     const std::string& path,
-    const std::ios::openmode mode
+    const std::ios::openmode mode,
+    const File::OpenFlags flags
 ){
     auto file = std::make_shared< File >( loop );
-    return file->open( path, mode )
+    return file->open( path, mode, flags )
         .then([ file ](){
             return file;
         })
     ;
 }
 
+// -------------------------------------------------------------------------- //
+
+event::Future< std::uint64_t > copy_file(
+    event::Loop& loop,
+    const std::string& source,
+    const std::string& destination,
+    const File::progress_callback_t& progress
+){
+#ifdef __linux__
+    auto copy_req = std::make_shared< _details::CopyFile >();
+    copy_req->loop          = &loop;
+    copy_req->source        = std::make_shared< File >( loop );
+    copy_req->destination   = std::make_shared< File >( loop );
+    copy_req->progress      = progress;
+    copy_req->total         = 0;
+    copy_req->use_sendfile  = false;
+    copy_req->result        = 0;
+
+    auto future = copy_req->promise.future();
+    copy_req->source->open( source, std::ios::in, File::NO_CREATE )
+        .then([ copy_req, destination ](){
+            return copy_req->destination->open(
+                destination,
+                std::ios::out | std::ios::trunc
+            );
+        })
+        .then(
+            [ copy_req ](){
+                copy_req->next( copy_req );
+            },
+            [ copy_req ]( const error::Exception& err ){
+                copy_req->promise.reject( err );
+            }
+        );
+    return future;
+#else
+    auto copy_req = new _details::CopyFile();
+    copy_req->request.data  = (void*)copy_req;
+    copy_req->destination   = destination;
+    copy_req->progress      = progress;
+    auto future = copy_req->promise.future();
+
+    int res = uv_fs_copyfile(
+        loop.lowest_layer(),
+        &copy_req->request,
+        source.c_str(),
+        destination.c_str(),
+        0,
+        &_details::CopyFile::copied
+    );
+    if( res < 0 ){
+        delete copy_req;
+        throw _wrap_uv_error( res );
+    }
+    return future;
+#endif
+}
+
 }
 }
@@ -1,16 +1,20 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <ios>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "lw/error.hpp"
 #include "lw/event.hpp"
+#include "lw/io/MappedFile.hpp"
+#include "lw/io/Uring.hpp"
 #include "lw/memory.hpp"
 
 struct uv_fs_s;
-struct uv_buf_t;
 
 namespace lw {
 namespace io {
@@ -18,8 +22,49 @@ namespace io {
 LW_DEFINE_EXCEPTION( FileError );
 
 /// @brief Wraps file access in a clean, promise-friendly package.
+///
+/// Each operation gets its own request from a per-file pool, so any number of
+/// reads and writes may be in flight on the threadpool at once. Operations
+/// which do not give an offset share the file position, so their order on disk
+/// is only defined if each waits for the one before it.
 class File {
 public:
+    /// @brief Chunks from `read_stream` are passed around as shared buffers.
+    typedef std::shared_ptr< const memory::Buffer > buffer_ptr_t;
+
+    /// @brief Stream chunk callback functor type.
+    ///
+    /// @param chunk The next chunk of the file.
+    typedef std::function< void( buffer_ptr_t chunk ) > chunk_callback_t;
+
+    /// @brief Progress callback functor type for long transfers.
+    ///
+    /// @param bytes The total number of bytes moved so far.
+    typedef std::function< void( std::uint64_t bytes ) > progress_callback_t;
+
+    /// @brief The outcome of `read_stream_digest`.
+    struct StreamDigest {
+        std::uint64_t bytes;    ///< The total number of bytes read.
+        std::uint32_t crc32c;   ///< The CRC-32C of every byte read, in order.
+    };
+
+    // ---------------------------------------------------------------------- //
+
+    /// @brief Options for opening a file which `std::ios` modes cannot give.
+    enum OpenFlags {
+        NONE        = 0,    ///< Nothing beyond the `std::ios` mode.
+        DIRECT      = 1,    ///< Bypass the page cache using `O_DIRECT`.
+        NO_CREATE   = 2     ///< Fail if the file does not exist already.
+    };
+
+    // ---------------------------------------------------------------------- //
+
+    /// @brief The alignment `DIRECT` files need for buffer addresses, lengths
+    /// and file offsets.
+    static const std::size_t direct_alignment;
+
+    // ---------------------------------------------------------------------- //
+
     /// @brief Constructs an unopened file associated with the given event loop.
     ///
     /// @param loop The event loop to use for all file-related events.
@@ -27,20 +72,50 @@ public:
 
     // ---------------------------------------------------------------------- //
 
+    /// @brief Constructs an unopened file which reads and writes through the
+    /// given io_uring instead of the threadpool.
+    ///
+    /// Opening and closing still use the threadpool. If `uring` is `nullptr`,
+    /// as `Uring::create` returns where io_uring is unavailable, the file falls
+    /// back to the threadpool for everything.
+    ///
+    /// @param loop     The event loop to use for all file-related events.
+    /// @param uring    The ring to submit reads and writes to.
+    File( event::Loop& loop, const std::shared_ptr< Uring >& uring );
+
+    // ---------------------------------------------------------------------- //
+
+    /// @brief No copying.
+    File( const File& ) = delete;
+
+    // ---------------------------------------------------------------------- //
+
     /// @brief Destructor will close the file if it is open.
+    ///
+    /// The file is closed once any operations still in flight have completed.
     ~File( void );
 
     // ---------------------------------------------------------------------- //
 
     /// @brief Asynchronously opens a file handle.
     ///
-    /// @param path The path to the file to open.
-    /// @param mode The mode to open with (default is `in` and `out`).
+    /// Missing files are created unless `NO_CREATE` is given, in which case
+    /// opening them fails.
+    ///
+    /// Files opened with `DIRECT` skip the kernel's page cache, so data cached
+    /// by the application is not cached twice. Every read and write on them
+    /// must then use buffers from `allocate` and offsets which are multiples
+    /// of `direct_alignment`.
+    ///
+    /// @param path     The path to the file to open.
+    /// @param mode     The mode to open with (default is `in` and `out`).
+    /// @param flags    Extra options to open with.
     ///
     /// @return A promise to have the file opened.
     event::Future<> open(
         const std::string& path,
-        const std::ios::openmode mode = std::ios::in | std::ios::out
+        const std::ios::openmode mode = std::ios::in | std::ios::out,
+        const OpenFlags flags = NONE
     );
 
     // ---------------------------------------------------------------------- //
@@ -52,6 +127,32 @@ public:
 
     // ---------------------------------------------------------------------- //
 
+    /// @brief Allocates a buffer fit for reading and writing this file.
+    ///
+    /// For `DIRECT` files the buffer is aligned to `direct_alignment` and its
+    /// size is rounded up to a multiple of it. Otherwise it comes from the
+    /// file's allocator, if it has one, or is a plain buffer.
+    ///
+    /// @param size The number of bytes needed.
+    ///
+    /// @return The new buffer.
+    memory::Buffer allocate( const std::size_t size );
+
+    // ---------------------------------------------------------------------- //
+
+    /// @brief Sets where `allocate`, and so every read which allocates its own
+    /// buffer, gets memory from.
+    ///
+    /// A `memory::BufferPool` here lets short-lived read buffers be recycled
+    /// instead of going through `new` each time. `DIRECT` files keep using
+    /// aligned buffers regardless. The allocator must outlive every buffer
+    /// read with it.
+    ///
+    /// @param allocator The allocator to use, or null for plain buffers.
+    void allocator( memory::Allocator* allocator );
+
+    // ---------------------------------------------------------------------- //
+
     /// @brief Reads from the file into the provided buffer.
     ///
     /// At most `data.size()` bytes will be read from the file. The actual
@@ -87,61 +188,409 @@ public:
 
     // ---------------------------------------------------------------------- //
 
+    /// @brief Reads from the given position in the file into the buffer.
+    ///
+    /// Positional reads do not use or move the shared file position, so any
+    /// number of them may run in parallel. At most `data.size()` bytes will be
+    /// read. It is up to the caller to ensure the lifetime of the given buffer
+    /// exceeds that of the this function's execution.
+    ///
+    /// @param offset   The position in the file to start reading from.
+    /// @param data     The buffer to read into.
+    ///
+    /// @return A future integer containing the number of bytes read.
+    event::Future< int > read_at( const std::uint64_t offset, memory::Buffer& data );
+
+    // ---------------------------------------------------------------------- //
+
+    /// @brief Reads up to the given number of bytes from the given position.
+    ///
+    /// @param offset   The position in the file to start reading from.
+    /// @param bytes    The maximum number of bytes to read.
+    ///
+    /// @return A future buffer tight-wrapped around the read data.
+    event::Future< memory::Buffer > read_at(
+        const std::uint64_t offset,
+        const std::size_t bytes
+    );
+
+    // ---------------------------------------------------------------------- //
+
+    /// @brief Writes data to the given position in the file.
+    ///
+    /// Like `read_at`, this leaves the shared file position alone.
+    ///
+    /// @param offset   The position in the file to start writing at.
+    /// @param data     The data to write.
+    ///
+    /// @return A promise to have the data written.
+    event::Future<> write_at( const std::uint64_t offset, const memory::Buffer& data );
+
+    // ---------------------------------------------------------------------- //
+
+    /// @brief Reads into several buffers, in order, with a single request.
+    ///
+    /// Each buffer is filled completely before moving on to the next. It is up
+    /// to the caller to keep the buffers alive until the read completes.
+    ///
+    /// @param buffers The buffers to scatter the read data into.
+    ///
+    /// @return A future integer containing the total number of bytes read.
+    event::Future< int > readv( const std::vector< memory::Buffer* >& buffers );
+
+    /// @copydoc File::readv(const std::vector<memory::Buffer*>&)
+    ///
+    /// @param offset The position in the file to start reading from.
+    event::Future< int > readv(
+        const std::uint64_t offset,
+        const std::vector< memory::Buffer* >& buffers
+    );
+
+    // ---------------------------------------------------------------------- //
+
+    /// @brief Writes several buffers, in order, with a single request.
+    ///
+    /// This lets a header and body go out together without first copying them
+    /// into one buffer or paying for two trips through the threadpool.
+    ///
+    /// @param buffers The buffers to gather the written data from.
+    ///
+    /// @return A future integer containing the total number of bytes written.
+    event::Future< int > writev( const std::vector< const memory::Buffer* >& buffers );
+
+    /// @copydoc File::writev(const std::vector<const memory::Buffer*>&)
+    ///
+    /// @param offset The position in the file to start writing at.
+    event::Future< int > writev(
+        const std::uint64_t offset,
+        const std::vector< const memory::Buffer* >& buffers
+    );
+
+    /// @brief Writes every piece of a chain, in order, with a single request.
+    ///
+    /// The chain must be left alone until the write completes.
+    ///
+    /// @param chain The data to write.
+    ///
+    /// @return A future integer containing the total number of bytes written.
+    event::Future< int > writev( const memory::BufferChain& chain );
+
+    /// @copydoc File::writev(const memory::BufferChain&)
+    ///
+    /// @param offset The position in the file to start writing at.
+    event::Future< int > writev(
+        const std::uint64_t offset,
+        const memory::BufferChain& chain
+    );
+
+    // ---------------------------------------------------------------------- //
+
+    /// @brief Reads the whole file from the start, keeping reads in flight
+    /// ahead of the consumer.
+    ///
+    /// Up to `depth` positional reads of `chunk_size` bytes are kept running at
+    /// once, and chunks are delivered to `callback` in file order. Chunk
+    /// buffers are drawn from a pool and go back to it when the consumer
+    /// releases them, so holding onto chunks costs memory but not throughput.
+    /// The file must outlive the read.
+    ///
+    /// @param chunk_size   The number of bytes to read at a time.
+    /// @param depth        The most reads to have in flight at once.
+    /// @param callback     The functor to call with each chunk, in order.
+    ///
+    /// @return A promise for the total number of bytes read, resolved at the
+    ///     end of the file.
+    ///
+    /// @throws FileError If `chunk_size` is zero, or is not a multiple of
+    ///     `direct_alignment` on a `DIRECT` file.
+    event::Future< std::uint64_t > read_stream(
+        const std::size_t chunk_size,
+        const std::size_t depth,
+        const chunk_callback_t& callback
+    );
+
+    // ---------------------------------------------------------------------- //
+
+    /// @brief Streams the file like `read_stream`, checksumming each chunk on
+    /// its way to the callback.
+    ///
+    /// @param chunk_size   The number of bytes to read at a time.
+    /// @param depth        The most reads to have in flight at once.
+    /// @param callback     The functor to call with each chunk, in order.
+    ///
+    /// @return A promise for the byte count and checksum of the whole file.
+    ///
+    /// @throws FileError Under the same conditions as `read_stream`.
+    event::Future< StreamDigest > read_stream_digest(
+        const std::size_t chunk_size,
+        const std::size_t depth,
+        const chunk_callback_t& callback
+    );
+
+    // ---------------------------------------------------------------------- //
+
+    /// @brief Folds everything read through the shared file position into a
+    /// checksum.
+    ///
+    /// Data is added as each read completes, so only one checksummed read or
+    /// write may be in flight at a time. Starting another before it finishes
+    /// throws a `FileError`. Positional reads are left out.
+    ///
+    /// @param digest The checksum to add to, or null to stop.
+    void digest_reads( const std::shared_ptr< memory::Crc32c >& digest );
+
+    // ---------------------------------------------------------------------- //
+
+    /// @brief Folds everything written through the shared file position into a
+    /// checksum.
+    ///
+    /// Only the bytes the kernel accepted are added, under the same ordering
+    /// rule as `digest_reads`.
+    ///
+    /// @param digest The checksum to add to, or null to stop.
+    void digest_writes( const std::shared_ptr< memory::Crc32c >& digest );
+
+    // ---------------------------------------------------------------------- //
+
+    /// @brief Sends part of the file into a stream without copying it through
+    /// userspace.
+    ///
+    /// The data is moved by the kernel with `sendfile`, one chunk per trip
+    /// through the threadpool so a large file does not hold a thread for the
+    /// whole transfer. When the stream is full, the loop waits for it to drain
+    /// before the next chunk is queued. Nothing else may be written to the
+    /// stream until the returned promise settles. The file and the stream must
+    /// outlive the transfer.
+    ///
+    /// @param destination  The stream to send to.
+    /// @param offset       The position in the file to start sending from.
+    /// @param length       The most bytes to send. Sending stops early at the
+    ///                     end of the file.
+    /// @param progress     Optional functor to call after each chunk is sent.
+    ///
+    /// @return A promise for the number of bytes sent.
+    ///
+    /// @throws FileError If the stream has no descriptor or has writes queued.
+    event::Future< std::uint64_t > send_to(
+        event::BasicStream& destination,
+        const std::uint64_t offset,
+        const std::uint64_t length,
+        const progress_callback_t& progress = nullptr
+    );
+
+    // ---------------------------------------------------------------------- //
+
+    /// @brief Flushes the file's data and metadata to disk.
+    ///
+    /// @return A promise to have the file flushed.
+    event::Future<> sync( void );
+
+    // ---------------------------------------------------------------------- //
+
+    /// @brief Flushes the file's data to disk, skipping metadata which is not
+    /// needed to read it back, such as modification times.
+    ///
+    /// @return A promise to have the file's data flushed.
+    event::Future<> datasync( void );
+
+    // ---------------------------------------------------------------------- //
+
+    /// @brief Maps part of the file into memory, read-only.
+    ///
+    /// The file must be open for reading. Views taken from the mapping keep it
+    /// alive, so the file itself may be closed while they are in use.
+    ///
+    /// @param offset   The position in the file to start the mapping at.
+    /// @param length   The number of bytes to map, or 0 to map to the end.
+    ///
+    /// @return The new mapping.
+    ///
+    /// @throws FileError If the file could not be mapped.
+    std::shared_ptr< MappedFile > map(
+        const std::uint64_t offset = 0,
+        const std::size_t length = 0
+    );
+
+    // ---------------------------------------------------------------------- //
+
     /// @brief Gives access to the least-abstracted layer.
-    int lowest_layer( void ){
-        return m_file_descriptor;
-    }
+    int lowest_layer( void ) const;
+
+    // ---------------------------------------------------------------------- //
+
+    /// @brief The number of operations on this file which have not completed.
+    std::size_t in_flight( void ) const;
 
     // ---------------------------------------------------------------------- //
 
 private:
-    /// @brief Handler for open requests.
-    static void _open_cb( uv_fs_s* handle );
+    struct _State;      ///< Type used for managing the shared file state.
+    struct _Request;    ///< Type used for a single in-flight operation.
+    struct _Send;       ///< Type used for tracking a `send_to` transfer.
 
     // ---------------------------------------------------------------------- //
 
-    /// @brief Handler for close requests.
-    static void _close_cb( uv_fs_s* handle );
+    /// @brief Takes an idle request from the pool, or makes a new one.
+    ///
+    /// The request is bound to this file's state and given a fresh promise.
+    _Request& _acquire_request( void );
 
     // ---------------------------------------------------------------------- //
 
-    /// @brief Handler for read requests.
-    static void _read_cb( uv_fs_s* handle );
+    /// @brief Returns a finished request to its file's pool.
+    ///
+    /// Requests beyond the pool's limit are deleted instead.
+    static void _release_request( _Request& request );
 
     // ---------------------------------------------------------------------- //
 
-    /// @brief Handler for write requests.
-    static void _write_cb( uv_fs_s* handle );
+    /// @brief Checks the result of submitting a request to libuv.
+    ///
+    /// @param request  The request which was submitted.
+    /// @param result   The value returned by the `uv_fs_*` call.
+    ///
+    /// @return A future for the result of the request.
+    ///
+    /// @throws FileError If the request could not be submitted.
+    event::Future< int > _submit( _Request& request, const int result );
 
     // ---------------------------------------------------------------------- //
 
-    /// @brief Creates a new promise and returns the associate future.
+    /// @brief Queues a request on the file's io_uring.
+    ///
+    /// @param request  The request being submitted.
+    /// @param submit   A functor which queues the request's operation.
     ///
-    /// @return The future half of the new promise.
-    event::Future<> _reset_promise( void );
+    /// @return A future for the result of the request.
+    ///
+    /// @throws UringError If the operation could not be queued.
+    template< typename Submit >
+    event::Future< int > _submit_uring( _Request& request, Submit&& submit );
+
+    // ---------------------------------------------------------------------- //
+
+    /// @brief Checks a request against the alignment rules of `DIRECT` files.
+    ///
+    /// Failing requests are released before throwing.
+    ///
+    /// @param request  The request with its buffers filled in.
+    /// @param offset   The file position of the request, or -1 for the current.
+    ///
+    /// @throws FileError If a buffer's address or length, or the offset, is
+    ///     not a multiple of `direct_alignment`.
+    void _check_alignment( _Request& request, const std::int64_t offset );
+
+    // ---------------------------------------------------------------------- //
+
+    /// @brief Attaches a checksum to a request through the shared position.
+    ///
+    /// Failing requests are released before throwing.
+    ///
+    /// @param request  The request to fold into the checksum.
+    /// @param digest   The checksum to add to, or null for none.
+    ///
+    /// @throws FileError If a checksummed request is already in flight.
+    void _start_digest(
+        _Request& request,
+        const std::shared_ptr< memory::Crc32c >& digest
+    );
+
+    // ---------------------------------------------------------------------- //
+
+    /// @brief Submits a read into the request's buffers.
+    ///
+    /// @param request  The request with its buffers filled in.
+    /// @param offset   The file position to read from, or -1 for the current.
+    ///
+    /// @return A future for the number of bytes read.
+    event::Future< int > _read( _Request& request, const std::int64_t offset );
+
+    // ---------------------------------------------------------------------- //
+
+    /// @brief Submits a write from the request's buffers.
+    ///
+    /// @param request  The request with its buffers filled in.
+    /// @param offset   The file position to write to, or -1 for the current.
+    ///
+    /// @return A future for the number of bytes written.
+    event::Future< int > _write( _Request& request, const std::int64_t offset );
+
+    // ---------------------------------------------------------------------- //
+
+    /// @brief Submits one `sendfile` from this file to the given descriptor.
+    ///
+    /// @param out_fd   The descriptor to send to.
+    /// @param offset   The position in the file to send from.
+    /// @param length   The most bytes to send.
+    ///
+    /// @return A future for the number of bytes sent.
+    event::Future< int > _send_chunk(
+        const int out_fd,
+        const std::uint64_t offset,
+        const std::size_t length
+    );
+
+    // ---------------------------------------------------------------------- //
+
+    /// @brief Handler for threadpool file requests.
+    static void _request_cb( uv_fs_s* handle );
+
+    // ---------------------------------------------------------------------- //
+
+    /// @brief Handler for io_uring file requests.
+    static void _uring_cb( Uring::Completion& completion, int result );
+
+    // ---------------------------------------------------------------------- //
+
+    /// @brief Returns the request to the pool, then settles its promise.
+    ///
+    /// @param request  The finished request.
+    /// @param result   The result of the operation, negative on failure.
+    static void _complete( _Request& request, const int result );
 
     // ---------------------------------------------------------------------- //
 
     event::Loop& m_loop;
-    uv_fs_s* m_handle;
-    std::unique_ptr< event::Promise<> > m_promise;
-    int m_file_descriptor;
-    uv_buf_t* m_uv_buffer;
+    std::shared_ptr< _State > m_state;
 };
 
 // -------------------------------------------------------------------------- //
 
 /// @brief Asynchronously opens a file.
 ///
-/// @param loop The event loop to open the file with.
-/// @param path The path to the file to open.
-/// @param mode The file mode to use.
+/// @param loop   The event loop to open the file with.
+/// @param path   The path to the file to open.
+/// @param mode   The file mode to use.
+/// @param flags  Extra options to open with.
 ///
 /// @return A future file.
 event::Future< std::shared_ptr< File > > open(
     event::Loop& loop,
     const std::string& path,
-    const std::ios::openmode mode = std::ios::in | std::ios::out
+    const std::ios::openmode mode = std::ios::in | std::ios::out,
+    const File::OpenFlags flags = File::NONE
+);
+
+// -------------------------------------------------------------------------- //
+
+/// @brief Copies a file without moving its contents through userspace.
+///
+/// The destination is created or truncated. On Linux the data is moved in
+/// chunks with `copy_file_range`, falling back to `sendfile` across
+/// filesystems which do not support it. Elsewhere the whole copy is done by
+/// `uv_fs_copyfile`, and progress is only reported once at the end.
+///
+/// @param loop         The event loop to copy with.
+/// @param source       The path of the file to copy.
+/// @param destination  The path to copy the file to.
+/// @param progress     Optional functor to call after each chunk is copied.
+///
+/// @return A promise for the number of bytes copied.
+event::Future< std::uint64_t > copy_file(
+    event::Loop& loop,
+    const std::string& source,
+    const std::string& destination,
+    const File::progress_callback_t& progress = nullptr
 );
 
 }
@@ -0,0 +1,78 @@
+#include "lw/io/FileCache.hpp"
+#include "lw/io/WatchedCache.hpp"
+
+namespace lw {
+namespace io {
+
+struct FileCache::_State {
+    typedef _details::WatchedCache<std::shared_ptr<File>> cache_t;
+
+    _State(event::Loop& _loop, const Options& options):
+        loop(_loop),
+        files(_loop, options.max_files)
+    {}
+
+    event::Loop& loop;
+    cache_t files; ///< Dropping a file here closes it once whoever is using it lets go.
+};
+
+// ---------------------------------------------------------------------------------------------- //
+
+FileCache::FileCache(event::Loop& loop, const Options& options):
+    m_state(std::make_shared<_State>(loop, options))
+{}
+
+// ---------------------------------------------------------------------------------------------- //
+
+FileCache::~FileCache(void){}
+
+// ---------------------------------------------------------------------------------------------- //
+
+event::Future<std::shared_ptr<File>> FileCache::open(
+    const std::string& path,
+    const std::ios::openmode mode
+){
+    event::Loop& loop = m_state->loop;
+    return m_state->files.get(
+        _State::cache_t::key_t(path, (int)mode),
+        [&loop](const _State::cache_t::key_t& key){
+            // Like an `ifstream`, only opening for output may create the file.
+            const std::ios::openmode mode = (std::ios::openmode)key.second;
+            const File::OpenFlags flags = mode & std::ios::out ? File::NONE : File::NO_CREATE;
+            return io::open(loop, key.first, mode, flags);
+        }
+    );
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void FileCache::invalidate(const std::string& path){
+    m_state->files.invalidate(path);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void FileCache::clear(void){
+    m_state->files.clear();
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+std::size_t FileCache::size(void) const {
+    return m_state->files.size();
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+FileCache::Stats FileCache::stats(void) const {
+    const _details::CacheCounters& counters = m_state->files.counters();
+    Stats stats;
+    stats.hits          = counters.hits;
+    stats.misses        = counters.misses;
+    stats.evictions     = counters.evictions;
+    stats.invalidations = counters.invalidations;
+    return stats;
+}
+
+}
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ios>
+#include <memory>
+#include <string>
+
+#include "lw/event.hpp"
+#include "lw/io/File.hpp"
+
+namespace lw {
+namespace io {
+
+/// @brief Keeps open file descriptors around for files which are opened over and over.
+///
+/// Opening a cached path hands out the same `File` as every other open of that path and mode, so
+/// only positional reads and writes should be used with it. Descriptors are never closed out from
+/// under their users: evicting or invalidating an entry only drops the cache's reference, and the
+/// file closes once the last handle to it is gone.
+///
+/// Entries are dropped when they are pushed out by newer entries, or when an `io::Watcher` on
+/// their directory reports a change to them.
+class FileCache {
+public:
+    /// @brief Settings for how many files to keep open.
+    struct Options {
+        Options(void):
+            max_files(1024)
+        {}
+
+        /// @brief The most files to keep open, dropping the least recently used beyond this.
+        std::size_t max_files;
+    };
+
+    /// @brief Cache effectiveness counters.
+    struct Stats {
+        std::uint64_t hits;             ///< Opens served from the cache.
+        std::uint64_t misses;           ///< Opens which had to go to the filesystem.
+        std::uint64_t evictions;        ///< Entries dropped to stay within `max_files`.
+        std::uint64_t invalidations;    ///< Entries dropped because their file changed.
+    };
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Constructs an empty cache.
+    ///
+    /// @param loop     The event loop to open files and watch directories with.
+    /// @param options  How many files to keep open.
+    FileCache(event::Loop& loop, const Options& options = Options());
+
+    /// @brief No copying.
+    FileCache(const FileCache&) = delete;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Stops watching directories and drops all entries.
+    ~FileCache(void);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Gets a shared handle to a file.
+    ///
+    /// Concurrent opens of the same path and mode share one `uv_fs_open` request. Missing files
+    /// are only created when `mode` includes `std::ios::out`, otherwise the open is rejected.
+    ///
+    /// @param path The path to open.
+    /// @param mode The mode to open the file in.
+    ///
+    /// @return A promise for the open file.
+    event::Future<std::shared_ptr<File>> open(
+        const std::string& path,
+        const std::ios::openmode mode = std::ios::in
+    );
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Drops the entries for a path in every mode.
+    ///
+    /// @param path The path to forget.
+    void invalidate(const std::string& path);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Drops every cached entry.
+    void clear(void);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief The number of files currently cached.
+    std::size_t size(void) const;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Gets the cache's counters.
+    Stats stats(void) const;
+
+    // ------------------------------------------------------------------------------------------ //
+
+private:
+    struct _State; ///< Type used for managing internal state.
+
+    // ------------------------------------------------------------------------------------------ //
+
+    std::shared_ptr<_State> m_state; ///< The cache state.
+};
+
+}
+}
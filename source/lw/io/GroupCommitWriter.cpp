@@ -0,0 +1,172 @@
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "lw/io/GroupCommitWriter.hpp"
+
+namespace lw {
+namespace io {
+
+namespace _details {
+    struct CommitGroup {
+        std::vector<GroupCommitWriter::buffer_ptr_t> records;
+        std::vector<event::Promise<>> waiters;
+    };
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+struct GroupCommitWriter::_State {
+    _State(event::Loop& _loop, File& _file, const Options& _options):
+        loop(_loop),
+        file(_file),
+        options(_options),
+        scheduled(false),
+        committing(false),
+        commits(0)
+    {
+        options.max_batch = std::max<std::size_t>(options.max_batch, 1);
+    }
+
+    event::Loop& loop;
+    File& file;
+    Options options;
+    _details::CommitGroup pending;
+    bool scheduled;
+    bool committing;
+    std::uint64_t commits;
+    std::unique_ptr<error::Exception> failure;
+};
+
+// ---------------------------------------------------------------------------------------------- //
+
+GroupCommitWriter::GroupCommitWriter(event::Loop& loop, File& file, const Options& options):
+    m_state(std::make_shared<_State>(loop, file, options))
+{}
+
+// ---------------------------------------------------------------------------------------------- //
+
+event::Future<> GroupCommitWriter::append(const buffer_ptr_t& record){
+    if (m_state->failure) {
+        return event::reject(m_state->loop, *m_state->failure);
+    }
+
+    _details::CommitGroup& pending = m_state->pending;
+    pending.records.push_back(record);
+    pending.waiters.emplace_back();
+    auto future = pending.waiters.back().future();
+
+    // While a commit is running, appends pile up and go out as soon as it finishes.
+    if (m_state->committing) {
+        return future;
+    }
+
+    if (pending.records.size() >= m_state->options.max_batch) {
+        _commit(m_state);
+    }
+    else if (!m_state->scheduled) {
+        m_state->scheduled = true;
+        auto state = m_state;
+        event::wait(m_state->loop, m_state->options.window).then([state](){
+            state->scheduled = false;
+            _commit(state);
+        });
+    }
+    return future;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+std::uint64_t GroupCommitWriter::commits(void) const {
+    return m_state->commits;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+bool GroupCommitWriter::failed(void) const {
+    return (bool)m_state->failure;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void GroupCommitWriter::_commit(const std::shared_ptr<_State>& state){
+    _details::CommitGroup& pending = state->pending;
+    if (state->committing || pending.records.empty()) {
+        return;
+    }
+
+    // Take up to a full batch off the front of the pending records.
+    auto group = std::make_shared<_details::CommitGroup>();
+    const std::size_t count = std::min(pending.records.size(), state->options.max_batch);
+    if (count == pending.records.size()) {
+        std::swap(group->records, pending.records);
+        std::swap(group->waiters, pending.waiters);
+    }
+    else {
+        group->records.assign(
+            std::make_move_iterator(pending.records.begin()),
+            std::make_move_iterator(pending.records.begin() + count)
+        );
+        group->waiters.assign(
+            std::make_move_iterator(pending.waiters.begin()),
+            std::make_move_iterator(pending.waiters.begin() + count)
+        );
+        pending.records.erase(pending.records.begin(), pending.records.begin() + count);
+        pending.waiters.erase(pending.waiters.begin(), pending.waiters.begin() + count);
+    }
+
+    std::vector<const memory::Buffer*> buffers;
+    std::size_t expected = 0;
+    buffers.reserve(group->records.size());
+    for (const auto& record : group->records) {
+        buffers.push_back(record.get());
+        expected += record->size();
+    }
+
+    state->committing = true;
+    try {
+        state->file.writev(buffers)
+            .then([state, expected](int written){
+                if ((std::size_t)written != expected) {
+                    throw FileError(5, "Group commit was only partially written.");
+                }
+                return state->file.datasync();
+            })
+            .then(
+                [state, group](){
+                    for (auto& waiter : group->waiters) {
+                        waiter.resolve();
+                    }
+                    state->committing = false;
+                    ++state->commits;
+                    _commit(state);
+                },
+                [state, group](const error::Exception& err){
+                    // Whatever did land is now a torn record at the end of the file, so anything
+                    // appended after it would be unreadable. Fail everything from here on.
+                    state->failure = std::make_unique<error::Exception>(err);
+                    for (auto& waiter : group->waiters) {
+                        waiter.reject(err);
+                    }
+                    _details::CommitGroup dropped;
+                    std::swap(dropped, state->pending);
+                    state->committing = false;
+                    for (auto& waiter : dropped.waiters) {
+                        waiter.reject(err);
+                    }
+                }
+            );
+    }
+    catch (const error::Exception& err) {
+        // Nothing reached the file when the write is refused outright, so only this group fails.
+        state->committing = false;
+        for (auto& waiter : group->waiters) {
+            waiter.reject(err);
+        }
+        _commit(state);
+    }
+}
+
+}
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "lw/event.hpp"
+#include "lw/io/File.hpp"
+#include "lw/memory.hpp"
+
+namespace lw {
+namespace io {
+
+/// @brief Makes appends durable by committing them to a file in groups.
+///
+/// Records appended while a commit is pending are collected and written together with a single
+/// `writev`, followed by a single `fdatasync`. Every record in the group is resolved at once when
+/// the sync completes, so many callers share the cost of each trip to the disk.
+///
+/// If a group fails to be written or synced, the end of the file may hold part of it. The writer
+/// then fails, rejecting every pending and later append with the same error.
+///
+/// Records are written at the file's current position, so the file should normally be opened
+/// with `std::ios::app`. The file must outlive the writer.
+class GroupCommitWriter {
+public:
+    /// @brief Records are passed around as shared buffers.
+    typedef std::shared_ptr<const memory::Buffer> buffer_ptr_t;
+
+    /// @brief Settings for how records are grouped.
+    struct Options {
+        Options(void):
+            window(0),
+            max_batch(256)
+        {}
+
+        /// @brief How long to collect appends before committing them.
+        ///
+        /// With no window, appends made in the same loop iteration are committed together.
+        event::Timeout::resolution window;
+
+        /// @brief The most records to commit in one group.
+        ///
+        /// Reaching this starts a commit without waiting for the window.
+        std::size_t max_batch;
+    };
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Constructs a writer for an open file.
+    ///
+    /// @param loop     The event loop to schedule commits on.
+    /// @param file     The file to append to.
+    /// @param options  How records should be grouped.
+    GroupCommitWriter(event::Loop& loop, File& file, const Options& options = Options());
+
+    /// @brief No copying.
+    GroupCommitWriter(const GroupCommitWriter&) = delete;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Queues a record to be appended.
+    ///
+    /// The record must not be modified until the returned future settles.
+    ///
+    /// @param record The data to append.
+    ///
+    /// @return A promise to have the record written and synced to disk. It is rejected straight
+    ///         away if the writer has failed.
+    event::Future<> append(const buffer_ptr_t& record);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief The number of groups committed so far.
+    std::uint64_t commits(void) const;
+
+    /// @brief Indicates if a commit has failed, after which every append is rejected.
+    bool failed(void) const;
+
+    // ------------------------------------------------------------------------------------------ //
+
+private:
+    struct _State; ///< Type used for managing internal state.
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Writes and syncs the next group of records, if one is not already in progress.
+    ///
+    /// @param state The writer to commit for.
+    static void _commit(const std::shared_ptr<_State>& state);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    std::shared_ptr<_State> m_state; ///< The writer state.
+};
+
+}
+}
@@ -0,0 +1,334 @@
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <iterator>
+#include <utility>
+#include <uv.h>
+#include <vector>
+
+#include "lw/io/LogWriter.hpp"
+
+namespace lw {
+namespace io {
+
+namespace _details {
+    std::string segment_path(const std::string& path, const std::size_t index){
+        char suffix[32];
+        std::snprintf(suffix, sizeof(suffix), ".%06zu", index);
+        return path + suffix;
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    struct PreallocateRequest {
+        uv_work_t request;
+        int fd;
+        std::uint64_t length;
+        event::Promise<> promise;
+    };
+
+    /// @brief Reserves disk space for a file on the threadpool.
+    ///
+    /// Preallocation is only an optimization, so failures are ignored and the promise is always
+    /// resolved.
+    event::Future<> preallocate(event::Loop& loop, const int fd, const std::uint64_t length){
+#ifdef __linux__
+        if (length > 0) {
+            auto prealloc_req = new PreallocateRequest();
+            prealloc_req->request.data  = (void*)prealloc_req;
+            prealloc_req->fd            = fd;
+            prealloc_req->length        = length;
+            auto future = prealloc_req->promise.future();
+
+            int res = uv_queue_work(
+                loop.lowest_layer(),
+                &prealloc_req->request,
+                [](uv_work_t* req){
+                    // Keep the size so readers only see what has really been written.
+                    auto& prealloc_req = *(PreallocateRequest*)req->data;
+                    ::fallocate(
+                        prealloc_req.fd,
+                        FALLOC_FL_KEEP_SIZE,
+                        0,
+                        (off_t)prealloc_req.length
+                    );
+                },
+                [](uv_work_t* req, int){
+                    std::unique_ptr<PreallocateRequest> prealloc_req(
+                        (PreallocateRequest*)req->data
+                    );
+                    prealloc_req->promise.resolve();
+                }
+            );
+
+            if (res == 0) {
+                return future;
+            }
+            delete prealloc_req;
+        }
+#endif
+        return event::resolve(loop);
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+struct LogWriter::_State {
+    _State(event::Loop& _loop, const std::string& _path, const Options& _options):
+        loop(_loop),
+        path(_path),
+        options(_options),
+        segment(0),
+        offset(0),
+        appended(0),
+        written(0),
+        writing(false),
+        opening(false)
+    {
+        active.reserve(options.buffer_size);
+        flushing.reserve(options.buffer_size);
+    }
+
+    event::Loop& loop;
+    std::string path;
+    Options options;
+    std::shared_ptr<File> file;
+    std::size_t segment;
+    std::uint64_t offset;
+    std::uint64_t appended;
+    std::uint64_t written;
+    bool writing;
+    bool opening;
+    std::vector<memory::byte> active;
+    std::vector<memory::byte> flushing;
+    std::vector<std::pair<std::uint64_t, event::Promise<>>> waiters;
+    std::shared_ptr<event::Promise<>> close_waiter;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Puts the flushed bytes past `written` back in front of anything appended since, so
+    /// the next flush carries on from there in order.
+    void requeue(const std::size_t written){
+        flushing.erase(flushing.begin(), flushing.begin() + written);
+        flushing.insert(flushing.end(), active.begin(), active.end());
+        std::swap(active, flushing);
+        flushing.clear();
+        writing = false;
+    }
+};
+
+// ---------------------------------------------------------------------------------------------- //
+
+LogWriter::LogWriter(event::Loop& loop, const std::string& path, const Options& options):
+    m_state(std::make_shared<_State>(loop, path, options)),
+    m_timer(loop)
+{}
+
+// ---------------------------------------------------------------------------------------------- //
+
+LogWriter::~LogWriter(void){
+    m_timer.stop();
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+event::Future<> LogWriter::open(void){
+    auto state = m_state;
+    m_timer.repeat(m_state->options.flush_interval, [state](event::Timeout&){
+        _flush(state);
+    });
+    return _open_segment(m_state);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void LogWriter::write(const void* data, const std::size_t size){
+    const memory::byte* bytes = (const memory::byte*)data;
+    m_state->active.insert(m_state->active.end(), bytes, bytes + size);
+    m_state->appended += size;
+    if (m_state->active.size() >= m_state->options.buffer_size) {
+        _flush(m_state);
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+event::Future<> LogWriter::flush(void){
+    if (m_state->written == m_state->appended) {
+        return event::resolve(m_state->loop);
+    }
+
+    m_state->waiters.emplace_back(m_state->appended, event::Promise<>());
+    auto future = m_state->waiters.back().second.future();
+    _flush(m_state);
+    return future;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+event::Future<> LogWriter::close(void){
+    m_timer.stop();
+    auto state = m_state;
+    return flush().then([state](){
+        return _close_segment(state);
+    });
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+std::size_t LogWriter::segment(void) const {
+    return m_state->segment;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+std::string LogWriter::segment_path(const std::size_t index) const {
+    return _details::segment_path(m_state->path, index);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void LogWriter::_flush(const std::shared_ptr<_State>& state){
+    if (state->writing || state->opening || !state->file || state->active.empty()) {
+        return;
+    }
+
+    // Swap buffers so writes can carry on into the other one while this one goes to disk.
+    std::swap(state->active, state->flushing);
+    state->writing = true;
+    auto view = std::make_shared<memory::Buffer>(
+        state->flushing.data(),
+        state->flushing.size(),
+        false
+    );
+
+    state->file->writev(state->offset, {view.get()}).then(
+        [state, view](int bytes){
+            if (bytes <= 0) {
+                state->requeue(0);
+                _fail(state, FileError(12, "Log write made no progress."));
+                return;
+            }
+
+            // A short write usually means the next one will fail, so go straight on to find out.
+            const std::size_t written = (std::size_t)bytes;
+            const bool short_write = written < view->size();
+            state->requeue(written);
+            state->offset += written;
+            state->written += written;
+
+            // Take out everyone whose data has now been written before settling them, as their
+            // continuations may well write and flush again.
+            auto end = state->waiters.begin();
+            while (end != state->waiters.end() && end->first <= state->written) {
+                ++end;
+            }
+            std::vector<std::pair<std::uint64_t, event::Promise<>>> done(
+                std::make_move_iterator(state->waiters.begin()),
+                std::make_move_iterator(end)
+            );
+            state->waiters.erase(state->waiters.begin(), end);
+
+            if (state->offset >= state->options.segment_size) {
+                _rotate(state);
+            }
+            else if (
+                short_write ||
+                !state->waiters.empty() ||
+                state->active.size() >= state->options.buffer_size
+            ){
+                _flush(state);
+            }
+
+            for (auto& waiter : done) {
+                waiter.second.resolve();
+            }
+        },
+        [state](const error::Exception& err){
+            state->requeue(0);
+            _fail(state, err);
+        }
+    );
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+event::Future<> LogWriter::_open_segment(const std::shared_ptr<_State>& state){
+    state->opening = true;
+    state->offset = 0;
+    state->file = std::make_shared<File>(state->loop);
+
+    auto file = state->file;
+    const std::string path = _details::segment_path(state->path, state->segment);
+    return file->open(path, std::ios::out | std::ios::trunc)
+        .then([state, file](){
+            return _details::preallocate(
+                state->loop,
+                file->lowest_layer(),
+                state->options.preallocate
+            );
+        })
+        .then([state](){
+            state->opening = false;
+
+            // A close that arrived mid-rotation was waiting for the new segment to open.
+            if (state->close_waiter) {
+                auto close_waiter = std::move(state->close_waiter);
+                _close_segment(state).then(
+                    [close_waiter](){ close_waiter->resolve(); },
+                    [close_waiter](const error::Exception& err){ close_waiter->reject(err); }
+                );
+                return;
+            }
+            _flush(state);
+        })
+    ;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+event::Future<> LogWriter::_close_segment(const std::shared_ptr<_State>& state){
+    if (state->opening) {
+        state->close_waiter = std::make_shared<event::Promise<>>();
+        return state->close_waiter->future();
+    }
+
+    // Closing before opening, or a second time, has nothing left to do.
+    if (!state->file) {
+        return event::resolve(state->loop);
+    }
+
+    auto file = std::move(state->file);
+    return file->close().then([file](){});
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void LogWriter::_rotate(const std::shared_ptr<_State>& state){
+    // The old segment is kept alive until its close completes.
+    auto old_file = std::move(state->file);
+    old_file->close().then([old_file](){});
+
+    ++state->segment;
+    _open_segment(state).then(
+        [](){},
+        [state](const error::Exception& err){
+            _fail(state, err);
+        }
+    );
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void LogWriter::_fail(const std::shared_ptr<_State>& state, const error::Exception& err){
+    auto waiters = std::move(state->waiters);
+    state->waiters.clear();
+    for (auto& waiter : waiters) {
+        waiter.second.reject(err);
+    }
+}
+
+}
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "lw/event.hpp"
+#include "lw/io/File.hpp"
+#include "lw/memory.hpp"
+
+namespace lw {
+namespace io {
+
+/// @brief Buffered writer for append-only, segmented log files.
+///
+/// Writes are copied into an in-memory buffer and nothing else, so they are cheap enough for hot
+/// paths. The buffer is written out with one large write when it fills or when the flush
+/// interval passes, while a second buffer takes new writes. Each segment file is preallocated
+/// with `fallocate` so appends do not keep growing its extents. Once a segment reaches the
+/// configured size the writer moves on to a new one.
+///
+/// Segments are named `<path>.<index>` with a six-digit, zero-padded index starting at 0. Each
+/// flush goes entirely into one segment, so a segment may run past `segment_size` by up to one
+/// flush.
+class LogWriter {
+public:
+    /// @brief Settings for buffering and segmenting the log.
+    struct Options {
+        Options(void):
+            buffer_size(1024 * 1024),
+            flush_interval(100),
+            segment_size(256 * 1024 * 1024),
+            preallocate(256 * 1024 * 1024)
+        {}
+
+        /// @brief Flush once this many bytes are buffered.
+        std::size_t buffer_size;
+
+        /// @brief Flush whatever is buffered this often.
+        event::Timeout::resolution flush_interval;
+
+        /// @brief Start a new segment once the current one reaches this size.
+        std::uint64_t segment_size;
+
+        /// @brief Bytes to reserve on disk for each new segment, or 0 to skip preallocation.
+        std::uint64_t preallocate;
+    };
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Constructs a writer for the log at the given path.
+    ///
+    /// @param loop     The event loop to write and flush on.
+    /// @param path     The path segment file names are built from.
+    /// @param options  How the log should be buffered and segmented.
+    LogWriter(event::Loop& loop, const std::string& path, const Options& options = Options());
+
+    /// @brief No copying.
+    LogWriter(const LogWriter&) = delete;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Stops the flush timer.
+    ///
+    /// Buffered data which has not been flushed is lost, so call `close` first.
+    ~LogWriter(void);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Opens the first segment and starts the flush timer.
+    ///
+    /// @return A promise to have the log ready for writing.
+    event::Future<> open(void);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Appends data to the log.
+    ///
+    /// The data is copied, so it may be reused as soon as this returns.
+    ///
+    /// @param data The bytes to append.
+    /// @param size The number of bytes to append.
+    void write(const void* data, const std::size_t size);
+
+    /// @copydoc LogWriter::write(const void*, const std::size_t)
+    ///
+    /// @param record The data to append.
+    void write(const memory::Buffer& record){
+        write(record.data(), record.size());
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Writes out everything appended so far.
+    ///
+    /// Short writes are carried on from where they stopped. If a write fails, everyone waiting on
+    /// a flush is rejected and the data is kept to be retried by the next flush.
+    ///
+    /// @return A promise to have all data appended before this call written to the file.
+    event::Future<> flush(void);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Flushes the log and closes the current segment.
+    ///
+    /// Closing a log which is not open does nothing.
+    ///
+    /// @return A promise to have the log flushed and closed.
+    event::Future<> close(void);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief The index of the segment currently being written.
+    std::size_t segment(void) const;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief The file path of the given segment.
+    ///
+    /// @param index The segment to get the path of.
+    std::string segment_path(const std::size_t index) const;
+
+    // ------------------------------------------------------------------------------------------ //
+
+private:
+    struct _State; ///< Type used for managing internal state.
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Writes out the active buffer if nothing is in the way.
+    static void _flush(const std::shared_ptr<_State>& state);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Opens and preallocates the current segment.
+    static event::Future<> _open_segment(const std::shared_ptr<_State>& state);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Closes the current segment, waiting for it to finish opening if need be.
+    static event::Future<> _close_segment(const std::shared_ptr<_State>& state);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Closes the current segment and moves on to the next.
+    static void _rotate(const std::shared_ptr<_State>& state);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Rejects everyone waiting on a flush.
+    static void _fail(const std::shared_ptr<_State>& state, const error::Exception& err);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    std::shared_ptr<_State> m_state;    ///< The writer state.
+    event::Timeout m_timer;             ///< Periodically flushes the log.
+};
+
+}
+}
@@ -0,0 +1,163 @@
+
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <uv.h>
+
+#include "lw/io/File.hpp"
+#include "lw/io/MappedFile.hpp"
+
+namespace lw {
+namespace io {
+
+namespace _details {
+    struct PrefaultRequest {
+        uv_work_t request;
+        std::shared_ptr<MappedFile> mapping;
+        const volatile memory::byte* begin;
+        std::size_t size;
+        event::Promise<> promise;
+    };
+
+    FileError errno_error(const int err){
+        return FileError(-err, (std::string)uv_err_name(-err) + ": " + std::strerror(err));
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+std::shared_ptr<MappedFile> MappedFile::map(
+    event::Loop& loop,
+    const int fd,
+    const std::uint64_t offset,
+    std::size_t length
+){
+    if (length == 0) {
+        struct stat info;
+        if (::fstat(fd, &info) < 0) {
+            throw _details::errno_error(errno);
+        }
+        if ((std::uint64_t)info.st_size > offset) {
+            length = (std::size_t)(info.st_size - offset);
+        }
+    }
+    if (length == 0) {
+        throw FileError(2, "Cannot map an empty range of a file.");
+    }
+
+    // Mappings must start on a page boundary, so map from the page holding `offset`.
+    static const std::uint64_t page_size = (std::uint64_t)::sysconf(_SC_PAGESIZE);
+    const std::uint64_t region_offset = offset - (offset % page_size);
+    const std::size_t skip = (std::size_t)(offset - region_offset);
+    const std::size_t region_size = skip + length;
+
+    void* region = ::mmap(nullptr, region_size, PROT_READ, MAP_SHARED, fd, (off_t)region_offset);
+    if (region == MAP_FAILED) {
+        throw _details::errno_error(errno);
+    }
+
+    return std::shared_ptr<MappedFile>(new MappedFile(loop, region, region_size, skip, length));
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+MappedFile::MappedFile(
+    event::Loop& loop,
+    void* region,
+    const std::size_t region_size,
+    const std::size_t skip,
+    const std::size_t length
+):
+    m_loop(loop),
+    m_region(region),
+    m_region_size(region_size),
+    m_buffer((memory::byte*)region + skip, length, false)
+{}
+
+// ---------------------------------------------------------------------------------------------- //
+
+MappedFile::~MappedFile(void){
+    ::munmap(m_region, m_region_size);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+MappedFile::buffer_ptr_t MappedFile::view(const std::size_t offset, std::size_t length){
+    if (offset > size()) {
+        throw FileError(3, "View starts past the end of the mapping.");
+    }
+    if (length == 0) {
+        length = size() - offset;
+    }
+    if (length > size() - offset) {
+        throw FileError(4, "View runs past the end of the mapping.");
+    }
+
+    auto mapping = shared_from_this();
+    return buffer_ptr_t(
+        new memory::Buffer((memory::byte*)m_buffer.data() + offset, length, false),
+        [mapping](const memory::Buffer* view){ delete view; }
+    );
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void MappedFile::advise(const Advice advice){
+    int flag = MADV_NORMAL;
+    switch (advice) {
+        case NORMAL:     flag = MADV_NORMAL;     break;
+        case SEQUENTIAL: flag = MADV_SEQUENTIAL; break;
+        case RANDOM:     flag = MADV_RANDOM;     break;
+        case WILL_NEED:  flag = MADV_WILLNEED;   break;
+    }
+
+    if (::madvise(m_region, m_region_size, flag) < 0) {
+        throw _details::errno_error(errno);
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+event::Future<> MappedFile::prefault(void){
+    auto prefault_req = new _details::PrefaultRequest();
+    prefault_req->request.data  = (void*)prefault_req;
+    prefault_req->mapping       = shared_from_this();
+    prefault_req->begin         = (const volatile memory::byte*)m_region;
+    prefault_req->size          = m_region_size;
+    auto future = prefault_req->promise.future();
+
+    int res = uv_queue_work(
+        m_loop.lowest_layer(),
+        &prefault_req->request,
+        [](uv_work_t* req){
+            // Reading one byte from each page is enough to fault it in.
+            auto& prefault_req = *(_details::PrefaultRequest*)req->data;
+            static const std::size_t page_size = (std::size_t)::sysconf(_SC_PAGESIZE);
+            for (std::size_t i = 0; i < prefault_req.size; i += page_size) {
+                (void)prefault_req.begin[i];
+            }
+        },
+        [](uv_work_t* req, int status){
+            std::unique_ptr<_details::PrefaultRequest> prefault_req(
+                (_details::PrefaultRequest*)req->data
+            );
+            if (status < 0) {
+                prefault_req->promise.reject(LW_UV_ERROR(FileError, status));
+            }
+            else {
+                prefault_req->promise.resolve();
+            }
+        }
+    );
+
+    if (res < 0) {
+        delete prefault_req;
+        throw LW_UV_ERROR(FileError, res);
+    }
+    return future;
+}
+
+}
+}
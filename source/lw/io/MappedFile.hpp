@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "lw/error.hpp"
+#include "lw/event.hpp"
+#include "lw/memory.hpp"
+
+namespace lw {
+namespace io {
+
+/// @brief A read-only memory mapping of part of a file.
+///
+/// The mapping is removed once the `MappedFile` and every view taken from it have been released,
+/// so views can be handed around like any other shared buffer without copying the data.
+class MappedFile : public std::enable_shared_from_this<MappedFile> {
+public:
+    /// @brief Views of the mapping are passed around as shared buffers.
+    typedef std::shared_ptr<const memory::Buffer> buffer_ptr_t;
+
+    /// @brief Hints about how the mapping will be accessed, passed on to `madvise`.
+    enum Advice {
+        NORMAL,     ///< No special treatment.
+        SEQUENTIAL, ///< Pages will be read in order, so read ahead aggressively.
+        RANDOM,     ///< Pages will be read in no particular order, so skip read-ahead.
+        WILL_NEED   ///< Pages will be needed soon, so start reading them in now.
+    };
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Maps part of an open file into memory.
+    ///
+    /// @param loop     The event loop to run prefaulting on.
+    /// @param fd       The file descriptor to map, which must be open for reading.
+    /// @param offset   The position in the file to start the mapping at.
+    /// @param length   The number of bytes to map, or 0 to map to the end of the file.
+    ///
+    /// @return The new mapping.
+    ///
+    /// @throws FileError If the file could not be mapped, or the range is empty.
+    static std::shared_ptr<MappedFile> map(
+        event::Loop& loop,
+        const int fd,
+        const std::uint64_t offset = 0,
+        const std::size_t length = 0
+    );
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief No copying.
+    MappedFile(const MappedFile&) = delete;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Unmaps the file.
+    ~MappedFile(void);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief The mapped bytes.
+    ///
+    /// The buffer does not own the mapping, so it is only valid while this object is.
+    const memory::Buffer& buffer(void) const {
+        return m_buffer;
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief The number of bytes mapped.
+    std::size_t size(void) const {
+        return m_buffer.size();
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Takes a view of part of the mapping which keeps the mapping alive.
+    ///
+    /// @param offset The position in the mapping to start the view at.
+    /// @param length The number of bytes to view, or 0 for the rest of the mapping.
+    ///
+    /// @return A shared buffer over the requested range.
+    ///
+    /// @throws FileError If the range does not fit in the mapping.
+    buffer_ptr_t view(const std::size_t offset = 0, const std::size_t length = 0);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Tells the kernel how the mapping will be used.
+    ///
+    /// @param advice The expected access pattern.
+    void advise(const Advice advice);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Faults every page of the mapping in on the threadpool.
+    ///
+    /// Once resolved, reading the mapping from the loop thread will not block on disk unless the
+    /// kernel has since evicted the pages.
+    ///
+    /// @return A promise to have the mapping paged in.
+    event::Future<> prefault(void);
+
+    // ------------------------------------------------------------------------------------------ //
+
+private:
+    /// @brief Takes ownership of an existing mapping.
+    ///
+    /// @param loop         The event loop to run prefaulting on.
+    /// @param region       The start of the mapped region, which is page aligned.
+    /// @param region_size  The size of the mapped region.
+    /// @param skip         The bytes at the start of the region before the requested data.
+    /// @param length       The number of bytes requested.
+    MappedFile(
+        event::Loop& loop,
+        void* region,
+        const std::size_t region_size,
+        const std::size_t skip,
+        const std::size_t length
+    );
+
+    // ------------------------------------------------------------------------------------------ //
+
+    event::Loop& m_loop;        ///< The loop prefaulting is reported on.
+    void* m_region;             ///< The page-aligned start of the mapping.
+    std::size_t m_region_size;  ///< The size of the whole mapping.
+    memory::Buffer m_buffer;    ///< Non-owning buffer over the requested bytes.
+};
+
+}
+}
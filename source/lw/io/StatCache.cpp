@@ -0,0 +1,91 @@
+#include "lw/io/StatCache.hpp"
+#include "lw/io/WatchedCache.hpp"
+
+namespace lw {
+namespace io {
+
+struct StatCache::_State {
+    typedef _details::WatchedCache<Stat> cache_t;
+
+    _State(event::Loop& _loop, const Options& options):
+        loop(_loop),
+        stats(_loop, options.max_entries, options.ttl),
+        files(_loop, file_options(options))
+    {}
+
+    event::Loop& loop;
+    cache_t stats;
+    FileCache files;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    static FileCache::Options file_options(const Options& options){
+        FileCache::Options file_options;
+        file_options.max_files = options.max_entries;
+        return file_options;
+    }
+};
+
+// ---------------------------------------------------------------------------------------------- //
+
+StatCache::StatCache(event::Loop& loop, const Options& options):
+    m_state(std::make_shared<_State>(loop, options))
+{}
+
+// ---------------------------------------------------------------------------------------------- //
+
+StatCache::~StatCache(void){}
+
+// ---------------------------------------------------------------------------------------------- //
+
+event::Future<Stat> StatCache::stat(const std::string& path){
+    event::Loop& loop = m_state->loop;
+    return m_state->stats.get(
+        _State::cache_t::key_t(path, 0),
+        [&loop](const _State::cache_t::key_t& key){
+            return io::stat(loop, key.first);
+        }
+    );
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+event::Future<std::shared_ptr<File>> StatCache::open(const std::string& path){
+    return m_state->files.open(path);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void StatCache::invalidate(const std::string& path){
+    m_state->stats.invalidate(path);
+    m_state->files.invalidate(path);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void StatCache::clear(void){
+    m_state->stats.clear();
+    m_state->files.clear();
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+std::size_t StatCache::size(void) const {
+    return m_state->stats.size();
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+StatCache::Stats StatCache::stats(void) const {
+    const _details::CacheCounters& counters = m_state->stats.counters();
+    const FileCache::Stats files = m_state->files.stats();
+    Stats stats;
+    stats.hits          = counters.hits + files.hits;
+    stats.misses        = counters.misses + files.misses;
+    stats.evictions     = counters.evictions + files.evictions;
+    stats.invalidations = counters.invalidations + files.invalidations;
+    return stats;
+}
+
+}
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "lw/event.hpp"
+#include "lw/io/File.hpp"
+#include "lw/io/FileCache.hpp"
+#include "lw/io/fs.hpp"
+
+namespace lw {
+namespace io {
+
+/// @brief Remembers file metadata and read-only file handles for hot paths.
+///
+/// Cached entries are served straight from memory without a trip through the threadpool. Each
+/// entry lives until its time-to-live runs out, it is pushed out by newer entries, or a change is
+/// reported in its directory. Directories are watched with an `io::Watcher` for as long as any of
+/// their entries are cached.
+///
+/// Concurrent misses on the same path share one `stat` request. File handles are kept by an
+/// internal `FileCache`, so they are not bound by the time-to-live.
+class StatCache {
+public:
+    /// @brief Settings for how long and how much to cache.
+    struct Options {
+        Options(void):
+            ttl(1000),
+            max_entries(4096)
+        {}
+
+        /// @brief How long an entry may be served for after it is looked up.
+        event::Timeout::resolution ttl;
+
+        /// @brief The most paths to keep, dropping the least recently used beyond this.
+        ///
+        /// Open files are limited to the same number separately.
+        std::size_t max_entries;
+    };
+
+    /// @brief Cache effectiveness counters.
+    struct Stats {
+        std::uint64_t hits;             ///< Lookups served from the cache.
+        std::uint64_t misses;           ///< Lookups which had to go to the filesystem.
+        std::uint64_t evictions;        ///< Entries dropped to stay within `max_entries`.
+        std::uint64_t invalidations;    ///< Entries dropped because their file changed.
+    };
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Constructs an empty cache.
+    ///
+    /// @param loop     The event loop to look paths up and watch directories with.
+    /// @param options  How long and how much to cache.
+    StatCache(event::Loop& loop, const Options& options = Options());
+
+    /// @brief No copying.
+    StatCache(const StatCache&) = delete;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Stops watching directories and drops all entries.
+    ~StatCache(void);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Gets the metadata for a path, following symbolic links.
+    ///
+    /// @param path The path to look up.
+    ///
+    /// @return A promise for the path's metadata.
+    event::Future<Stat> stat(const std::string& path);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Gets a shared, read-only handle to a file.
+    ///
+    /// The handle is shared by everyone who opens the path while it is cached, so use positional
+    /// reads with it. Dropping the entry does not close the file until the last handle is gone.
+    /// Missing files are never created, the open is rejected instead.
+    ///
+    /// @param path The path to open.
+    ///
+    /// @return A promise for the open file.
+    event::Future<std::shared_ptr<File>> open(const std::string& path);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Drops any cached entry for a path.
+    ///
+    /// @param path The path to forget.
+    void invalidate(const std::string& path);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Drops every cached entry.
+    void clear(void);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief The number of paths currently cached.
+    std::size_t size(void) const;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Gets the cache's counters.
+    Stats stats(void) const;
+
+    // ------------------------------------------------------------------------------------------ //
+
+private:
+    struct _State; ///< Type used for managing internal state.
+
+    // ------------------------------------------------------------------------------------------ //
+
+    std::shared_ptr<_State> m_state; ///< The cache state.
+};
+
+}
+}
@@ -0,0 +1,98 @@
+
+#include <cstdlib>
+#include <uv.h>
+
+#include "lw/error.hpp"
+#include "lw/io/address.hpp"
+#include "lw/io/Tcp.hpp"
+
+namespace lw {
+namespace io {
+
+Tcp::Tcp(event::Loop& loop):
+    event::BasicStream(_make_state(loop))
+{}
+
+// ---------------------------------------------------------------------------------------------- //
+
+event::Future<> Tcp::connect(const std::string& host, const std::uint16_t port){
+    if (m_connect_promise.is_finished() || m_connect_req != nullptr) {
+        throw TcpError(1, "Cannot connect a TCP stream twice.");
+    }
+
+    sockaddr_storage addr;
+    parse_address(host, port, addr);
+
+    // Set up the connection request.
+    m_connect_req = std::shared_ptr<uv_connect_t>(
+        (uv_connect_t*)std::malloc(sizeof(uv_connect_t)),
+        &std::free
+    );
+    m_connect_req->data = (void*)this;
+
+    // Start the connection.
+    int res = uv_tcp_connect(
+        m_connect_req.get(),
+        (uv_tcp_t*)&handle(),
+        (const sockaddr*)&addr,
+        [](uv_connect_t* req, int status){
+            Tcp& tcp = *(Tcp*)req->data;
+            if (status < 0) {
+                tcp.m_connect_promise.reject(LW_UV_ERROR(TcpError, status));
+            }
+            else {
+                tcp.m_connect_promise.resolve();
+            }
+            tcp.m_connect_req.reset();
+        }
+    );
+
+    if (res < 0) {
+        m_connect_req.reset();
+        throw LW_UV_ERROR(TcpError, res);
+    }
+
+    // Return a future.
+    return m_connect_promise.future();
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void Tcp::nodelay(const bool enable){
+    int res = uv_tcp_nodelay((uv_tcp_t*)&handle(), enable);
+    if (res < 0) {
+        throw LW_UV_ERROR(TcpError, res);
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void Tcp::keepalive(const bool enable, const std::chrono::seconds& delay){
+    int res = uv_tcp_keepalive((uv_tcp_t*)&handle(), enable, delay.count());
+    if (res < 0) {
+        throw LW_UV_ERROR(TcpError, res);
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void Tcp::parse_address(
+    const std::string& host,
+    const std::uint16_t port,
+    sockaddr_storage& addr
+){
+    if (!io::parse_address(host, port, addr)) {
+        throw TcpError(2, "Invalid address: " + host);
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+uv_stream_s* Tcp::_make_state(event::Loop& loop){
+    uv_tcp_t* tcp = (uv_tcp_t*)std::malloc(sizeof(uv_tcp_t));
+    uv_tcp_init(loop.lowest_layer(), tcp);
+    return (uv_stream_s*)tcp;
+}
+
+}
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "lw/event.hpp"
+
+struct sockaddr_storage;
+struct uv_connect_s;
+
+namespace lw {
+namespace io {
+
+LW_DEFINE_EXCEPTION_EX(TcpError, ::lw::event, StreamError);
+
+class TcpServer;
+
+// ---------------------------------------------------------------------------------------------- //
+
+/// @brief A TCP connection.
+class Tcp : public event::BasicStream {
+public:
+    /// @brief Constructs an unconnected TCP stream.
+    ///
+    /// @param loop The event loop for the connection.
+    Tcp(event::Loop& loop);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Connects to a remote host.
+    ///
+    /// @param host The IPv4 or IPv6 address of the host to connect to.
+    /// @param port The port to connect to.
+    ///
+    /// @return A promise to be connected.
+    event::Future<> connect(const std::string& host, const std::uint16_t port);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Enables or disables Nagle's algorithm.
+    ///
+    /// @param enable True to send small writes immediately instead of coalescing them.
+    void nodelay(const bool enable);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Enables or disables TCP keep-alive probes.
+    ///
+    /// @param enable   True to enable keep-alive.
+    /// @param delay    How long the connection must be idle before the first probe is sent.
+    void keepalive(
+        const bool enable,
+        const std::chrono::seconds& delay = std::chrono::seconds(60)
+    );
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Parses a numeric IPv4 or IPv6 address.
+    ///
+    /// @param host The address to parse.
+    /// @param port The port to pair with the address.
+    /// @param addr The structure to fill with the parsed address.
+    ///
+    /// @throws TcpError If `host` is not a valid address.
+    static void parse_address(
+        const std::string& host,
+        const std::uint16_t port,
+        sockaddr_storage& addr
+    );
+
+    // ------------------------------------------------------------------------------------------ //
+
+private:
+    friend class TcpServer;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Constructs the libuv handle for a TCP stream.
+    ///
+    /// @param loop The event loop that the stream will use.
+    ///
+    /// @return A new TCP stream handle.
+    static uv_stream_s* _make_state(event::Loop& loop);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    event::Promise<> m_connect_promise;             ///< Promise for making connections.
+    std::shared_ptr<uv_connect_s> m_connect_req;    ///< Connection request handle.
+};
+
+}
+}
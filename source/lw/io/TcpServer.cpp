@@ -0,0 +1,129 @@
+
+#include <cerrno>
+#include <cstdlib>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <uv.h>
+
+#include "lw/error.hpp"
+#include "lw/io/TcpServer.hpp"
+
+namespace lw {
+namespace io {
+
+TcpServer::TcpServer(event::Loop& loop):
+    m_loop(loop),
+    m_handle((uv_tcp_t*)std::malloc(sizeof(uv_tcp_t))),
+    m_connection_callback(nullptr)
+{
+    uv_tcp_init(loop.lowest_layer(), m_handle);
+    m_handle->data = (void*)this;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TcpServer::~TcpServer(void){
+    if (m_handle) {
+        uv_close((uv_handle_t*)m_handle, [](uv_handle_t* handle){ std::free(handle); });
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void TcpServer::bind(const std::string& host, const std::uint16_t port, const bool reuse_port){
+    _check_open();
+    sockaddr_storage addr;
+    Tcp::parse_address(host, port, addr);
+
+    if (reuse_port) {
+#ifdef SO_REUSEPORT
+        // libuv has no option for this, so create the socket ourselves and hand it over.
+        int fd = ::socket(addr.ss_family, SOCK_STREAM, 0);
+        if (fd < 0) {
+            throw LW_UV_ERROR(TcpError, -errno);
+        }
+        int enable = 1;
+        if (::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) < 0) {
+            int err = -errno;
+            ::close(fd);
+            throw LW_UV_ERROR(TcpError, err);
+        }
+        int res = uv_tcp_open(m_handle, fd);
+        if (res < 0) {
+            ::close(fd);
+            throw LW_UV_ERROR(TcpError, res);
+        }
+#else
+        throw TcpError(3, "SO_REUSEPORT is not supported on this platform.");
+#endif
+    }
+
+    int res = uv_tcp_bind(m_handle, (const sockaddr*)&addr, 0);
+    if (res < 0) {
+        throw LW_UV_ERROR(TcpError, res);
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+event::Future<> TcpServer::_listen(const int backlog){
+    _check_open();
+    int res = uv_listen((uv_stream_t*)m_handle, backlog, &TcpServer::_connection_cb);
+    if (res < 0) {
+        throw LW_UV_ERROR(TcpError, res);
+    }
+    return m_listen_promise.future();
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void TcpServer::close(void){
+    if (m_handle) {
+        uv_close((uv_handle_t*)m_handle, [](uv_handle_t* handle){ std::free(handle); });
+        m_handle = nullptr;
+        m_listen_promise.resolve();
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+std::uint16_t TcpServer::port(void) const {
+    _check_open();
+    sockaddr_storage addr;
+    int addr_size = sizeof(addr);
+    int res = uv_tcp_getsockname(m_handle, (sockaddr*)&addr, &addr_size);
+    if (res < 0) {
+        throw LW_UV_ERROR(TcpError, res);
+    }
+    if (addr.ss_family == AF_INET6) {
+        return ntohs(((sockaddr_in6*)&addr)->sin6_port);
+    }
+    return ntohs(((sockaddr_in*)&addr)->sin_port);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void TcpServer::_check_open(void) const {
+    if (!m_handle) {
+        throw TcpError(4, "The server has been closed.");
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void TcpServer::_connection_cb(uv_stream_s* handle, int status){
+    // A failed accept only affects the one connection, so keep listening for the rest.
+    if (status < 0) {
+        return;
+    }
+
+    TcpServer& server = *(TcpServer*)handle->data;
+    auto connection = std::make_shared<Tcp>(server.m_loop);
+    if (uv_accept(handle, &connection->handle()) < 0) {
+        return;
+    }
+    server.m_connection_callback(connection);
+}
+
+}
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "lw/event.hpp"
+#include "lw/io/Tcp.hpp"
+
+struct uv_tcp_s;
+
+namespace lw {
+namespace io {
+
+/// @brief Listens for and accepts TCP connections.
+///
+/// To spread accepts across several threads, give each thread its own `event::Loop` and
+/// `TcpServer`, and bind them all to the same port with `reuse_port` enabled. The kernel will then
+/// balance incoming connections between the listening sockets without a central acceptor.
+class TcpServer {
+public:
+    /// @brief Connection callback functor type.
+    ///
+    /// @param connection The newly accepted connection.
+    typedef std::function<void(std::shared_ptr<Tcp> connection)> connection_callback_t;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Constructs an unbound server.
+    ///
+    /// @param loop The event loop to accept connections on.
+    TcpServer(event::Loop& loop);
+
+    /// @brief No copying.
+    TcpServer(const TcpServer&) = delete;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Destructor will close the server if it is open.
+    ~TcpServer(void);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Binds the server to a local address.
+    ///
+    /// @param host         The IPv4 or IPv6 address to listen on.
+    /// @param port         The port to listen on, or 0 to have one assigned.
+    /// @param reuse_port   Set `SO_REUSEPORT` so other sockets can bind to the same port.
+    ///
+    /// @throws TcpError
+    ///     If the server is closed, the address is invalid, or `reuse_port` is not supported.
+    void bind(const std::string& host, const std::uint16_t port, const bool reuse_port = false);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Starts accepting connections.
+    ///
+    /// @tparam Func A functor matching `connection_callback_t`.
+    ///
+    /// @param func     The functor to call with each accepted connection.
+    /// @param backlog  The maximum number of connections waiting to be accepted.
+    ///
+    /// @throws TcpError If the server is closed.
+    ///
+    /// @return A promise that will be resolved once the server is closed.
+    template<typename Func>
+    event::Future<> listen(Func&& func, const int backlog = 128){
+        m_connection_callback = std::forward<Func>(func);
+        return _listen(backlog);
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Stops accepting connections and resolves the listen promise.
+    ///
+    /// Connections already accepted are unaffected.
+    void close(void);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Gets the local port the server is bound to.
+    ///
+    /// @throws TcpError If the server is closed.
+    std::uint16_t port(void) const;
+
+    // ------------------------------------------------------------------------------------------ //
+
+private:
+    /// @brief Handler for incoming connections.
+    static void _connection_cb(uv_stream_s* handle, int status);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Starts listening on the bound socket.
+    event::Future<> _listen(const int backlog);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Throws `TcpError` if the server has been closed.
+    void _check_open(void) const;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    event::Loop& m_loop;                            ///< The loop connections are accepted on.
+    uv_tcp_s* m_handle;                             ///< The listening socket handle.
+    connection_callback_t m_connection_callback;    ///< The functor to call with connections.
+    event::Promise<> m_listen_promise;              ///< Promise resolved when the server closes.
+};
+
+}
+}
@@ -0,0 +1,374 @@
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <functional>
+#include <list>
+#include <sys/socket.h>
+#include <uv.h>
+
+#include "lw/error.hpp"
+#include "lw/io/address.hpp"
+#include "lw/io/Udp.hpp"
+
+namespace lw {
+namespace io {
+
+namespace _details {
+    struct UdpSendBatch {
+        event::Promise<std::size_t> promise;
+        std::size_t pending;
+        std::size_t sent;
+        bool failed;
+    };
+
+    struct UdpSendRequest {
+        uv_udp_send_t request;
+        std::shared_ptr<const memory::Buffer> datagram;
+        std::function<void(int status)> on_sent;
+    };
+
+    void parse_address(
+        const std::string& host,
+        const std::uint16_t port,
+        sockaddr_storage& addr
+    ){
+        if (!io::parse_address(host, port, addr)) {
+            throw UdpError(2, "Invalid address: " + host);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+struct Udp::_State : public std::enable_shared_from_this<_State> {
+    _State(event::Loop& loop, const std::size_t batch_size);
+    ~_State(void);
+
+    uv_udp_t* handle;
+    std::size_t batch_size;
+    receive_callback_t receive_callback;
+    std::size_t receive_count;
+    std::unique_ptr<event::Promise<std::size_t>> receive_promise;
+    std::list<memory::Buffer> idle_batches;
+    std::shared_ptr<memory::Buffer> current_batch;
+    Stats stats;
+};
+
+// ---------------------------------------------------------------------------------------------- //
+
+/// @brief The largest datagram libuv will receive into a single batch slot.
+static const std::size_t MAX_DATAGRAM_SIZE = 64 * 1024;
+
+/// @brief The most messages Linux accepts in a single `sendmmsg` call.
+static const std::size_t MAX_SEND_BATCH = 1024;
+
+// ---------------------------------------------------------------------------------------------- //
+
+Udp::_State::_State(event::Loop& loop, const std::size_t _batch_size):
+    handle((uv_udp_t*)std::malloc(sizeof(uv_udp_t))),
+    batch_size(std::max<std::size_t>(_batch_size, 1)),
+    receive_callback(nullptr),
+    receive_count(0),
+    stats{0, 0, 0, 0}
+{
+    // The socket is created lazily on bind or first send so it can take the address's family.
+    uv_udp_init_ex(loop.lowest_layer(), handle, AF_UNSPEC | UV_UDP_RECVMMSG);
+    handle->data = (void*)this;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+Udp::_State::~_State(void){
+    uv_close((uv_handle_t*)handle, [](uv_handle_t* handle){ std::free(handle); });
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+Udp::Udp(event::Loop& loop, const std::size_t batch_size):
+    m_loop(loop),
+    m_state(std::make_shared<_State>(loop, batch_size))
+{}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void Udp::bind(const std::string& host, const std::uint16_t port){
+    sockaddr_storage addr;
+    _details::parse_address(host, port, addr);
+
+    int res = uv_udp_bind(m_state->handle, (const sockaddr*)&addr, 0);
+    if (res < 0) {
+        throw LW_UV_ERROR(UdpError, res);
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+std::uint16_t Udp::port(void) const {
+    sockaddr_storage addr;
+    int addr_size = sizeof(addr);
+    int res = uv_udp_getsockname(m_state->handle, (sockaddr*)&addr, &addr_size);
+    if (res < 0) {
+        throw LW_UV_ERROR(UdpError, res);
+    }
+    if (addr.ss_family == AF_INET6) {
+        return ntohs(((sockaddr_in6*)&addr)->sin6_port);
+    }
+    return ntohs(((sockaddr_in*)&addr)->sin_port);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+event::Future<std::size_t> Udp::receive(const receive_callback_t& cb){
+    if (m_state->receive_promise) {
+        throw UdpError(1, "Socket is already receiving.");
+    }
+
+    int res = uv_udp_recv_start(m_state->handle, &Udp::_alloc_cb, &Udp::_recv_cb);
+    if (res < 0) {
+        throw LW_UV_ERROR(UdpError, res);
+    }
+
+    m_state->receive_callback = cb;
+    m_state->receive_count = 0;
+    m_state->receive_promise.reset(new event::Promise<std::size_t>());
+    return m_state->receive_promise->future();
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void Udp::stop_receive(void){
+    if (!m_state->receive_promise) {
+        return;
+    }
+
+    uv_udp_recv_stop(m_state->handle);
+    m_state->receive_callback = nullptr;
+    m_state->current_batch.reset();
+
+    auto promise = std::move(m_state->receive_promise);
+    promise->resolve(m_state->receive_count);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+event::Future<std::size_t> Udp::send(
+    const buffer_ptr_t& datagram,
+    const std::string& host,
+    const std::uint16_t port
+){
+    return send(std::vector<buffer_ptr_t>{datagram}, host, port);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+event::Future<std::size_t> Udp::send(
+    const std::vector<buffer_ptr_t>& datagrams,
+    const std::string& host,
+    const std::uint16_t port
+){
+    sockaddr_storage addr;
+    _details::parse_address(host, port, addr);
+
+    std::size_t sent = _send_direct(datagrams, addr);
+    if (sent == datagrams.size()) {
+        return event::resolve(m_loop, std::move(sent));
+    }
+
+    // Whatever the socket would not take right away goes through libuv's send queue.
+    auto batch = std::make_shared<_details::UdpSendBatch>();
+    batch->pending = datagrams.size() - sent;
+    batch->sent = sent;
+    batch->failed = false;
+    for (std::size_t i = sent; i < datagrams.size(); ++i) {
+        auto req = new _details::UdpSendRequest();
+        req->request.data = (void*)req;
+        req->datagram = datagrams[i];
+
+        auto state = m_state;
+        req->on_sent = [state, batch](int status){
+            --batch->pending;
+            if (status < 0) {
+                if (!batch->failed) {
+                    batch->failed = true;
+                    batch->promise.reject(LW_UV_ERROR(UdpError, status));
+                }
+                return;
+            }
+
+            ++state->stats.send_syscalls;
+            ++state->stats.datagrams_sent;
+            ++batch->sent;
+            if (batch->pending == 0 && !batch->failed) {
+                batch->promise.resolve(batch->sent);
+            }
+        };
+        uv_buf_t buffer = uv_buf_init((char*)req->datagram->data(), req->datagram->size());
+
+        int res = uv_udp_send(
+            &req->request,
+            m_state->handle,
+            &buffer,
+            1,
+            (const sockaddr*)&addr,
+            [](uv_udp_send_t* uv_req, int status){
+                std::unique_ptr<_details::UdpSendRequest> req(
+                    (_details::UdpSendRequest*)uv_req->data
+                );
+                req->on_sent(status);
+            }
+        );
+
+        if (res < 0) {
+            delete req;
+            if (i == sent) {
+                throw LW_UV_ERROR(UdpError, res); // Nothing is in flight yet.
+            }
+
+            // Some datagrams are already queued, so settle the batch now and let their
+            // callbacks drain without touching it again.
+            batch->pending -= datagrams.size() - i;
+            batch->failed = true;
+            batch->promise.reject(LW_UV_ERROR(UdpError, res));
+            break;
+        }
+    }
+
+    return batch->promise.future();
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+Udp::Stats Udp::stats(void) const {
+    return m_state->stats;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void Udp::_alloc_cb(uv_handle_s* handle, std::size_t, uv_buf_t* buffer){
+    _State& state = *(_State*)handle->data;
+
+    // Batches are handed back to the idle list once every datagram viewing them is released.
+    if (state.idle_batches.empty()) {
+        state.idle_batches.emplace_back(state.batch_size * MAX_DATAGRAM_SIZE);
+    }
+    auto batch = new memory::Buffer(std::move(state.idle_batches.front()));
+    state.idle_batches.pop_front();
+
+    std::weak_ptr<_State> weak_state = state.shared_from_this();
+    state.current_batch = std::shared_ptr<memory::Buffer>(
+        batch,
+        [weak_state](memory::Buffer* batch){
+            if (auto state = weak_state.lock()) {
+                state->idle_batches.emplace_back(std::move(*batch));
+            }
+            delete batch;
+        }
+    );
+
+    *buffer = uv_buf_init((char*)batch->data(), batch->size());
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void Udp::_recv_cb(
+    uv_udp_s* handle,
+    long int size,
+    const uv_buf_t* buffer,
+    const sockaddr* addr,
+    unsigned int flags
+){
+    auto state = ((_State*)handle->data)->shared_from_this();
+
+    if (size < 0) {
+        uv_udp_recv_stop(handle);
+        state->receive_callback = nullptr;
+        state->current_batch.reset();
+
+        auto promise = std::move(state->receive_promise);
+        promise->reject(LW_UV_ERROR(UdpError, size));
+        return;
+    }
+
+    // An address with no data is an empty datagram, but no address means nothing was read.
+    if (addr) {
+        auto batch = state->current_batch;
+        buffer_ptr_t datagram(
+            new memory::Buffer((memory::byte*)buffer->base, (std::size_t)size),
+            [batch](const memory::Buffer* datagram){ delete datagram; }
+        );
+        ++state->stats.datagrams_received;
+        ++state->receive_count;
+        state->receive_callback(std::move(datagram), *addr);
+
+        // Without a batch flag this datagram came from a single, plain receive call.
+        if (!(flags & UV_UDP_MMSG_CHUNK)) {
+            ++state->stats.receive_syscalls;
+            state->current_batch.reset();
+        }
+    }
+    else if (flags & UV_UDP_MMSG_FREE) {
+        ++state->stats.receive_syscalls;
+        state->current_batch.reset();
+    }
+    else {
+        state->current_batch.reset();
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+std::size_t Udp::_send_direct(
+    const std::vector<buffer_ptr_t>& datagrams,
+    const sockaddr_storage& addr
+){
+#ifdef __linux__
+    // Only go around libuv when its queue is empty, otherwise datagrams would be reordered.
+    int fd = -1;
+    if (
+        uv_fileno((uv_handle_t*)m_state->handle, &fd) < 0 ||
+        uv_udp_get_send_queue_count(m_state->handle) > 0
+    ){
+        return 0;
+    }
+
+    const socklen_t addr_size =
+        addr.ss_family == AF_INET6 ? sizeof(sockaddr_in6) : sizeof(sockaddr_in);
+    std::vector<mmsghdr> messages(datagrams.size());
+    std::vector<iovec> iovs(datagrams.size());
+    for (std::size_t i = 0; i < datagrams.size(); ++i) {
+        iovs[i].iov_base = (void*)datagrams[i]->data();
+        iovs[i].iov_len = datagrams[i]->size();
+
+        msghdr& header = messages[i].msg_hdr;
+        header.msg_name = (void*)&addr;
+        header.msg_namelen = addr_size;
+        header.msg_iov = &iovs[i];
+        header.msg_iovlen = 1;
+    }
+
+    std::size_t sent = 0;
+    while (sent < datagrams.size()) {
+        const unsigned int count = std::min<std::size_t>(datagrams.size() - sent, MAX_SEND_BATCH);
+        int res = ::sendmmsg(fd, &messages[sent], count, MSG_DONTWAIT);
+        if (res > 0) {
+            sent += res;
+            ++m_state->stats.send_syscalls;
+            m_state->stats.datagrams_sent += res;
+        }
+        else if (res < 0 && errno == EINTR) {
+            continue;
+        }
+        else {
+            // The socket is full or failed; libuv will queue or report the rest.
+            break;
+        }
+    }
+    return sent;
+#else
+    return 0;
+#endif
+}
+
+}
+}
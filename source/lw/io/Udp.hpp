@@ -0,0 +1,179 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "lw/event.hpp"
+#include "lw/memory.hpp"
+
+struct sockaddr;
+struct sockaddr_storage;
+struct uv_buf_t;
+struct uv_handle_s;
+struct uv_udp_s;
+
+namespace lw {
+namespace io {
+
+LW_DEFINE_EXCEPTION(UdpError);
+
+// ---------------------------------------------------------------------------------------------- //
+
+/// @brief A UDP socket which sends and receives datagrams in batches.
+///
+/// Where the platform supports it, datagrams are received with `recvmmsg` into large pooled batch
+/// buffers, and each datagram is delivered as a view which keeps its batch alive. Batched sends go
+/// out with `sendmmsg` on Linux, falling back to libuv's send queue whenever the socket is busy.
+class Udp {
+public:
+    /// @brief Datagrams are passed around as shared buffers.
+    typedef std::shared_ptr<const memory::Buffer> buffer_ptr_t;
+
+    /// @brief Receive callback functor type.
+    ///
+    /// @param datagram The contents of one datagram.
+    /// @param sender   The address the datagram came from.
+    typedef std::function<void(buffer_ptr_t datagram, const sockaddr& sender)> receive_callback_t;
+
+    /// @brief Counters for measuring how well datagrams are being batched.
+    struct Stats {
+        std::uint64_t datagrams_received;   ///< Total datagrams received.
+        std::uint64_t receive_syscalls;     ///< Receive calls which returned at least one datagram.
+        std::uint64_t datagrams_sent;       ///< Total datagrams sent.
+        std::uint64_t send_syscalls;        ///< Send calls which sent at least one datagram.
+
+        /// @brief The average number of datagrams returned by each receive call.
+        double received_per_syscall(void) const {
+            return receive_syscalls ? (double)datagrams_received / receive_syscalls : 0.0;
+        }
+
+        /// @brief The average number of datagrams sent by each send call.
+        double sent_per_syscall(void) const {
+            return send_syscalls ? (double)datagrams_sent / send_syscalls : 0.0;
+        }
+    };
+
+    /// @brief The default number of datagrams to receive per system call.
+    ///
+    /// libuv caps this at 20 datagrams.
+    static const std::size_t default_batch_size = 20;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Constructs an unbound UDP socket.
+    ///
+    /// @param loop         The event loop for the socket.
+    /// @param batch_size   The maximum number of datagrams to receive per system call.
+    Udp(event::Loop& loop, const std::size_t batch_size = default_batch_size);
+
+    /// @brief No copying.
+    Udp(const Udp&) = delete;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Binds the socket to a local address.
+    ///
+    /// @param host The IPv4 or IPv6 address to bind to.
+    /// @param port The port to bind to, or 0 to have one assigned.
+    void bind(const std::string& host, const std::uint16_t port);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Gets the local port the socket is bound to.
+    std::uint16_t port(void) const;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Starts receiving datagrams.
+    ///
+    /// @param cb The functor to call with each datagram received.
+    ///
+    /// @return
+    ///     A promise for the number of datagrams received, resolved when `stop_receive` is called.
+    event::Future<std::size_t> receive(const receive_callback_t& cb);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Stops receiving datagrams and resolves the receive promise.
+    void stop_receive(void);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Sends a single datagram.
+    ///
+    /// @param datagram The datagram to send.
+    /// @param host     The address to send to.
+    /// @param port     The port to send to.
+    ///
+    /// @return A promise for the number of datagrams sent.
+    event::Future<std::size_t> send(
+        const buffer_ptr_t& datagram,
+        const std::string& host,
+        const std::uint16_t port
+    );
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Sends several datagrams to the same address in as few system calls as possible.
+    ///
+    /// @param datagrams    The datagrams to send, in order.
+    /// @param host         The address to send to.
+    /// @param port         The port to send to.
+    ///
+    /// @return A promise for the number of datagrams sent.
+    event::Future<std::size_t> send(
+        const std::vector<buffer_ptr_t>& datagrams,
+        const std::string& host,
+        const std::uint16_t port
+    );
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Gets the batching counters for this socket.
+    Stats stats(void) const;
+
+    // ------------------------------------------------------------------------------------------ //
+
+private:
+    struct _State; ///< Type used for managing internal state.
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Provides libuv with a batch buffer to receive into.
+    static void _alloc_cb(uv_handle_s* handle, std::size_t size, uv_buf_t* buffer);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Delivers received datagrams.
+    static void _recv_cb(
+        uv_udp_s* handle,
+        long int size,
+        const uv_buf_t* buffer,
+        const sockaddr* addr,
+        unsigned int flags
+    );
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Sends as many datagrams as the socket will immediately take with `sendmmsg`.
+    ///
+    /// @param datagrams    The datagrams to send.
+    /// @param addr         The address to send to.
+    ///
+    /// @return The number of datagrams sent.
+    std::size_t _send_direct(
+        const std::vector<buffer_ptr_t>& datagrams,
+        const sockaddr_storage& addr
+    );
+
+    // ------------------------------------------------------------------------------------------ //
+
+    event::Loop& m_loop;                ///< The loop the socket runs on.
+    std::shared_ptr<_State> m_state;    ///< The socket state.
+};
+
+}
+}
@@ -0,0 +1,387 @@
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <uv.h>
+#include <vector>
+
+#ifdef __linux__
+#   include <linux/io_uring.h>
+#   include <sys/eventfd.h>
+#   include <sys/mman.h>
+#   include <sys/syscall.h>
+#   include <sys/uio.h>
+#   include <unistd.h>
+#endif
+
+#include "lw/io/Uring.hpp"
+
+namespace lw {
+namespace io {
+
+std::shared_ptr<Uring> Uring::create(event::Loop& loop, const unsigned int entries){
+    try {
+        return std::make_shared<Uring>(loop, entries);
+    }
+    catch (const UringError&) {
+        return nullptr;
+    }
+}
+
+#ifdef __linux__
+
+// ---------------------------------------------------------------------------------------------- //
+
+namespace _details {
+    template<typename T>
+    T load_acquire(const T* ptr){
+        return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+    }
+
+    template<typename T>
+    void store_release(T* ptr, const T value){
+        __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+    }
+
+    UringError syscall_error(const int err){
+        return UringError(err, (std::string)"io_uring: " + std::strerror(err));
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+struct Uring::_Ring {
+    _Ring(void):
+        fd(-1),
+        event_fd(-1),
+        sq_ptr(MAP_FAILED),
+        cq_ptr(MAP_FAILED),
+        sqes((io_uring_sqe*)MAP_FAILED)
+    {}
+
+    ~_Ring(void){
+        if (sqes != MAP_FAILED) {
+            ::munmap(sqes, sqes_size);
+        }
+        if (cq_ptr != MAP_FAILED && cq_ptr != sq_ptr) {
+            ::munmap(cq_ptr, cq_size);
+        }
+        if (sq_ptr != MAP_FAILED) {
+            ::munmap(sq_ptr, sq_size);
+        }
+        if (event_fd >= 0) {
+            ::close(event_fd);
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    int fd;
+    int event_fd;
+
+    void* sq_ptr;
+    std::size_t sq_size;
+    void* cq_ptr;
+    std::size_t cq_size;
+    io_uring_sqe* sqes;
+    std::size_t sqes_size;
+
+    unsigned int* sq_head;
+    unsigned int* sq_tail;
+    unsigned int* sq_mask;
+    unsigned int* sq_array;
+    unsigned int sq_entries;
+
+    unsigned int* cq_head;
+    unsigned int* cq_tail;
+    unsigned int* cq_mask;
+    io_uring_cqe* cqes;
+};
+
+// ---------------------------------------------------------------------------------------------- //
+
+Uring::Uring(event::Loop& loop, const unsigned int entries):
+    m_ring(new _Ring()),
+    m_poll(nullptr),
+    m_prepare(nullptr),
+    m_queued(0),
+    m_in_flight(0),
+    m_submit_calls(0)
+{
+    _Ring& ring = *m_ring;
+
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    ring.fd = (int)::syscall(__NR_io_uring_setup, entries, &params);
+    if (ring.fd < 0) {
+        throw _details::syscall_error(errno);
+    }
+
+    // Reads and writes at the current file position need 5.6's RW_CUR_POS.
+    const std::uint32_t required = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_RW_CUR_POS;
+    if ((params.features & required) != required) {
+        throw UringError(1, "io_uring is missing required features.");
+    }
+
+    // Map the rings. With SINGLE_MMAP the completion ring shares the submission ring's mapping.
+    ring.sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    ring.cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    ring.sq_size = ring.cq_size = std::max(ring.sq_size, ring.cq_size);
+    ring.sq_ptr = ::mmap(
+        nullptr, ring.sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+        ring.fd, IORING_OFF_SQ_RING
+    );
+    if (ring.sq_ptr == MAP_FAILED) {
+        throw _details::syscall_error(errno);
+    }
+    ring.cq_ptr = ring.sq_ptr;
+
+    ring.sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    ring.sqes = (io_uring_sqe*)::mmap(
+        nullptr, ring.sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+        ring.fd, IORING_OFF_SQES
+    );
+    if (ring.sqes == MAP_FAILED) {
+        throw _details::syscall_error(errno);
+    }
+
+    char* sq = (char*)ring.sq_ptr;
+    ring.sq_head    = (unsigned int*)(sq + params.sq_off.head);
+    ring.sq_tail    = (unsigned int*)(sq + params.sq_off.tail);
+    ring.sq_mask    = (unsigned int*)(sq + params.sq_off.ring_mask);
+    ring.sq_array   = (unsigned int*)(sq + params.sq_off.array);
+    ring.sq_entries = params.sq_entries;
+
+    char* cq = (char*)ring.cq_ptr;
+    ring.cq_head    = (unsigned int*)(cq + params.cq_off.head);
+    ring.cq_tail    = (unsigned int*)(cq + params.cq_off.tail);
+    ring.cq_mask    = (unsigned int*)(cq + params.cq_off.ring_mask);
+    ring.cqes       = (io_uring_cqe*)(cq + params.cq_off.cqes);
+
+    // Completions are signalled on an eventfd which the loop polls.
+    ring.event_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (ring.event_fd < 0) {
+        throw _details::syscall_error(errno);
+    }
+    int res = (int)::syscall(
+        __NR_io_uring_register, ring.fd, IORING_REGISTER_EVENTFD, &ring.event_fd, 1
+    );
+    if (res < 0) {
+        throw _details::syscall_error(errno);
+    }
+
+    m_poll = (uv_poll_t*)std::malloc(sizeof(uv_poll_t));
+    uv_poll_init(loop.lowest_layer(), m_poll, ring.event_fd);
+    m_poll->data = (void*)this;
+
+    m_prepare = (uv_prepare_t*)std::malloc(sizeof(uv_prepare_t));
+    uv_prepare_init(loop.lowest_layer(), m_prepare);
+    m_prepare->data = (void*)this;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+Uring::~Uring(void){
+    if (m_poll) {
+        uv_close((uv_handle_t*)m_poll, [](uv_handle_t* handle){ std::free(handle); });
+    }
+    if (m_prepare) {
+        uv_close((uv_handle_t*)m_prepare, [](uv_handle_t* handle){ std::free(handle); });
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void Uring::read(
+    const int fd,
+    const iovec* buffers,
+    const unsigned int count,
+    const std::int64_t offset,
+    Completion& completion
+){
+    _queue(IORING_OP_READV, fd, buffers, count, offset, completion);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void Uring::write(
+    const int fd,
+    const iovec* buffers,
+    const unsigned int count,
+    const std::int64_t offset,
+    Completion& completion
+){
+    _queue(IORING_OP_WRITEV, fd, buffers, count, offset, completion);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void Uring::_queue(
+    const std::uint8_t opcode,
+    const int fd,
+    const iovec* buffers,
+    const unsigned int count,
+    const std::int64_t offset,
+    Completion& completion
+){
+    _Ring& ring = *m_ring;
+
+    // Without SQPOLL the kernel consumes every entry during the enter call, so flushing always
+    // makes room.
+    unsigned int tail = *ring.sq_tail;
+    if (tail - _details::load_acquire(ring.sq_head) >= ring.sq_entries) {
+        if (const int error = _submit()) {
+            throw _details::syscall_error(error);
+        }
+        if (tail - _details::load_acquire(ring.sq_head) >= ring.sq_entries) {
+            throw UringError(2, "io_uring submission queue is full.");
+        }
+    }
+
+    const unsigned int index = tail & *ring.sq_mask;
+    io_uring_sqe& sqe = ring.sqes[index];
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode      = opcode;
+    sqe.fd          = fd;
+    sqe.addr        = (std::uint64_t)(std::uintptr_t)buffers;
+    sqe.len         = count;
+    sqe.off         = (std::uint64_t)offset;
+    sqe.user_data   = (std::uint64_t)(std::uintptr_t)&completion;
+    ring.sq_array[index] = index;
+    _details::store_release(ring.sq_tail, tail + 1);
+
+    // Start the loop watchers when the ring goes from idle to busy.
+    if (m_queued++ == 0) {
+        uv_prepare_start(m_prepare, [](uv_prepare_t* handle){
+            ((Uring*)handle->data)->_flush();
+        });
+    }
+    if (m_in_flight++ == 0) {
+        uv_poll_start(m_poll, UV_READABLE, [](uv_poll_t* handle, int, int){
+            ((Uring*)handle->data)->_reap();
+        });
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+int Uring::_submit(void){
+    while (m_queued > 0) {
+        int res = (int)::syscall(__NR_io_uring_enter, m_ring->fd, m_queued, 0, 0, nullptr, 0);
+        if (res < 0) {
+            // Busy rings are retried on the next loop iteration.
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EBUSY) {
+                return 0;
+            }
+            return errno;
+        }
+        ++m_submit_calls;
+        m_queued -= std::min<std::size_t>(m_queued, res);
+    }
+    uv_prepare_stop(m_prepare);
+    return 0;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void Uring::_flush(void){
+    if (const int error = _submit()) {
+        _fail_queued(error);
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void Uring::_fail_queued(const int error){
+    _Ring& ring = *m_ring;
+
+    // The kernel only reads the tail during an enter call, so the unconsumed entries can be taken
+    // back by moving it down to the head again.
+    const unsigned int head = _details::load_acquire(ring.sq_head);
+    const unsigned int tail = *ring.sq_tail;
+    std::vector<Completion*> failed;
+    failed.reserve(tail - head);
+    for (unsigned int i = head; i != tail; ++i) {
+        const io_uring_sqe& sqe = ring.sqes[ring.sq_array[i & *ring.sq_mask]];
+        failed.push_back((Completion*)(std::uintptr_t)sqe.user_data);
+    }
+    _details::store_release(ring.sq_tail, head);
+
+    m_queued = 0;
+    m_in_flight -= failed.size();
+    uv_prepare_stop(m_prepare);
+    if (m_in_flight == 0) {
+        uv_poll_stop(m_poll);
+    }
+
+    // Call back only once the ring is consistent, since the callbacks may queue more work.
+    for (Completion* completion : failed) {
+        completion->callback(*completion, -error);
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void Uring::_reap(void){
+    _Ring& ring = *m_ring;
+
+    std::uint64_t signals;
+    while (::read(ring.event_fd, &signals, sizeof(signals)) > 0) {}
+
+    unsigned int head = *ring.cq_head;
+    while (head != _details::load_acquire(ring.cq_tail)) {
+        const io_uring_cqe& cqe = ring.cqes[head & *ring.cq_mask];
+        Completion& completion = *(Completion*)(std::uintptr_t)cqe.user_data;
+        const int result = cqe.res;
+
+        // Free the slot before calling back, since the callback may well queue more work.
+        _details::store_release(ring.cq_head, ++head);
+        --m_in_flight;
+        completion.callback(completion, result);
+        head = *ring.cq_head;
+    }
+
+    if (m_in_flight == 0) {
+        uv_poll_stop(m_poll);
+    }
+}
+
+#else
+
+// ---------------------------------------------------------------------------------------------- //
+
+struct Uring::_Ring {};
+
+// ---------------------------------------------------------------------------------------------- //
+
+Uring::Uring(event::Loop&, const unsigned int):
+    m_poll(nullptr),
+    m_prepare(nullptr),
+    m_queued(0),
+    m_in_flight(0),
+    m_submit_calls(0)
+{
+    throw UringError(1, "io_uring is only available on Linux.");
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+Uring::~Uring(void){}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void Uring::read(const int, const iovec*, const unsigned int, const std::int64_t, Completion&){}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void Uring::write(const int, const iovec*, const unsigned int, const std::int64_t, Completion&){}
+
+#endif
+
+}
+}
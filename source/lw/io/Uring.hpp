@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "lw/error.hpp"
+#include "lw/event.hpp"
+
+struct iovec;
+struct uv_poll_s;
+struct uv_prepare_s;
+
+namespace lw {
+namespace io {
+
+LW_DEFINE_EXCEPTION(UringError);
+
+// ---------------------------------------------------------------------------------------------- //
+
+/// @brief An io_uring instance whose completions are reaped on an event loop.
+///
+/// Operations queued during a loop iteration are handed to the kernel together with a single
+/// `io_uring_enter` just before the loop next polls. The ring signals completions through an
+/// eventfd which the loop watches, so no threadpool threads are involved in the transfer.
+///
+/// Only Linux 5.6 and newer is supported. Use `Uring::create` to get `nullptr` instead of an
+/// exception where io_uring is unavailable, such as older kernels or sandboxes that block it.
+class Uring {
+public:
+    /// @brief Caller-owned completion record for a single operation.
+    ///
+    /// The record must stay alive until its callback has been called.
+    struct Completion {
+        /// @brief Called on the loop with the operation's result, or a negated `errno`.
+        void (*callback)(Completion& completion, int result);
+
+        /// @brief Free for the caller's use.
+        void* data;
+    };
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Creates a ring if the platform supports it.
+    ///
+    /// @param loop     The event loop to reap completions on.
+    /// @param entries  The submission queue size.
+    ///
+    /// @return A new ring, or `nullptr` if io_uring is not available.
+    static std::shared_ptr<Uring> create(event::Loop& loop, const unsigned int entries = 256);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Sets up a new ring.
+    ///
+    /// @param loop     The event loop to reap completions on.
+    /// @param entries  The submission queue size.
+    ///
+    /// @throws UringError If io_uring is not available.
+    Uring(event::Loop& loop, const unsigned int entries);
+
+    /// @brief No copying.
+    Uring(const Uring&) = delete;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Tears down the ring.
+    ///
+    /// Any operations still in flight will never complete.
+    ~Uring(void);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Queues a vectored read.
+    ///
+    /// @param fd           The file descriptor to read from.
+    /// @param buffers      The buffers to read into, which must outlive the operation.
+    /// @param count        The number of buffers.
+    /// @param offset       The file position to read from, or -1 for the current position.
+    /// @param completion   The record to complete when the read finishes.
+    void read(
+        const int fd,
+        const iovec* buffers,
+        const unsigned int count,
+        const std::int64_t offset,
+        Completion& completion
+    );
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Queues a vectored write.
+    ///
+    /// @param fd           The file descriptor to write to.
+    /// @param buffers      The buffers to write from, which must outlive the operation.
+    /// @param count        The number of buffers.
+    /// @param offset       The file position to write to, or -1 for the current position.
+    /// @param completion   The record to complete when the write finishes.
+    void write(
+        const int fd,
+        const iovec* buffers,
+        const unsigned int count,
+        const std::int64_t offset,
+        Completion& completion
+    );
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief The number of operations queued or running which have not completed.
+    std::size_t in_flight(void) const {
+        return m_in_flight;
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief The number of `io_uring_enter` calls made to submit operations.
+    ///
+    /// Comparing this to the number of operations shows how well submissions are being batched.
+    std::uint64_t submit_calls(void) const {
+        return m_submit_calls;
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+private:
+    struct _Ring; ///< The mapped kernel ring buffers.
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Fills the next submission queue entry.
+    void _queue(
+        const std::uint8_t opcode,
+        const int fd,
+        const iovec* buffers,
+        const unsigned int count,
+        const std::int64_t offset,
+        Completion& completion
+    );
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Hands all queued entries to the kernel.
+    ///
+    /// @return 0 once every entry is submitted or the ring is busy, otherwise the `errno` from
+    ///         `io_uring_enter`.
+    int _submit(void);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Submits queued entries from the prepare hook, failing them if the kernel refuses.
+    ///
+    /// Nothing is thrown from here since it runs inside a libuv callback.
+    void _flush(void);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Takes back every unsubmitted entry and calls each back with `-error`.
+    void _fail_queued(const int error);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Calls back every operation in the completion queue.
+    void _reap(void);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    std::unique_ptr<_Ring> m_ring;      ///< The kernel ring.
+    uv_poll_s* m_poll;                  ///< Watches the completion eventfd.
+    uv_prepare_s* m_prepare;            ///< Flushes queued entries before the loop polls.
+    std::size_t m_queued;               ///< Entries queued but not yet submitted.
+    std::size_t m_in_flight;            ///< Operations not yet completed.
+    std::uint64_t m_submit_calls;       ///< Number of submitting `io_uring_enter` calls.
+};
+
+}
+}
@@ -0,0 +1,341 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <uv.h>
+#include <vector>
+
+#include "lw/event.hpp"
+#include "lw/io/DirectoryWatches.hpp"
+
+namespace lw {
+namespace io {
+namespace _details {
+
+/// @brief Effectiveness counters kept by a `WatchedCache`.
+struct CacheCounters {
+    std::uint64_t hits;             ///< Lookups served from the cache.
+    std::uint64_t misses;           ///< Lookups which had to fetch the value.
+    std::uint64_t evictions;        ///< Entries dropped to stay within the size limit.
+    std::uint64_t invalidations;    ///< Entries dropped because their file changed.
+};
+
+// ---------------------------------------------------------------------------------------------- //
+
+/// @brief A least-recently-used cache of values for paths, dropped when their directory changes.
+///
+/// Entries are keyed by a path and a variant of it, such as the mode a file was opened in. Each
+/// entry holds a reference on its directory's watch for as long as it is cached. Misses on the
+/// same key share one fetch, which only starts once the directory is being watched so a change
+/// during the fetch is not missed. A value which raced with such a change is handed out but not
+/// kept.
+///
+/// @tparam Value The type of value cached, which must be copyable.
+template<typename Value>
+class WatchedCache {
+public:
+    /// @brief A path and its variant.
+    typedef std::pair<std::string, int> key_t;
+
+    /// @brief Fetches the value for a key on a miss.
+    typedef std::function<event::Future<Value>(const key_t& key)> fetch_t;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Constructs an empty cache whose entries live until dropped.
+    ///
+    /// @param loop         The event loop to fetch and watch on.
+    /// @param max_entries  The most entries to keep, dropping the least recently used beyond this.
+    WatchedCache(event::Loop& loop, const std::size_t max_entries):
+        m_state(std::make_shared<_State>(loop, max_entries, false, event::Timeout::resolution(0)))
+    {}
+
+    /// @brief Constructs an empty cache whose entries expire.
+    ///
+    /// @param loop         The event loop to fetch and watch on.
+    /// @param max_entries  The most entries to keep, dropping the least recently used beyond this.
+    /// @param ttl          How long an entry may be served for after it is fetched.
+    WatchedCache(
+        event::Loop& loop,
+        const std::size_t max_entries,
+        const event::Timeout::resolution& ttl
+    ):
+        m_state(std::make_shared<_State>(loop, max_entries, true, ttl))
+    {}
+
+    /// @brief No copying.
+    WatchedCache(const WatchedCache&) = delete;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Stops watching directories and drops all entries.
+    ///
+    /// Fetches still in flight settle their waiters without caching anything.
+    ~WatchedCache(void){
+        m_state->closed = true;
+        m_state->entries.clear();
+        m_state->lru.clear();
+        m_state->watches.close();
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Gets the value for a key, fetching it on a miss.
+    ///
+    /// @param key      The path and variant to look up.
+    /// @param fetch    The functor to get the value with if it is not cached.
+    ///
+    /// @return A promise for the value.
+    event::Future<Value> get(const key_t& key, const fetch_t& fetch){
+        Entry* entry = m_state->find(key);
+        if (entry) {
+            ++m_state->counters.hits;
+            return event::resolve(m_state->loop, Value(entry->value));
+        }
+        ++m_state->counters.misses;
+
+        auto& waiters = m_state->pending[key];
+        waiters.emplace_back();
+        auto future = waiters.back().future();
+        if (waiters.size() > 1) {
+            return future;
+        }
+
+        auto state = m_state;
+        const std::uint64_t started = m_state->generation;
+        m_state->watches.watch(watched_directory(key.first)).then([state, key, started, fetch](){
+            try {
+                fetch(key).then(
+                    [state, key, started](Value&& value){
+                        state->fetch_done(key, started, &value, nullptr);
+                    },
+                    [state, key, started](const error::Exception& err){
+                        state->fetch_done(key, started, nullptr, &err);
+                    }
+                );
+            }
+            catch (const error::Exception& err) {
+                state->fetch_done(key, started, nullptr, &err);
+            }
+        });
+        return future;
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Drops the entries for a path in every variant.
+    ///
+    /// @param path The path to forget.
+    void invalidate(const std::string& path){
+        m_state->invalidate(path);
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Drops every entry.
+    void clear(void){
+        ++m_state->generation;
+        while (!m_state->lru.empty()) {
+            m_state->erase(m_state->entries.find(m_state->lru.back()));
+        }
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief The number of entries currently cached.
+    std::size_t size(void) const {
+        return m_state->entries.size();
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Gets the cache's counters.
+    const CacheCounters& counters(void) const {
+        return m_state->counters;
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+private:
+    /// @brief A cached value and its bookkeeping.
+    struct Entry {
+        std::string directory;                      ///< The directory watched for changes.
+        Value value;                                ///< The cached value.
+        std::uint64_t expires;                      ///< When to stop serving it, if ever.
+        typename std::list<key_t>::iterator lru_position;   ///< Where it is in the LRU list.
+    };
+
+    typedef std::map<key_t, Entry> entry_map_t;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief The cache state, held by fetches in flight as well as the cache.
+    struct _State {
+        _State(
+            event::Loop& _loop,
+            const std::size_t _max_entries,
+            const bool _expiring,
+            const event::Timeout::resolution& _ttl
+        ):
+            loop(_loop),
+            max_entries(std::max<std::size_t>(_max_entries, 1)),
+            expiring(_expiring),
+            ttl(_ttl),
+            counters{0, 0, 0, 0},
+            watches(_loop, [this](const std::string& path, const bool directory){
+                changed(path, directory);
+            }),
+            generation(0),
+            closed(false)
+        {}
+
+        event::Loop& loop;
+        std::size_t max_entries;
+        bool expiring;
+        event::Timeout::resolution ttl;
+        CacheCounters counters;
+        DirectoryWatches watches;
+        entry_map_t entries;
+        std::list<key_t> lru;
+        std::map<key_t, std::vector<event::Promise<Value>>> pending;
+        std::uint64_t generation; ///< Bumped by every invalidation, to spot fetches racing one.
+        bool closed;
+
+        // -------------------------------------------------------------------------------------- //
+
+        std::uint64_t now(void){
+            return uv_now(loop.lowest_layer());
+        }
+
+        // -------------------------------------------------------------------------------------- //
+
+        /// @brief Looks up a live entry, dropping it if it has expired.
+        Entry* find(const key_t& key){
+            auto it = entries.find(key);
+            if (it == entries.end()) {
+                return nullptr;
+            }
+            if (expiring && it->second.expires <= now()) {
+                erase(it);
+                return nullptr;
+            }
+            lru.splice(lru.begin(), lru, it->second.lru_position);
+            return &it->second;
+        }
+
+        // -------------------------------------------------------------------------------------- //
+
+        /// @brief Gets the entry for a key, making it if needed, and restarts its time-to-live.
+        Entry& insert(const key_t& key){
+            auto it = entries.find(key);
+            if (it == entries.end()) {
+                it = entries.emplace(key, Entry()).first;
+                Entry& entry = it->second;
+                entry.directory = watched_directory(key.first);
+                lru.push_front(key);
+                entry.lru_position = lru.begin();
+                watches.watch(entry.directory);
+
+                while (entries.size() > max_entries) {
+                    erase(entries.find(lru.back()));
+                    ++counters.evictions;
+                }
+            }
+            else {
+                lru.splice(lru.begin(), lru, it->second.lru_position);
+            }
+
+            if (expiring) {
+                it->second.expires = now() + ttl.count();
+            }
+            return it->second;
+        }
+
+        // -------------------------------------------------------------------------------------- //
+
+        void erase(typename entry_map_t::iterator it){
+            const std::string directory = std::move(it->second.directory);
+            lru.erase(it->second.lru_position);
+            entries.erase(it);
+            watches.unwatch(directory);
+        }
+
+        // -------------------------------------------------------------------------------------- //
+
+        void invalidate(const std::string& path){
+            ++generation;
+            auto it = entries.lower_bound(key_t(path, std::numeric_limits<int>::min()));
+            while (it != entries.end() && it->first.first == path) {
+                erase(it++);
+                ++counters.invalidations;
+            }
+        }
+
+        // -------------------------------------------------------------------------------------- //
+
+        /// @brief Handles a change reported in a watched directory.
+        void changed(const std::string& path, const bool directory){
+            if (!directory) {
+                invalidate(path);
+                return;
+            }
+
+            // Without a name, anything in the directory may have changed.
+            ++generation;
+            for (auto it = entries.begin(); it != entries.end();) {
+                if (it->second.directory == path) {
+                    erase(it++);
+                    ++counters.invalidations;
+                }
+                else {
+                    ++it;
+                }
+            }
+        }
+
+        // -------------------------------------------------------------------------------------- //
+
+        /// @brief Caches a fetched value and settles everyone waiting on it.
+        void fetch_done(
+            const key_t& key,
+            const std::uint64_t started,
+            const Value* value,
+            const error::Exception* err
+        ){
+            auto waiters = std::move(pending[key]);
+            pending.erase(key);
+
+            if (value && !closed && started == generation) {
+                insert(key).value = *value;
+            }
+            if (!closed) {
+                watches.unwatch(watched_directory(key.first));
+            }
+
+            for (auto& waiter : waiters) {
+                if (value) {
+                    waiter.resolve(Value(*value));
+                }
+                else {
+                    waiter.reject(*err);
+                }
+            }
+        }
+    };
+
+    // ------------------------------------------------------------------------------------------ //
+
+    std::shared_ptr<_State> m_state; ///< The cache state.
+};
+
+}
+}
+}
@@ -0,0 +1,441 @@
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <uv.h>
+#include <vector>
+
+#include "lw/io/Watcher.hpp"
+#include "lw/io/fs.hpp"
+
+namespace lw {
+namespace io {
+
+namespace _details {
+    /// @brief One underlying `uv_fs_event_t` or `uv_fs_poll_t` watch.
+    struct WatcherHandle {
+        WatcherHandle(void):
+            handle(nullptr),
+            owner(nullptr),
+            directory(false)
+        {}
+
+        ~WatcherHandle(void){
+            if (handle) {
+                uv_close(handle, [](uv_handle_t* handle){ std::free(handle); });
+            }
+        }
+
+        uv_handle_t* handle;
+        void* owner;
+        std::string path;
+        bool directory;
+        std::set<std::string> roots;
+    };
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief The full path of a change reported by a watch.
+    std::string watched_path(const WatcherHandle& watch, const char* filename){
+        // Watched files report their own name, so only directories need it added.
+        if (!filename || !watch.directory) {
+            return watch.path;
+        }
+        if (!watch.path.empty() && watch.path.back() == '/') {
+            return watch.path + filename;
+        }
+        return watch.path + '/' + filename;
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+struct Watcher::_State : public std::enable_shared_from_this<Watcher::_State> {
+    struct Pending {
+        Pending(void):
+            events(0),
+            deadline(0)
+        {}
+
+        int events;
+        std::uint64_t deadline;
+    };
+
+    typedef std::map<std::string, std::unique_ptr<_details::WatcherHandle>> handle_map_t;
+
+    _State(event::Loop& _loop, const Options& _options, Watcher* _owner):
+        loop(_loop),
+        options(_options),
+        owner(_owner),
+        timer((uv_timer_t*)std::malloc(sizeof(uv_timer_t))),
+        closed(false)
+    {
+        #ifdef __linux__
+            manual_recursion = options.recursive;
+        #else
+            manual_recursion = options.recursive && options.use_polling;
+        #endif
+
+        uv_timer_init(loop.lowest_layer(), timer);
+        timer->data = (void*)this;
+        if (!options.keep_alive) {
+            uv_unref((uv_handle_t*)timer);
+        }
+    }
+
+    event::Loop& loop;
+    Options options;
+    Watcher* owner;
+    bool manual_recursion;
+    uv_timer_t* timer;
+    handle_map_t handles;
+    std::set<std::string> roots;
+    std::unordered_map<std::string, Pending> pending;
+    bool closed;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    void close(void){
+        if (closed) {
+            return;
+        }
+        closed = true;
+        handles.clear();
+        roots.clear();
+        pending.clear();
+        uv_close((uv_handle_t*)timer, [](uv_handle_t* handle){ std::free(handle); });
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Starts a single watch on a path, falling back to polling if events are unavailable.
+    ///
+    /// Roots may overlap, so a path already watched for one root is shared with the next.
+    ///
+    /// @throws WatcherError If the path cannot even be polled.
+    void add(const std::string& path, const bool directory, const std::string& root){
+        auto existing = handles.find(path);
+        if (existing != handles.end()) {
+            existing->second->roots.insert(root);
+            return;
+        }
+
+        std::unique_ptr<_details::WatcherHandle> watch(new _details::WatcherHandle());
+        watch->owner        = (void*)this;
+        watch->path         = path;
+        watch->directory    = directory;
+        watch->roots.insert(root);
+
+        int res = UV_EINVAL;
+        if (!options.use_polling) {
+            auto handle = (uv_fs_event_t*)std::malloc(sizeof(uv_fs_event_t));
+            uv_fs_event_init(loop.lowest_layer(), handle);
+            handle->data = (void*)watch.get();
+            watch->handle = (uv_handle_t*)handle;
+
+            res = uv_fs_event_start(
+                handle,
+                [](uv_fs_event_t* handle, const char* filename, int events, int status){
+                    auto* watch = (_details::WatcherHandle*)handle->data;
+                    auto* state = (_State*)watch->owner;
+                    if (status < 0) {
+                        state->failed(LW_UV_ERROR(WatcherError, status));
+                        return;
+                    }
+                    state->changed(
+                        _details::watched_path(*watch, filename),
+                        (events & UV_RENAME ? RENAME : 0) | (events & UV_CHANGE ? CHANGE : 0)
+                    );
+                },
+                path.c_str(),
+                options.recursive && !manual_recursion ? UV_FS_EVENT_RECURSIVE : 0
+            );
+            if (res < 0) {
+                uv_close(watch->handle, [](uv_handle_t* handle){ std::free(handle); });
+                watch->handle = nullptr;
+            }
+        }
+
+        if (res < 0) {
+            auto handle = (uv_fs_poll_t*)std::malloc(sizeof(uv_fs_poll_t));
+            uv_fs_poll_init(loop.lowest_layer(), handle);
+            handle->data = (void*)watch.get();
+            watch->handle = (uv_handle_t*)handle;
+
+            res = uv_fs_poll_start(
+                handle,
+                [](uv_fs_poll_t* handle, int status, const uv_stat_t* prev, const uv_stat_t* curr){
+                    auto* watch = (_details::WatcherHandle*)handle->data;
+                    auto* state = (_State*)watch->owner;
+                    if (status < 0 && status != UV_ENOENT) {
+                        state->failed(LW_UV_ERROR(WatcherError, status));
+                        return;
+                    }
+
+                    // A missing path reads as all zeros, so appearing or vanishing shows up as
+                    // a new inode.
+                    const bool renamed = status == UV_ENOENT || prev->st_ino != curr->st_ino;
+                    state->changed(watch->path, renamed ? RENAME : CHANGE);
+                },
+                path.c_str(),
+                (unsigned int)options.poll_interval.count()
+            );
+            if (res < 0) {
+                throw LW_UV_ERROR(WatcherError, res);
+            }
+        }
+
+        if (!options.keep_alive) {
+            uv_unref(watch->handle);
+        }
+        handles.emplace(path, std::move(watch));
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Drops a root's claim on the watches at and beneath a path, stopping those no other
+    /// root still needs.
+    void release(const std::string& root, const std::string& path){
+        auto release_handle = [&](handle_map_t::iterator it){
+            it->second->roots.erase(root);
+            return it->second->roots.empty() ? handles.erase(it) : std::next(it);
+        };
+
+        auto it = handles.find(path);
+        if (it != handles.end()) {
+            release_handle(it);
+        }
+
+        // '0' sorts right after '/', bounding every path within the directory.
+        const std::string end = path + '0';
+        for (it = handles.lower_bound(path + '/'); it != handles.end() && it->first < end;) {
+            it = release_handle(it);
+        }
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Watches a directory and every directory beneath it, one watch each.
+    event::Future<> add_tree(const std::string& root, const std::string& directory){
+        add(directory, true, root);
+
+        auto state = shared_from_this();
+        return walk(loop, directory, [state, root](const std::vector<DirectoryEntry>& entries){
+            for (const auto& entry : entries) {
+                if (state->closed || !state->roots.count(root)) {
+                    return;
+                }
+                if (entry.type != DirectoryEntry::DIRECTORY) {
+                    continue;
+                }
+                try {
+                    state->add(entry.name, true, root);
+                }
+                catch (const error::Exception& err) {
+                    state->failed(err);
+                }
+            }
+        }).then([](std::uint64_t){});
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Starts watching a root once it is known what kind of path it is.
+    void start(const std::string& path, const bool directory, event::Promise<>& promise){
+        if (closed || !roots.count(path)) {
+            promise.resolve();
+            return;
+        }
+
+        try {
+            if (directory && manual_recursion) {
+                add_tree(path, path).then(std::move(promise));
+                return;
+            }
+            add(path, directory, path);
+        }
+        catch (const error::Exception& err) {
+            roots.erase(path);
+            promise.reject(err);
+            return;
+        }
+        promise.resolve();
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Keeps per-directory watches in step with directories coming and going.
+    void rescan(const std::string& path){
+        std::string root;
+        for (const auto& candidate : roots) {
+            if (path.compare(0, candidate.size() + 1, candidate + '/') == 0) {
+                root = candidate;
+                break;
+            }
+        }
+        if (root.empty()) {
+            return;
+        }
+
+        auto state = shared_from_this();
+        io::stat(loop, path).then(
+            [state, root, path](Stat&& info){
+                if (
+                    state->closed || !state->roots.count(root) ||
+                    !info.is_directory() || state->handles.count(path)
+                ) {
+                    return;
+                }
+                try {
+                    state->add_tree(root, path).then(
+                        [](){},
+                        [state, root, path](const error::Exception&){
+                            // It went away again while being walked.
+                            if (!state->closed) {
+                                state->release(root, path);
+                            }
+                        }
+                    );
+                }
+                catch (const error::Exception& err) {
+                    state->failed(err);
+                }
+            },
+            [state, root, path](const error::Exception&){
+                // Paths beneath it which are watched as roots themselves keep their watches.
+                if (!state->closed) {
+                    state->release(root, path);
+                }
+            }
+        );
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Records a change, holding it back until the path goes quiet.
+    void changed(const std::string& path, const int events){
+        auto& entry = pending[path];
+        entry.events |= events;
+        entry.deadline = uv_now(loop.lowest_layer()) + options.debounce.count();
+
+        if (!uv_is_active((uv_handle_t*)timer)) {
+            uv_timer_start(
+                timer,
+                [](uv_timer_t* timer){ ((_State*)timer->data)->flush(); },
+                options.debounce.count(),
+                0
+            );
+        }
+
+        if (manual_recursion && (events & RENAME)) {
+            rescan(path);
+        }
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Emits every path which has been quiet for the debounce window.
+    void flush(void){
+        const std::uint64_t now = uv_now(loop.lowest_layer());
+        std::uint64_t next = std::numeric_limits<std::uint64_t>::max();
+        std::vector<std::pair<std::string, int>> ready;
+        for (auto it = pending.begin(); it != pending.end();) {
+            if (it->second.deadline <= now) {
+                ready.emplace_back(it->first, it->second.events);
+                it = pending.erase(it);
+            }
+            else {
+                next = std::min(next, it->second.deadline);
+                ++it;
+            }
+        }
+        if (!pending.empty()) {
+            uv_timer_start(
+                timer,
+                [](uv_timer_t* timer){ ((_State*)timer->data)->flush(); },
+                next - now,
+                0
+            );
+        }
+
+        // Listeners may close the watcher, so check before each one.
+        for (const auto& change : ready) {
+            if (closed) {
+                break;
+            }
+            owner->emit(owner->change_event, change.first, change.second);
+        }
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    void failed(const error::Exception& err){
+        if (!closed) {
+            owner->emit(owner->error_event, err);
+        }
+    }
+};
+
+// ---------------------------------------------------------------------------------------------- //
+
+Watcher::Watcher(event::Loop& loop, const Options& options):
+    m_state(std::make_shared<_State>(loop, options, this))
+{}
+
+// ---------------------------------------------------------------------------------------------- //
+
+Watcher::~Watcher(void){
+    // Requests still in flight hold the state, but the watcher they would report to is gone.
+    m_state->close();
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+event::Future<> Watcher::watch(const std::string& path){
+    if (m_state->closed) {
+        throw WatcherError(1, "Cannot watch with a closed watcher.");
+    }
+    m_state->roots.insert(path);
+
+    // Events are not available for missing paths, which leaves them to polling.
+    auto promise = std::make_shared<event::Promise<>>();
+    auto future = promise->future();
+    auto state = m_state;
+    io::stat(m_state->loop, path).then(
+        [state, path, promise](Stat&& info){
+            state->start(path, info.is_directory(), *promise);
+        },
+        [state, path, promise](const error::Exception&){
+            state->start(path, false, *promise);
+        }
+    );
+    return future;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void Watcher::unwatch(const std::string& path){
+    if (m_state->roots.erase(path)) {
+        m_state->release(path, path);
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void Watcher::close(void){
+    m_state->close();
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+std::size_t Watcher::size(void) const {
+    return m_state->handles.size();
+}
+
+}
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "lw/error.hpp"
+#include "lw/event.hpp"
+
+namespace lw {
+namespace io {
+
+LW_DEFINE_EXCEPTION(WatcherError);
+
+namespace _details {
+    LW_DECLARE_EVENTS(change, error)
+    LW_DEFINE_EMITTER(
+        WatcherEmitter,
+        (change, const std::string&, const int&),
+        (error, const error::Exception&)
+    );
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+/// @brief Watches files and directories for changes, emitting one event per burst.
+///
+/// Changes are reported through the `change_event` with the changed path and a mask of
+/// `Watcher::Flags`. Every event for a path is held back until that path has been quiet for the
+/// debounce window, then they are merged into a single emission. Failures of the underlying
+/// watches are reported through the `error_event`.
+///
+/// Paths are watched with `uv_fs_event_t`, or with `uv_fs_poll_t` when polling is asked for or
+/// events are not available for the path. Linux has no native recursive watching, so there a
+/// recursive watch keeps one inotify watch per directory, adding and dropping them as
+/// directories come and go.
+class Watcher : public _details::WatcherEmitter {
+public:
+    /// @brief The kinds of change which can be reported.
+    enum Flags {
+        RENAME = 1, ///< The path was created, deleted or renamed.
+        CHANGE = 2  ///< The path's contents or metadata changed.
+    };
+
+    /// @brief Settings for watching and debouncing.
+    struct Options {
+        Options(void):
+            debounce(50),
+            recursive(false),
+            use_polling(false),
+            poll_interval(1000),
+            keep_alive(true)
+        {}
+
+        /// @brief How long a path must be quiet before its events are emitted.
+        event::Timeout::resolution debounce;
+
+        /// @brief Also watch everything beneath watched directories.
+        bool recursive;
+
+        /// @brief Poll with `stat` instead of using filesystem events.
+        bool use_polling;
+
+        /// @brief How often to `stat` polled paths.
+        event::Timeout::resolution poll_interval;
+
+        /// @brief Keep the loop running for as long as anything is watched.
+        bool keep_alive;
+    };
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Constructs a watcher with nothing to watch yet.
+    ///
+    /// @param loop     The event loop to watch on.
+    /// @param options  How to watch and debounce.
+    Watcher(event::Loop& loop, const Options& options = Options());
+
+    /// @brief No copying.
+    Watcher(const Watcher&) = delete;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Stops all watches, dropping any events still being debounced.
+    ~Watcher(void);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Starts watching a file or directory.
+    ///
+    /// Paths which do not exist yet are polled until they appear.
+    ///
+    /// @param path The path to watch.
+    ///
+    /// @return
+    ///     A promise resolved once the path, and with recursive watching every directory beneath
+    ///     it, is being watched. It is rejected with a `WatcherError` if the path cannot be
+    ///     watched at all.
+    ///
+    /// @throws WatcherError If the watcher has been closed.
+    event::Future<> watch(const std::string& path);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Stops watching a path, and anything beneath it.
+    ///
+    /// Paths beneath it which are watched in their own right, or which another recursive watch
+    /// covers, stay watched.
+    ///
+    /// @param path The path given to `watch`.
+    void unwatch(const std::string& path);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Stops all watches and the debounce timer so the loop can finish.
+    ///
+    /// Events still being debounced are dropped.
+    void close(void);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief The number of underlying filesystem watches.
+    std::size_t size(void) const;
+
+    // ------------------------------------------------------------------------------------------ //
+
+private:
+    struct _State; ///< Type used for managing internal state.
+
+    // ------------------------------------------------------------------------------------------ //
+
+    std::shared_ptr<_State> m_state; ///< The watcher state.
+};
+
+}
+}
@@ -0,0 +1,18 @@
+#include <cstring>
+#include <sys/socket.h>
+#include <uv.h>
+
+#include "lw/io/address.hpp"
+
+namespace lw {
+namespace io {
+
+bool parse_address(const std::string& host, const std::uint16_t port, sockaddr_storage& addr){
+    std::memset(&addr, 0, sizeof(addr));
+    return
+        uv_ip4_addr(host.c_str(), port, (sockaddr_in*)&addr) == 0 ||
+        uv_ip6_addr(host.c_str(), port, (sockaddr_in6*)&addr) == 0;
+}
+
+}
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+struct sockaddr_storage;
+
+namespace lw {
+namespace io {
+
+/// @brief Parses a numeric IPv4 or IPv6 address.
+///
+/// @param host The address to parse.
+/// @param port The port to pair with the address.
+/// @param addr The structure to fill with the parsed address.
+///
+/// @return True if `host` was a valid address.
+bool parse_address(const std::string& host, const std::uint16_t port, sockaddr_storage& addr);
+
+}
+}
@@ -0,0 +1,332 @@
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <sys/stat.h>
+#include <utility>
+#include <uv.h>
+
+#include "lw/io/fs.hpp"
+
+namespace lw {
+namespace io {
+
+namespace _details {
+    Stat::time_point to_time_point(const uv_timespec_t& time){
+        return Stat::time_point(std::chrono::duration_cast<Stat::time_point::duration>(
+            std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec)
+        ));
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    DirectoryEntry::Type to_entry_type(const uv_dirent_type_t type){
+        switch (type) {
+            case UV_DIRENT_UNKNOWN: return DirectoryEntry::UNKNOWN;
+            case UV_DIRENT_FILE:    return DirectoryEntry::FILE;
+            case UV_DIRENT_DIR:     return DirectoryEntry::DIRECTORY;
+            case UV_DIRENT_LINK:    return DirectoryEntry::LINK;
+            default:                return DirectoryEntry::OTHER;
+        }
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    DirectoryEntry::Type to_entry_type(const Stat& info){
+        if (info.is_directory()) {
+            return DirectoryEntry::DIRECTORY;
+        }
+        if (info.is_file()) {
+            return DirectoryEntry::FILE;
+        }
+        if (info.is_symlink()) {
+            return DirectoryEntry::LINK;
+        }
+        return DirectoryEntry::OTHER;
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    std::string join_path(const std::string& directory, const std::string& name){
+        if (!directory.empty() && directory.back() == '/') {
+            return directory + name;
+        }
+        return directory + '/' + name;
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    struct StatRequest {
+        uv_fs_t request;
+        event::Promise<Stat> promise;
+    };
+
+    /// @brief Runs `stat` or `lstat` on the threadpool.
+    event::Future<Stat> stat_path(event::Loop& loop, const std::string& path, const bool follow){
+        auto stat_req = new StatRequest();
+        stat_req->request.data = (void*)stat_req;
+        auto future = stat_req->promise.future();
+
+        auto callback = [](uv_fs_t* req){
+            std::unique_ptr<StatRequest> stat_req((StatRequest*)req->data);
+            const int result = (int)req->result;
+            Stat info;
+            if (result >= 0) {
+                const uv_stat_t& stat_buf = req->statbuf;
+                info.device     = stat_buf.st_dev;
+                info.inode      = stat_buf.st_ino;
+                info.mode       = stat_buf.st_mode;
+                info.links      = stat_buf.st_nlink;
+                info.size       = stat_buf.st_size;
+                info.accessed   = to_time_point(stat_buf.st_atim);
+                info.modified   = to_time_point(stat_buf.st_mtim);
+                info.changed    = to_time_point(stat_buf.st_ctim);
+            }
+            uv_fs_req_cleanup(req);
+
+            if (result < 0) {
+                stat_req->promise.reject(LW_UV_ERROR(FilesystemError, result));
+            }
+            else {
+                stat_req->promise.resolve(std::move(info));
+            }
+        };
+
+        int res = follow
+            ? uv_fs_stat(loop.lowest_layer(), &stat_req->request, path.c_str(), callback)
+            : uv_fs_lstat(loop.lowest_layer(), &stat_req->request, path.c_str(), callback);
+        if (res < 0) {
+            delete stat_req;
+            throw LW_UV_ERROR(FilesystemError, res);
+        }
+        return future;
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    struct ScandirRequest {
+        uv_fs_t request;
+        event::Promise<std::vector<DirectoryEntry>> promise;
+    };
+
+    // ------------------------------------------------------------------------------------------ //
+
+    struct Walk : public std::enable_shared_from_this<Walk> {
+        event::Loop* loop;
+        walk_visitor_t visitor;
+        WalkOptions options;
+        std::deque<std::string> directories;
+        std::deque<DirectoryEntry> untyped;
+        std::vector<DirectoryEntry> batch;
+        std::size_t in_flight;
+        std::uint64_t total;
+        bool failed;
+        event::Promise<std::uint64_t> promise;
+
+        /// @brief Starts requests until the limit is hit or nothing is left to do.
+        void pump(void){
+            auto walk = shared_from_this();
+
+            // Typing entries first keeps the amount of buffered entries down.
+            while (
+                !failed && in_flight < options.max_in_flight &&
+                (!untyped.empty() || !directories.empty())
+            ){
+                ++in_flight;
+                try {
+                    if (!untyped.empty()) {
+                        auto entry = std::make_shared<DirectoryEntry>(std::move(untyped.front()));
+                        untyped.pop_front();
+                        stat_path(*loop, entry->name, options.follow_links).then(
+                            [walk, entry](Stat&& info){
+                                --walk->in_flight;
+                                entry->type = to_entry_type(info);
+                                walk->add(std::move(*entry));
+                                walk->pump();
+                            },
+                            [walk, entry](const error::Exception&){
+                                // A dangling link or an entry removed mid-walk is no reason to
+                                // give up on the rest, so deliver it with the type it had.
+                                --walk->in_flight;
+                                walk->add(std::move(*entry));
+                                walk->pump();
+                            }
+                        );
+                    }
+                    else {
+                        std::string directory = std::move(directories.front());
+                        directories.pop_front();
+                        scandir(*loop, directory).then(
+                            [walk, directory](std::vector<DirectoryEntry>&& entries){
+                                --walk->in_flight;
+                                walk->scanned(directory, entries);
+                                walk->pump();
+                            },
+                            [walk](const error::Exception& err){
+                                --walk->in_flight;
+                                walk->fail(err);
+                            }
+                        );
+                    }
+                }
+                catch (const error::Exception& err) {
+                    --in_flight;
+                    fail(err);
+                    return;
+                }
+            }
+
+            if (!failed && in_flight == 0 && untyped.empty() && directories.empty()) {
+                flush();
+                promise.resolve(total);
+            }
+        }
+
+        /// @brief Sorts a directory's entries into ones ready to deliver and ones to `stat`.
+        void scanned(const std::string& directory, std::vector<DirectoryEntry>& entries){
+            for (auto& entry : entries) {
+                entry.name = join_path(directory, entry.name);
+                if (
+                    entry.type == DirectoryEntry::UNKNOWN ||
+                    (entry.type == DirectoryEntry::LINK && options.follow_links)
+                ){
+                    untyped.push_back(std::move(entry));
+                }
+                else {
+                    add(std::move(entry));
+                }
+            }
+        }
+
+        /// @brief Queues directories for scanning and batches the entry for the visitor.
+        void add(DirectoryEntry&& entry){
+            if (entry.type == DirectoryEntry::DIRECTORY) {
+                directories.push_back(entry.name);
+            }
+            batch.push_back(std::move(entry));
+            ++total;
+            if (batch.size() >= options.batch_size) {
+                flush();
+            }
+        }
+
+        /// @brief Hands the current batch to the visitor.
+        void flush(void){
+            if (batch.empty()) {
+                return;
+            }
+            std::vector<DirectoryEntry> entries;
+            entries.reserve(options.batch_size);
+            std::swap(entries, batch);
+            visitor(entries);
+        }
+
+        /// @brief Rejects the walk and stops starting new requests.
+        void fail(const error::Exception& err){
+            if (!failed) {
+                failed = true;
+                promise.reject(err);
+            }
+        }
+    };
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+bool Stat::is_file(void) const {
+    return (mode & S_IFMT) == S_IFREG;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+bool Stat::is_directory(void) const {
+    return (mode & S_IFMT) == S_IFDIR;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+bool Stat::is_symlink(void) const {
+    return (mode & S_IFMT) == S_IFLNK;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+event::Future<Stat> stat(event::Loop& loop, const std::string& path){
+    return _details::stat_path(loop, path, true);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+event::Future<Stat> lstat(event::Loop& loop, const std::string& path){
+    return _details::stat_path(loop, path, false);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+event::Future<std::vector<DirectoryEntry>> scandir(event::Loop& loop, const std::string& path){
+    auto scan_req = new _details::ScandirRequest();
+    scan_req->request.data = (void*)scan_req;
+    auto future = scan_req->promise.future();
+
+    int res = uv_fs_scandir(
+        loop.lowest_layer(),
+        &scan_req->request,
+        path.c_str(),
+        0,
+        [](uv_fs_t* req){
+            std::unique_ptr<_details::ScandirRequest> scan_req(
+                (_details::ScandirRequest*)req->data
+            );
+            const int result = (int)req->result;
+            std::vector<DirectoryEntry> entries;
+            if (result > 0) {
+                entries.reserve(result);
+                uv_dirent_t dirent;
+                while (uv_fs_scandir_next(req, &dirent) != UV_EOF) {
+                    entries.push_back({dirent.name, _details::to_entry_type(dirent.type)});
+                }
+            }
+            uv_fs_req_cleanup(req);
+
+            if (result < 0) {
+                scan_req->promise.reject(LW_UV_ERROR(FilesystemError, result));
+            }
+            else {
+                scan_req->promise.resolve(std::move(entries));
+            }
+        }
+    );
+
+    if (res < 0) {
+        delete scan_req;
+        throw LW_UV_ERROR(FilesystemError, res);
+    }
+    return future;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+event::Future<std::uint64_t> walk(
+    event::Loop& loop,
+    const std::string& root,
+    const walk_visitor_t& visitor,
+    const WalkOptions& options
+){
+    auto walk = std::make_shared<_details::Walk>();
+    walk->loop                  = &loop;
+    walk->visitor               = visitor;
+    walk->options               = options;
+    walk->options.max_in_flight = std::max<std::size_t>(options.max_in_flight, 1);
+    walk->options.batch_size    = std::max<std::size_t>(options.batch_size, 1);
+    walk->in_flight             = 0;
+    walk->total                 = 0;
+    walk->failed                = false;
+    walk->directories.push_back(root);
+
+    auto future = walk->promise.future();
+    walk->pump();
+    return future;
+}
+
+}
+}
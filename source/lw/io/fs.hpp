@@ -0,0 +1,143 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "lw/error.hpp"
+#include "lw/event.hpp"
+
+namespace lw {
+namespace io {
+
+LW_DEFINE_EXCEPTION(FilesystemError);
+
+// ---------------------------------------------------------------------------------------------- //
+
+/// @brief Metadata about a file, as given by `stat`.
+struct Stat {
+    typedef std::chrono::system_clock::time_point time_point; ///< Type used for timestamps.
+
+    std::uint64_t device;       ///< The device holding the file.
+    std::uint64_t inode;        ///< The file's inode number.
+    std::uint64_t mode;         ///< The file's type and permission bits.
+    std::uint64_t links;        ///< The number of hard links to the file.
+    std::uint64_t size;         ///< The file's size in bytes.
+    time_point accessed;        ///< When the file was last read.
+    time_point modified;        ///< When the file's contents last changed.
+    time_point changed;         ///< When the file's metadata last changed.
+
+    /// @brief Checks if this is a regular file.
+    bool is_file(void) const;
+
+    /// @brief Checks if this is a directory.
+    bool is_directory(void) const;
+
+    /// @brief Checks if this is a symbolic link, which only `lstat` reports.
+    bool is_symlink(void) const;
+};
+
+// ---------------------------------------------------------------------------------------------- //
+
+/// @brief A single entry in a directory.
+struct DirectoryEntry {
+    /// @brief The kinds of directory entries.
+    enum Type {
+        UNKNOWN,    ///< The filesystem did not say, so a `stat` is needed to find out.
+        FILE,       ///< A regular file.
+        DIRECTORY,  ///< A directory.
+        LINK,       ///< A symbolic link.
+        OTHER       ///< Anything else, such as a socket or device.
+    };
+
+    std::string name;   ///< The entry's name, or its path when given by `walk`.
+    Type type;          ///< What kind of entry this is.
+};
+
+// ---------------------------------------------------------------------------------------------- //
+
+/// @brief Asynchronously gets the metadata for a path, following symbolic links.
+///
+/// @param loop The event loop to run the request on.
+/// @param path The path to look up.
+///
+/// @return A promise for the path's metadata.
+event::Future<Stat> stat(event::Loop& loop, const std::string& path);
+
+// ---------------------------------------------------------------------------------------------- //
+
+/// @brief Asynchronously gets the metadata for a path without following symbolic links.
+///
+/// @param loop The event loop to run the request on.
+/// @param path The path to look up.
+///
+/// @return A promise for the path's metadata, or the link's own if it is a symbolic link.
+event::Future<Stat> lstat(event::Loop& loop, const std::string& path);
+
+// ---------------------------------------------------------------------------------------------- //
+
+/// @brief Asynchronously lists the entries of a directory.
+///
+/// The `.` and `..` entries are left out.
+///
+/// @param loop The event loop to run the request on.
+/// @param path The directory to list.
+///
+/// @return A promise for the directory's entries.
+event::Future<std::vector<DirectoryEntry>> scandir(event::Loop& loop, const std::string& path);
+
+// ---------------------------------------------------------------------------------------------- //
+
+/// @brief Settings for `walk`.
+struct WalkOptions {
+    WalkOptions(void):
+        max_in_flight(16),
+        batch_size(256),
+        follow_links(false)
+    {}
+
+    /// @brief The most `scandir` and `stat` requests to have running at once.
+    std::size_t max_in_flight;
+
+    /// @brief The most entries to hand to the visitor at a time.
+    std::size_t batch_size;
+
+    /// @brief Descend into symbolic links to directories. Link cycles are not detected.
+    bool follow_links;
+};
+
+/// @brief Walk visitor functor type.
+///
+/// @param entries The next batch of entries, named by their paths beginning with the root.
+typedef std::function<void(const std::vector<DirectoryEntry>& entries)> walk_visitor_t;
+
+// ---------------------------------------------------------------------------------------------- //
+
+/// @brief Recursively visits everything beneath a directory.
+///
+/// Directories are scanned concurrently, keeping up to `options.max_in_flight` requests on the
+/// threadpool, so entries arrive in no particular order. Entries the filesystem does not type are
+/// `lstat`ed (or `stat`ed when following links) before being delivered. If that fails, as it does
+/// for a dangling link, the entry is still delivered as `UNKNOWN` or `LINK` and the walk carries
+/// on. Entries are collected into batches of up to `options.batch_size` instead of being
+/// delivered one at a time.
+///
+/// @param loop     The event loop to walk with.
+/// @param root     The directory to start from, which is not itself visited.
+/// @param visitor  The functor to call with each batch of entries.
+/// @param options  Concurrency and batching settings.
+///
+/// @return
+///     A promise for the number of entries visited. It is rejected if any directory cannot be read.
+event::Future<std::uint64_t> walk(
+    event::Loop& loop,
+    const std::string& root,
+    const walk_visitor_t& visitor,
+    const WalkOptions& options = WalkOptions()
+);
+
+}
+}
@@ -1,3 +1,9 @@
 #pragma once
 
+#include "lw/memory/Allocator.hpp"
+#include "lw/memory/Arena.hpp"
 #include "lw/memory/Buffer.hpp"
+#include "lw/memory/BufferBuilder.hpp"
+#include "lw/memory/BufferChain.hpp"
+#include "lw/memory/BufferPool.hpp"
+#include "lw/memory/Crc32c.hpp"
@@ -0,0 +1,38 @@
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+#include "lw/memory/Allocator.hpp"
+
+namespace lw {
+namespace memory {
+
+AlignedAllocator::AlignedAllocator(const std::size_t alignment):
+    m_alignment(alignment)
+{
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+        throw MemoryError(1, "Alignment must be a power of two.");
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void* AlignedAllocator::allocate(const std::size_t size){
+    // posix_memalign needs at least pointer alignment.
+    const std::size_t alignment = std::max(m_alignment, sizeof(void*));
+    void* data = nullptr;
+    if (::posix_memalign(&data, alignment, std::max<std::size_t>(round_size(size), 1)) != 0) {
+        throw std::bad_alloc();
+    }
+    return data;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void AlignedAllocator::deallocate(void* data){
+    std::free(data);
+}
+
+}
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+
+#include "lw/error.hpp"
+
+namespace lw {
+namespace memory {
+
+LW_DEFINE_EXCEPTION(MemoryError);
+
+// ---------------------------------------------------------------------------------------------- //
+
+/// @brief Interface for the blocks of memory handed out to buffers.
+///
+/// A buffer made with an allocator keeps a pointer to it and gives its block back through
+/// `deallocate`, so the allocator must outlive every buffer made with it.
+class Allocator {
+public:
+    virtual ~Allocator(void){}
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Allocates a block of at least the given size.
+    ///
+    /// @param size The number of bytes needed, as already passed through `round_size`.
+    ///
+    /// @return A pointer to the new block.
+    ///
+    /// @throws std::bad_alloc If the memory could not be allocated.
+    virtual void* allocate(const std::size_t size) = 0;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Gives back a block from `allocate`.
+    ///
+    /// @param data The block to release.
+    virtual void deallocate(void* data) = 0;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Rounds a requested size up to what this allocator hands out.
+    ///
+    /// Buffers report the rounded size, so the extra bytes may be used.
+    ///
+    /// @param size The number of bytes requested.
+    ///
+    /// @return The number of bytes a block of that size will really have.
+    virtual std::size_t round_size(const std::size_t size) const {
+        return size;
+    }
+};
+
+// ---------------------------------------------------------------------------------------------- //
+
+/// @brief Allocates blocks which start on an alignment boundary and span whole multiples of it.
+///
+/// This is what `O_DIRECT` file access needs, where both the address and the length of every
+/// transfer must be multiples of the device's block size.
+class AlignedAllocator : public Allocator {
+public:
+    /// @brief Constructs an allocator for the given alignment.
+    ///
+    /// @param alignment The boundary to align to, which must be a power of two.
+    ///
+    /// @throws MemoryError If `alignment` is not a power of two.
+    explicit AlignedAllocator(const std::size_t alignment = 4096);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief The boundary blocks are aligned to.
+    std::size_t alignment(void) const {
+        return m_alignment;
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @copydoc Allocator::allocate
+    void* allocate(const std::size_t size) override;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @copydoc Allocator::deallocate
+    void deallocate(void* data) override;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Rounds the size up to a multiple of the alignment.
+    ///
+    /// @param size The number of bytes requested.
+    ///
+    /// @return The smallest multiple of the alignment which is at least `size`.
+    std::size_t round_size(const std::size_t size) const override {
+        return (size + m_alignment - 1) & ~(m_alignment - 1);
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+private:
+    std::size_t m_alignment; ///< The boundary blocks are aligned to.
+};
+
+}
+}
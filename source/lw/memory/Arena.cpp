@@ -0,0 +1,160 @@
+
+#include <algorithm>
+#include <cstdint>
+
+#include "lw/memory/Arena.hpp"
+
+namespace lw {
+namespace memory {
+
+Arena::Arena(const std::size_t chunk_size):
+    m_chunk_size(std::max<std::size_t>(chunk_size, 64)),
+    m_current(0),
+    m_offset(0)
+{}
+
+// ---------------------------------------------------------------------------------------------- //
+
+Arena::~Arena(void){
+    _destroy_after(0);
+    for (auto& chunk : m_chunks) {
+        delete[] chunk.data;
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void* Arena::allocate(const std::size_t size, const std::size_t alignment){
+    if (!m_chunks.empty()) {
+        const Chunk& chunk = m_chunks[m_current];
+        const std::uintptr_t address = (std::uintptr_t)chunk.data + m_offset;
+        const std::size_t padding = (alignment - address % alignment) % alignment;
+        if (padding + size <= chunk.size - m_offset) {
+            m_offset += padding + size;
+            return (void*)(address + padding);
+        }
+    }
+
+    _next_chunk(size, alignment);
+    return allocate(size, alignment);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+Arena::Mark Arena::mark(void) const {
+    return Mark{m_current, m_offset, m_destructors.size(), m_scopes.size()};
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void Arena::rewind(const Mark& mark){
+    if (m_scopes.size() > mark.scopes) {
+        throw MemoryError(3, "Cannot rewind an arena past a scope which is still open.");
+    }
+    _rewind(mark);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void Arena::reset(void){
+    if (!m_scopes.empty()) {
+        throw MemoryError(4, "Cannot reset an arena while a scope is still open.");
+    }
+    _destroy_after(0);
+
+    // One-off chunks for large allocations are not worth keeping around.
+    auto oversized = std::remove_if(m_chunks.begin(), m_chunks.end(), [&](const Chunk& chunk){
+        if (chunk.size != m_chunk_size) {
+            delete[] chunk.data;
+            return true;
+        }
+        return false;
+    });
+    m_chunks.erase(oversized, m_chunks.end());
+    m_current = 0;
+    m_offset = 0;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+std::size_t Arena::used(void) const {
+    std::size_t total = m_offset;
+    for (std::size_t i = 0; i < m_current && i < m_chunks.size(); ++i) {
+        total += m_chunks[i].size;
+    }
+    return total;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+std::size_t Arena::reserved(void) const {
+    std::size_t total = 0;
+    for (const auto& chunk : m_chunks) {
+        total += chunk.size;
+    }
+    return total;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+std::size_t Arena::_open_scope(void){
+    m_scopes.push_back(Scope{mark(), false});
+    return m_scopes.size() - 1;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void Arena::_close_scope(const std::size_t depth){
+    m_scopes[depth].ended = true;
+    if (depth + 1 < m_scopes.size()) {
+        return;
+    }
+
+    // Scopes which ended out of order are rewound along with the last one above them.
+    Mark start = m_scopes.back().mark;
+    while (!m_scopes.empty() && m_scopes.back().ended) {
+        start = m_scopes.back().mark;
+        m_scopes.pop_back();
+    }
+    _rewind(start);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void Arena::_rewind(const Mark& mark){
+    _destroy_after(mark.destructors);
+    m_current = mark.chunk;
+    m_offset = mark.offset;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void Arena::_next_chunk(const std::size_t size, const std::size_t alignment){
+    const std::size_t needed = size + alignment;
+    const std::size_t next = m_chunks.empty() ? 0 : m_current + 1;
+
+    // Chunks kept from before a rewind are reused when they are big enough.
+    if (next < m_chunks.size() && m_chunks[next].size >= needed) {
+        m_current = next;
+        m_offset = 0;
+        return;
+    }
+
+    const std::size_t chunk_size = std::max(m_chunk_size, needed);
+    m_chunks.insert(m_chunks.begin() + next, Chunk{new byte[chunk_size], chunk_size});
+    m_current = next;
+    m_offset = 0;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void Arena::_destroy_after(const std::size_t count){
+    while (m_destructors.size() > count) {
+        const Destructor destructor = m_destructors.back();
+        m_destructors.pop_back();
+        destructor.destroy(destructor.object);
+    }
+}
+
+}
+}
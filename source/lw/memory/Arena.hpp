@@ -0,0 +1,284 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "lw/memory/Allocator.hpp"
+#include "lw/memory/Buffer.hpp"
+
+namespace lw {
+namespace memory {
+
+/// @brief Hands out memory by bumping a pointer through large chunks, freeing it all at once.
+///
+/// Allocating is a pointer increment, and nothing is given back piece by piece. Instead the arena
+/// is rewound to an earlier `mark`, usually by an `ArenaScope`, dropping everything allocated since
+/// in one go. Chunks are kept for the next rewind, so a steady workload stops calling `malloc`
+/// altogether.
+///
+/// Rewinding works like a stack, so scopes must nest: memory is only freed once every scope opened
+/// after it has ended too. Requests which overlap on a loop should each get their own arena.
+///
+/// As an `Allocator` the arena can back `Buffer`s directly, objects can be built in it with `make`,
+/// and `ArenaAllocator` adapts it for standard containers and `std::allocate_shared`. Nothing made
+/// from an arena may outlive the scope it was made in. Arenas are not thread-safe.
+class Arena : public Allocator {
+public:
+    /// @brief A point in the arena's history to rewind to.
+    struct Mark {
+        std::size_t chunk;          ///< The chunk being allocated from.
+        std::size_t offset;         ///< The bytes used in that chunk.
+        std::size_t destructors;    ///< The number of objects needing destruction.
+        std::size_t scopes;         ///< The number of scopes open.
+    };
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Creates an arena with no memory yet.
+    ///
+    /// @param chunk_size The size of each chunk of memory taken from the system.
+    explicit Arena(const std::size_t chunk_size = 64 * 1024);
+
+    /// @brief No copying.
+    Arena(const Arena&) = delete;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Destroys any objects made in the arena and frees every chunk.
+    ~Arena(void);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Allocates a block suitably aligned for any type.
+    ///
+    /// @param size The number of bytes needed.
+    ///
+    /// @return A pointer to the new block.
+    void* allocate(const std::size_t size) override {
+        return allocate(size, alignof(std::max_align_t));
+    }
+
+    /// @brief Allocates a block with the given alignment.
+    ///
+    /// @param size         The number of bytes needed.
+    /// @param alignment    The alignment needed, which must be a power of two.
+    ///
+    /// @return A pointer to the new block.
+    void* allocate(const std::size_t size, const std::size_t alignment);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Does nothing, the memory comes back when the arena is rewound.
+    void deallocate(void*) override {}
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Constructs an object in the arena.
+    ///
+    /// Objects which need destroying are destroyed, newest first, when the arena is rewound past
+    /// them.
+    ///
+    /// @tparam T       The type of object to make.
+    /// @tparam Args    The types of the constructor arguments.
+    ///
+    /// @param args The arguments to construct the object with.
+    ///
+    /// @return A pointer to the new object.
+    template<typename T, typename... Args>
+    T* make(Args&&... args){
+        T* object = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        if (!std::is_trivially_destructible<T>::value) {
+            m_destructors.push_back(Destructor{&Arena::_destroy<T>, (void*)object});
+        }
+        return object;
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Notes the current point in the arena.
+    Mark mark(void) const;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Frees everything allocated since a mark was taken.
+    ///
+    /// Objects made since the mark are destroyed first. The memory is kept for reuse.
+    ///
+    /// @param mark A mark taken from this arena which has not been rewound past already.
+    ///
+    /// @throws MemoryError If a scope opened after the mark is still open.
+    void rewind(const Mark& mark);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Frees everything in the arena, keeping regular chunks for reuse.
+    ///
+    /// @throws MemoryError If any scope is still open.
+    void reset(void);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief The number of bytes in chunks up to the current allocation point.
+    std::size_t used(void) const;
+
+    /// @brief The number of bytes held in chunks, used or not.
+    std::size_t reserved(void) const;
+
+    // ------------------------------------------------------------------------------------------ //
+
+private:
+    /// @brief A block of memory taken from the system.
+    struct Chunk {
+        byte* data;
+        std::size_t size;
+    };
+
+    /// @brief An object waiting to be destroyed.
+    struct Destructor {
+        void (*destroy)(void*);
+        void* object;
+    };
+
+    /// @brief An open `ArenaScope`.
+    struct Scope {
+        Mark mark;  ///< Where the scope began.
+        bool ended; ///< Set once the scope is gone, while newer scopes are still open.
+    };
+
+    friend class ArenaScope;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Marks the start of a scope.
+    ///
+    /// @return The scope's depth, to hand back to `_close_scope`.
+    std::size_t _open_scope(void);
+
+    /// @brief Ends a scope, rewinding past it once no newer scope is open.
+    void _close_scope(const std::size_t depth);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Rewinds to a mark without checking for open scopes.
+    void _rewind(const Mark& mark);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Moves on to a chunk with room for an allocation.
+    void _next_chunk(const std::size_t size, const std::size_t alignment);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Runs the destructors of objects made after the given count.
+    void _destroy_after(const std::size_t count);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    template<typename T>
+    static void _destroy(void* object){
+        ((T*)object)->~T();
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    std::size_t m_chunk_size;                   ///< The size of regular chunks.
+    std::vector<Chunk> m_chunks;                ///< Every chunk held, in allocation order.
+    std::size_t m_current;                      ///< The chunk being allocated from.
+    std::size_t m_offset;                       ///< The bytes used in the current chunk.
+    std::vector<Destructor> m_destructors;      ///< Objects to destroy when rewinding.
+    std::vector<Scope> m_scopes;                ///< Open scopes, oldest first.
+};
+
+// ---------------------------------------------------------------------------------------------- //
+
+/// @brief Rewinds an arena when it goes out of scope.
+///
+/// Everything allocated from the arena while the scope is open is freed together when it ends.
+/// Scopes on one arena must nest. One which ends while a newer scope is still open leaves its
+/// memory in place until that newer scope ends as well, rather than freeing memory still in use.
+class ArenaScope {
+public:
+    /// @brief Marks the arena's current point.
+    ///
+    /// @param arena The arena to rewind later.
+    explicit ArenaScope(Arena& arena):
+        m_arena(arena),
+        m_depth(arena._open_scope())
+    {}
+
+    /// @brief No copying.
+    ArenaScope(const ArenaScope&) = delete;
+
+    /// @brief Rewinds the arena to where it was when the scope began, once newer scopes are gone.
+    ~ArenaScope(void){
+        m_arena._close_scope(m_depth);
+    }
+
+    /// @brief The arena this scope allocates from.
+    Arena& arena(void){
+        return m_arena;
+    }
+
+private:
+    Arena& m_arena;         ///< The arena to rewind.
+    std::size_t m_depth;    ///< How many scopes were open before this one.
+};
+
+// ---------------------------------------------------------------------------------------------- //
+
+/// @brief Adapts an `Arena` to the standard allocator interface.
+///
+/// Only what is allocated through it lands in the arena. Types which allocate for themselves, such
+/// as `event::Promise` and its shared state, still use the global heap.
+///
+/// @tparam T The type of value being allocated.
+template<typename T>
+class ArenaAllocator {
+public:
+    typedef T value_type; ///< The type of value being allocated.
+
+    /// @brief Allocates from the given arena.
+    ArenaAllocator(Arena& arena):
+        m_arena(&arena)
+    {}
+
+    /// @brief Rebinds an allocator for another type to the same arena.
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other):
+        m_arena(&other.arena())
+    {}
+
+    /// @brief Allocates room for `count` values.
+    T* allocate(const std::size_t count){
+        return (T*)m_arena->allocate(count * sizeof(T), alignof(T));
+    }
+
+    /// @brief Does nothing, the memory comes back when the arena is rewound.
+    void deallocate(T*, const std::size_t){}
+
+    /// @brief The arena being allocated from.
+    Arena& arena(void) const {
+        return *m_arena;
+    }
+
+private:
+    Arena* m_arena; ///< The arena to allocate from.
+};
+
+/// @brief Allocators are equal when they share an arena.
+template<typename T, typename U>
+bool operator==(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs){
+    return &lhs.arena() == &rhs.arena();
+}
+
+/// @brief Allocators differ when they use different arenas.
+template<typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs){
+    return !(lhs == rhs);
+}
+
+}
+}
@@ -13,18 +13,22 @@ void Buffer::_xor(const Buffer& lhs, const Buffer& rhs, Buffer& out){
 // ---------------------------------------------------------------------------------------------- //
 
 Buffer& Buffer::operator=(Buffer&& other){
-    // If own our current data, delete it first.
-    if (m_own_data && m_data) {
-        delete[] m_data;
+    if (this == &other) {
+        return *this;
     }
 
+    // If own our current data, delete it first.
+    _release();
+
     // Copy the information over.
     m_data      = other.m_data;
     m_capacity  = other.m_capacity;
     m_own_data  = other.m_own_data;
+    m_allocator = other.m_allocator;
+    m_block     = std::move(other.m_block);
 
-    // Remove ownership of the buffer from the other one.
-    other.m_own_data = false;
+    // Leave the other buffer empty so it cannot touch memory it no longer owns.
+    other._reset();
 
     // Return self.
     return *this;
@@ -32,6 +36,47 @@ Buffer& Buffer::operator=(Buffer&& other){
 
 // ---------------------------------------------------------------------------------------------- //
 
+Buffer Buffer::slice(const size_type offset, const size_type length) const {
+    _share();
+
+    const size_type start = std::min(offset, m_capacity);
+    Buffer view(m_data + start, std::min(length, m_capacity - start));
+    view.m_block = m_block;
+    return view;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+Buffer Buffer::view(
+    const std::shared_ptr<const Buffer>& buffer,
+    const size_type offset,
+    const size_type length
+){
+    const size_type start = std::min(offset, buffer->size());
+    Buffer view(
+        const_cast<byte*>(buffer->data()) + start,
+        std::min(length, buffer->size() - start)
+    );
+    view.m_block = buffer;
+    return view;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void Buffer::_share(void) const {
+    if (!m_own_data || !m_data) {
+        return;
+    }
+
+    Allocator* allocator = m_allocator;
+    m_block = std::shared_ptr<const void>(m_data, [allocator](const void* data){
+        _free((byte*)data, allocator);
+    });
+    m_own_data = false;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
 bool Buffer::operator==(const Buffer& other) const {
     if (size() != other.size()){
         return false;
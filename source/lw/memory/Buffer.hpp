@@ -5,8 +5,10 @@
 #include <cstdint>
 #include <cstring>
 #include <iterator>
+#include <memory>
 
 #include "lw/iter/Iterable.hpp"
+#include "lw/memory/Allocator.hpp"
 
 namespace lw {
 namespace memory {
@@ -18,7 +20,8 @@ typedef std::uint8_t byte;
 /// @brief A buffer that can store dynamically or statically allocated memory.
 ///
 /// The buffers can be built around existing memory blocks (optionally taking ownership of them) or
-/// can allocate their own blocks.
+/// can allocate their own blocks. Slices of a buffer share ownership of its memory, which is freed
+/// once the buffer and every slice of it are gone.
 ///
 /// There are no protections in place for reading or writing outside the bounds of the buffer.
 class Buffer : public iter::Iterable<Buffer, byte*, const byte*> {
@@ -29,9 +32,10 @@ public:
 
     /// @brief Creates an empty buffer object.
     Buffer(void):
-        m_capacity( 0       ),
-        m_data(     nullptr ),
-        m_own_data( false   )
+        m_capacity(     0       ),
+        m_data(         nullptr ),
+        m_own_data(     false   ),
+        m_allocator(    nullptr )
     {}
 
     // ------------------------------------------------------------------------------------------ //
@@ -44,9 +48,10 @@ public:
     /// @param capacity The size of the buffer in bytes.
     /// @param own_data Flag indicating if this `Buffer` should take ownership of the memory.
     Buffer(byte* buffer, const size_type& capacity, const bool own_data = false):
-        m_capacity( capacity        ),
-        m_data(     (byte*)buffer   ),
-        m_own_data( own_data        )
+        m_capacity(     capacity        ),
+        m_data(         (byte*)buffer   ),
+        m_own_data(     own_data        ),
+        m_allocator(    nullptr         )
     {}
 
     // ------------------------------------------------------------------------------------------ //
@@ -58,18 +63,17 @@ public:
 
     /// @brief Move constructor.
     ///
-    /// The ownership of the data is transfered to this buffer, but the `other` buffer remains
-    /// pointing to the same block with the same capacity so it can continue being used. You are not
-    /// guaranteed that the data in `other` will remain valid as this buffer may free the memory if
-    /// it is destroyed.
+    /// The data and its ownership are transfered to this buffer, leaving `other` empty.
     ///
     /// @param other The buffer to move.
     Buffer(Buffer&& other):
-        m_capacity( other.m_capacity    ),
-        m_data(     other.m_data        ),
-        m_own_data( other.m_own_data     )
+        m_capacity(     other.m_capacity            ),
+        m_data(         other.m_data                ),
+        m_own_data(     other.m_own_data            ),
+        m_allocator(    other.m_allocator           ),
+        m_block(        std::move(other.m_block)    )
     {
-        other.m_own_data = false;
+        other._reset();
     }
 
     // ------------------------------------------------------------------------------------------ //
@@ -82,11 +86,13 @@ public:
     /// @param other    The buffer to move the ownership from.
     /// @param size     The new size to report with.
     Buffer(Buffer&& other, const std::size_t size):
-        m_capacity( size            ),
-        m_data(     other.m_data    ),
-        m_own_data( other.m_own_data )
+        m_capacity(     size                        ),
+        m_data(         other.m_data                ),
+        m_own_data(     other.m_own_data            ),
+        m_allocator(    other.m_allocator           ),
+        m_block(        std::move(other.m_block)    )
     {
-        other.m_own_data = false;
+        other._reset();
     }
 
     // ------------------------------------------------------------------------------------------ //
@@ -95,9 +101,39 @@ public:
     ///
     /// @param size The number of bytes to allocate.
     explicit Buffer(const size_type& size):
-        m_capacity( size            ),
-        m_data(     new byte[size]  ),
-        m_own_data( true            )
+        m_capacity(     size            ),
+        m_data(         new byte[size]  ),
+        m_own_data(     true            ),
+        m_allocator(    nullptr         )
+    {}
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Create a buffer which gets its memory from the given allocator.
+    ///
+    /// The buffer's size is `allocator.round_size(size)`, which may be more than was asked for.
+    /// The allocator must outlive the buffer.
+    ///
+    /// @param size         The number of bytes needed.
+    /// @param allocator    The allocator to get the memory from and give it back to.
+    Buffer(const size_type& size, Allocator& allocator):
+        m_capacity(     allocator.round_size(size)          ),
+        m_data(         (byte*)allocator.allocate(m_capacity)),
+        m_own_data(     true                                ),
+        m_allocator(    &allocator                          )
+    {}
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Create a buffer of exactly the given size, from an allocator if there is one.
+    ///
+    /// Unlike `Buffer(size, Allocator&)` the reported size is never rounded up, though the block
+    /// underneath may be bigger.
+    ///
+    /// @param size         The number of bytes needed.
+    /// @param allocator    The allocator to get the memory from, or null for `new[]`.
+    Buffer(const size_type& size, Allocator* allocator):
+        Buffer(allocator ? Buffer(size, *allocator) : Buffer(size), size)
     {}
 
     // ------------------------------------------------------------------------------------------ //
@@ -124,9 +160,7 @@ public:
 
     /// @brief ~Destructor will free the memory if it is owned by this `Buffer`.
     virtual ~Buffer(void){
-        if (m_own_data && m_data) {
-            delete[] m_data;
-        }
+        _release();
     }
 
     // ------------------------------------------------------------------------------------------ //
@@ -218,6 +252,45 @@ public:
 
     // ------------------------------------------------------------------------------------------ //
 
+    /// @brief Makes a view of part of this buffer which shares ownership of its memory.
+    ///
+    /// Owned memory is handed over to a reference-counted block the first time the buffer is
+    /// sliced, and every slice keeps that block alive. Slices of memory the buffer does not own are
+    /// plain views, only valid for as long as that memory is.
+    ///
+    /// @param offset   The number of bytes into this buffer to start the slice.
+    /// @param length   The size of the slice, cut short at the end of this buffer.
+    ///
+    /// @return A buffer viewing the given range.
+    Buffer slice(const size_type offset, const size_type length) const;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Makes a view of part of a shared buffer which keeps that buffer alive.
+    ///
+    /// This suits buffers handed around by pointer, such as stream and file read chunks, whose
+    /// memory may go back to a pool once the last pointer is gone.
+    ///
+    /// @param buffer   The buffer to view.
+    /// @param offset   The number of bytes into `buffer` to start the view.
+    /// @param length   The size of the view, cut short at the end of `buffer`.
+    ///
+    /// @return A buffer viewing the given range.
+    static Buffer view(
+        const std::shared_ptr<const Buffer>& buffer,
+        const size_type offset,
+        const size_type length
+    );
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Indicates if any other buffer is keeping this one's memory alive.
+    bool shared(void) const {
+        return m_block && m_block.use_count() > 1;
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
     /// @brief No copy operator.
     Buffer& operator=(const Buffer& other) = delete;
 
@@ -225,10 +298,7 @@ public:
 
     /// @brief Moves control of a buffer over to this one.
     ///
-    /// The ownership of the data is transfered to this buffer, but the `other` buffer remains
-    /// pointing to the same block with the same capacity so it can continue being used. You are not
-    /// guaranteed that the data in `other` will remain valid as this buffer may free the memory if
-    /// it is destroyed.
+    /// The data and its ownership are transfered to this buffer, leaving `other` empty.
     ///
     /// @param other The buffer to move the control from.
     ///
@@ -286,9 +356,51 @@ public:
     // ------------------------------------------------------------------------------------------ //
 
 private:
-    size_type   m_capacity; ///< The capacity of the buffer in bytes.
-    byte*       m_data;     ///< The data wrapped by the buffer.
-    bool        m_own_data; ///< Flag indicating if the buffer owns the memory.
+    size_type       m_capacity;     ///< The capacity of the buffer in bytes.
+    byte*           m_data;         ///< The data wrapped by the buffer.
+    mutable bool    m_own_data;     ///< Flag indicating if the buffer solely owns the memory.
+    Allocator*      m_allocator;    ///< Where owned memory came from, or null for `new[]`.
+
+    /// @brief Shared ownership of the memory once it has been sliced.
+    mutable std::shared_ptr<const void> m_block;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Frees the memory if it is owned by this buffer alone.
+    void _release(void){
+        if (m_own_data && m_data) {
+            _free(m_data, m_allocator);
+        }
+        m_block.reset();
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Empties the buffer without freeing anything.
+    void _reset(void){
+        m_capacity  = 0;
+        m_data      = nullptr;
+        m_own_data  = false;
+        m_allocator = nullptr;
+        m_block.reset();
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Hands owned memory over to a reference-counted block.
+    void _share(void) const;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Gives owned memory back to where it came from.
+    static void _free(byte* data, Allocator* allocator){
+        if (allocator) {
+            allocator->deallocate(data);
+        }
+        else {
+            delete[] data;
+        }
+    }
 
     // ------------------------------------------------------------------------------------------ //
 
@@ -0,0 +1,82 @@
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "lw/memory/BufferBuilder.hpp"
+
+namespace lw {
+namespace memory {
+
+BufferBuilder::BufferBuilder(const size_type capacity):
+    m_size(0),
+    m_allocator(nullptr)
+{
+    reserve(capacity);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+BufferBuilder::BufferBuilder(const size_type capacity, Allocator& allocator):
+    m_size(0),
+    m_allocator(&allocator)
+{
+    reserve(capacity);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void BufferBuilder::reserve(const size_type capacity){
+    if (capacity > m_buffer.capacity()) {
+        Buffer grown = m_allocator ? Buffer(capacity, *m_allocator) : Buffer(capacity);
+        if (m_size > 0) {
+            std::memcpy(grown.data(), m_buffer.data(), m_size);
+        }
+        m_buffer = std::move(grown);
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void BufferBuilder::append(const void* data, const size_type size){
+    if (size > 0) {
+        std::memcpy(prepare(size), data, size);
+        m_size += size;
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+byte* BufferBuilder::prepare(const size_type bytes){
+    if (m_buffer.capacity() - m_size < bytes) {
+        _grow(m_size + bytes);
+    }
+    return m_buffer.data() + m_size;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void BufferBuilder::commit(const size_type bytes){
+    if (m_buffer.capacity() - m_size < bytes) {
+        throw MemoryError(2, "Cannot commit more bytes than were prepared.");
+    }
+    m_size += bytes;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+Buffer BufferBuilder::release(void){
+    Buffer released(std::move(m_buffer), m_size);
+    m_size = 0;
+    return released;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void BufferBuilder::_grow(const size_type needed){
+    // Doubling keeps the total copying linear in the final size.
+    reserve(std::max<size_type>({needed, m_buffer.capacity() * 2, 64}));
+}
+
+}
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstddef>
+
+#include "lw/memory/Allocator.hpp"
+#include "lw/memory/Buffer.hpp"
+
+namespace lw {
+namespace memory {
+
+/// @brief Builds up a buffer of unknown final size, growing it as needed.
+///
+/// The builder keeps the number of bytes written separate from the memory set aside for them.
+/// When more room is needed the capacity at least doubles, so appending byte by byte costs
+/// constant amortized time. Serializers can either `append` data or write straight into spare
+/// capacity with `prepare` and `commit`. Once done, `release` hands the memory over to a `Buffer`
+/// without copying it.
+class BufferBuilder {
+public:
+    typedef Buffer::size_type size_type; ///< Type used for sizes.
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Creates an empty builder with memory from `new[]`.
+    ///
+    /// @param capacity The number of bytes to set aside up front.
+    explicit BufferBuilder(const size_type capacity = 0);
+
+    /// @brief Creates an empty builder with memory from the given allocator.
+    ///
+    /// The allocator must outlive the builder and every buffer it releases.
+    ///
+    /// @param capacity     The number of bytes to set aside up front.
+    /// @param allocator    Where to get memory from.
+    BufferBuilder(const size_type capacity, Allocator& allocator);
+
+    /// @brief No copying.
+    BufferBuilder(const BufferBuilder&) = delete;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief The number of bytes written so far.
+    size_type size(void) const {
+        return m_size;
+    }
+
+    /// @brief The number of bytes which can be written before the builder must grow.
+    size_type capacity(void) const {
+        return m_buffer.capacity();
+    }
+
+    /// @brief Indicates if nothing has been written.
+    bool empty(void) const {
+        return m_size == 0;
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief The start of the written bytes.
+    ///
+    /// Growing the builder moves its memory, so the pointer is only good until the next call
+    /// which may grow it.
+    byte* data(void){
+        return m_buffer.data();
+    }
+
+    /// @copydoc BufferBuilder::data()
+    const byte* data(void) const {
+        return m_buffer.data();
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Makes sure the builder can hold at least this many bytes without growing.
+    ///
+    /// @param capacity The total number of bytes to make room for.
+    void reserve(const size_type capacity);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Copies bytes onto the end, growing as needed.
+    ///
+    /// @param data The bytes to add.
+    /// @param size The number of bytes to add.
+    void append(const void* data, const size_type size);
+
+    /// @brief Copies a buffer's contents onto the end, growing as needed.
+    ///
+    /// @param buffer The buffer to add.
+    void append(const Buffer& buffer){
+        append(buffer.data(), buffer.size());
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Makes room to write bytes straight into the builder.
+    ///
+    /// Nothing written counts until it is passed to `commit`.
+    ///
+    /// @param bytes The number of bytes to make room for.
+    ///
+    /// @return A pointer just past the written bytes, with at least `bytes` bytes of room.
+    byte* prepare(const size_type bytes);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Counts bytes written into the space given by `prepare`.
+    ///
+    /// @param bytes The number of bytes which were written.
+    ///
+    /// @throws MemoryError If that would be more than the builder's capacity.
+    void commit(const size_type bytes);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Forgets everything written, keeping the memory for reuse.
+    void clear(void){
+        m_size = 0;
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Hands the written bytes over to a buffer without copying them.
+    ///
+    /// The builder is left empty with no memory of its own.
+    ///
+    /// @return A buffer owning the builder's memory, sized to the bytes written.
+    Buffer release(void);
+
+    // ------------------------------------------------------------------------------------------ //
+
+private:
+    /// @brief Moves the data into a block of at least the given size.
+    void _grow(const size_type needed);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    Buffer m_buffer;            ///< The memory being written into.
+    size_type m_size;           ///< The number of bytes written.
+    Allocator* m_allocator;     ///< Where memory comes from, or null for `new[]`.
+};
+
+}
+}
@@ -0,0 +1,150 @@
+
+#include <algorithm>
+#include <utility>
+
+#include "lw/memory/BufferChain.hpp"
+
+namespace lw {
+namespace memory {
+
+BufferChain::BufferChain(BufferChain&& other):
+    m_buffers(std::move(other.m_buffers)),
+    m_size(other.m_size)
+{
+    other.clear();
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+BufferChain& BufferChain::operator=(BufferChain&& other){
+    if (this != &other) {
+        m_buffers = std::move(other.m_buffers);
+        m_size = other.m_size;
+        other.clear();
+    }
+    return *this;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void BufferChain::append(Buffer&& buffer){
+    if (buffer.size() > 0) {
+        m_size += buffer.size();
+        m_buffers.push_back(std::move(buffer));
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void BufferChain::append(BufferChain&& chain){
+    if (&chain == this) {
+        return;
+    }
+    for (auto& buffer : chain.m_buffers) {
+        m_buffers.push_back(std::move(buffer));
+    }
+    m_size += chain.m_size;
+    chain.clear();
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void BufferChain::prepend(Buffer&& buffer){
+    if (buffer.size() > 0) {
+        m_size += buffer.size();
+        m_buffers.push_front(std::move(buffer));
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+BufferChain BufferChain::split_at(const size_type bytes){
+    BufferChain head;
+    size_type remaining = std::min(bytes, m_size);
+    while (remaining > 0) {
+        Buffer& front = m_buffers.front();
+        if (front.size() <= remaining) {
+            remaining -= front.size();
+            m_size -= front.size();
+            head.append(std::move(front));
+            m_buffers.pop_front();
+        }
+        else {
+            // Both halves share the piece's memory.
+            head.append(front.slice(0, remaining));
+            front = front.slice(remaining, front.size() - remaining);
+            m_size -= remaining;
+            remaining = 0;
+        }
+    }
+    return head;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void BufferChain::consume(const size_type bytes){
+    size_type remaining = std::min(bytes, m_size);
+    while (remaining > 0) {
+        Buffer& front = m_buffers.front();
+        if (front.size() <= remaining) {
+            remaining -= front.size();
+            m_size -= front.size();
+            m_buffers.pop_front();
+        }
+        else {
+            front = front.slice(remaining, front.size() - remaining);
+            m_size -= remaining;
+            remaining = 0;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void BufferChain::clear(void){
+    m_buffers.clear();
+    m_size = 0;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void BufferChain::uv_buffers(std::vector<uv_buf_t>& out) const {
+    out.clear();
+    out.reserve(m_buffers.size());
+    for (const auto& buffer : m_buffers) {
+        out.push_back(uv_buf_init((char*)buffer.data(), buffer.size()));
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+std::vector<uv_buf_t> BufferChain::uv_buffers(void) const {
+    std::vector<uv_buf_t> out;
+    uv_buffers(out);
+    return out;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+const Buffer& BufferChain::linearize(void){
+    static const Buffer empty_buffer;
+    if (m_buffers.empty()) {
+        return empty_buffer;
+    }
+    if (m_buffers.size() == 1) {
+        return m_buffers.front();
+    }
+
+    Buffer joined(m_size);
+    size_type offset = 0;
+    for (const auto& buffer : m_buffers) {
+        std::copy(buffer.begin(), buffer.end(), joined.data() + offset);
+        offset += buffer.size();
+    }
+    m_buffers.clear();
+    m_buffers.push_back(std::move(joined));
+    return m_buffers.front();
+}
+
+}
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <uv.h>
+#include <vector>
+
+#include "lw/memory/Buffer.hpp"
+
+namespace lw {
+namespace memory {
+
+/// @brief A sequence of buffers treated as one run of bytes, for assembling data without copying.
+///
+/// Pieces are added and removed at either end in constant time. Splitting or consuming part way
+/// into a piece slices it, so the remainder shares the original memory instead of copying it. The
+/// pieces can be handed straight to vectored writes with `uv_buffers`, or collapsed into a single
+/// buffer with `linearize` when contiguous memory is really needed.
+class BufferChain {
+public:
+    typedef std::size_t size_type; ///< Type used for sizes.
+    typedef std::deque<Buffer>::const_iterator const_iterator; ///< Iterator over the pieces.
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Creates an empty chain.
+    BufferChain(void):
+        m_size(0)
+    {}
+
+    /// @brief Takes over another chain's pieces, leaving it empty.
+    BufferChain(BufferChain&& other);
+
+    /// @brief No copying.
+    BufferChain(const BufferChain&) = delete;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Takes over another chain's pieces, leaving it empty.
+    BufferChain& operator=(BufferChain&& other);
+
+    /// @brief No copying.
+    BufferChain& operator=(const BufferChain&) = delete;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Adds a piece to the end of the chain.
+    ///
+    /// Empty buffers are dropped.
+    ///
+    /// @param buffer The piece to add.
+    void append(Buffer&& buffer);
+
+    /// @brief Moves every piece of another chain onto the end of this one.
+    ///
+    /// @param chain The chain to empty into this one.
+    void append(BufferChain&& chain);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Adds a piece to the front of the chain.
+    ///
+    /// Empty buffers are dropped.
+    ///
+    /// @param buffer The piece to add.
+    void prepend(Buffer&& buffer);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Removes bytes from the front of the chain into a new chain.
+    ///
+    /// @param bytes The number of bytes to take, cut short at the end of the chain.
+    ///
+    /// @return A chain holding the first `bytes` bytes of this one.
+    BufferChain split_at(const size_type bytes);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Drops bytes from the front of the chain.
+    ///
+    /// @param bytes The number of bytes to drop, cut short at the end of the chain.
+    void consume(const size_type bytes);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Drops every piece.
+    void clear(void);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief The total number of bytes in the chain.
+    size_type size(void) const {
+        return m_size;
+    }
+
+    /// @brief The number of pieces in the chain.
+    size_type count(void) const {
+        return m_buffers.size();
+    }
+
+    /// @brief Indicates if the chain has no bytes at all.
+    bool empty(void) const {
+        return m_size == 0;
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief The first piece of the chain.
+    const_iterator begin(void) const {
+        return m_buffers.begin();
+    }
+
+    /// @brief Just past the last piece of the chain.
+    const_iterator end(void) const {
+        return m_buffers.end();
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Describes the pieces for a vectored read or write.
+    ///
+    /// The descriptions point into the chain's memory, so the chain must be left alone until the
+    /// operation using them completes.
+    ///
+    /// @param out The vector to fill, replacing anything already in it.
+    void uv_buffers(std::vector<uv_buf_t>& out) const;
+
+    /// @copydoc BufferChain::uv_buffers(std::vector<uv_buf_t>&) const
+    ///
+    /// @return The descriptions of each piece, in order.
+    std::vector<uv_buf_t> uv_buffers(void) const;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Collapses the chain into a single piece.
+    ///
+    /// Chains of more than one piece are copied into a new buffer, which then replaces them.
+    ///
+    /// @return The one piece holding the whole chain.
+    const Buffer& linearize(void);
+
+    // ------------------------------------------------------------------------------------------ //
+
+private:
+    std::deque<Buffer> m_buffers;   ///< The pieces, in order.
+    size_type m_size;               ///< The total number of bytes in the pieces.
+};
+
+}
+}
@@ -0,0 +1,341 @@
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+#include "lw/memory/Buffer.hpp"
+#include "lw/memory/BufferPool.hpp"
+
+namespace lw {
+namespace memory {
+
+namespace {
+    /// @brief The power of two of the smallest size class.
+    const std::size_t MIN_CLASS_SHIFT = 6;
+
+    /// @brief The number of size classes, from 64 bytes up to 1 MiB.
+    const std::size_t CLASS_COUNT = 15;
+
+    /// @brief Room in front of each block for its size, keeping the block itself fully aligned.
+    const std::size_t HEADER_SIZE = alignof(std::max_align_t);
+
+    static_assert(HEADER_SIZE >= sizeof(std::size_t), "Block header too small for its size.");
+
+    /// @brief Source of pool identifiers, which are never reused.
+    std::atomic<std::uint64_t> next_pool_id(1);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Finds the size class a request falls in.
+    std::size_t class_of(const std::size_t size){
+        std::size_t index = 0;
+        while (((std::size_t)1 << (MIN_CLASS_SHIFT + index)) < size) {
+            ++index;
+        }
+        return index;
+    }
+
+    /// @brief The size of every block in a class.
+    std::size_t class_size(const std::size_t index){
+        return (std::size_t)1 << (MIN_CLASS_SHIFT + index);
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief The size recorded in front of a block.
+    std::size_t& block_size(void* data){
+        return *(std::size_t*)((byte*)data - HEADER_SIZE);
+    }
+
+    /// @brief Gives a block back to the system.
+    void free_block(void* data){
+        ::operator delete((byte*)data - HEADER_SIZE);
+    }
+
+    /// @brief Moves the last `count` blocks of one free list onto the end of another.
+    void move_blocks(std::vector<void*>& from, std::vector<void*>& to, const std::size_t count){
+        to.insert(to.end(), from.end() - count, from.end());
+        from.resize(from.size() - count);
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+const std::size_t BufferPool::min_class_size = class_size(0);
+const std::size_t BufferPool::max_class_size = class_size(CLASS_COUNT - 1);
+
+// ---------------------------------------------------------------------------------------------- //
+
+struct BufferPool::_Depot {
+    explicit _Depot(const std::size_t limit):
+        limit(limit),
+        reserved(0),
+        closed(false)
+    {}
+
+    ~_Depot(void){
+        for (auto& blocks : free) {
+            for (void* data : blocks) {
+                free_block(data);
+            }
+        }
+    }
+
+    /// @brief Allocates a block from the system, refusing it if that would go over the limit.
+    void* new_block(const std::size_t size){
+        if (reserved.fetch_add(size) + size > limit && limit) {
+            reserved -= size;
+            throw std::bad_alloc();
+        }
+
+        void* data;
+        try {
+            data = (byte*)::operator new(HEADER_SIZE + size) + HEADER_SIZE;
+        }
+        catch (...) {
+            reserved -= size;
+            throw;
+        }
+        block_size(data) = size;
+        return data;
+    }
+
+    const std::size_t limit;                ///< The most bytes to hold, or 0 for no limit.
+    std::atomic<std::size_t> reserved;      ///< The bytes held, in use or cached.
+    std::atomic<bool> closed;               ///< Set once the pool is gone.
+    std::mutex mutex;                       ///< Guards the free lists.
+    std::vector<void*> free[CLASS_COUNT];   ///< Free blocks for each size class.
+};
+
+// ---------------------------------------------------------------------------------------------- //
+
+struct BufferPool::_ThreadCache {
+    _ThreadCache(const std::shared_ptr<_Depot>& depot, const std::size_t cache_blocks):
+        depot(depot)
+    {
+        for (auto& blocks : free) {
+            blocks.reserve(cache_blocks + 1);
+        }
+    }
+
+    _ThreadCache(_ThreadCache&&) = default;
+
+    /// @brief Hands every cached block back to the depot.
+    ~_ThreadCache(void){
+        if (!depot) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(depot->mutex);
+        for (std::size_t i = 0; i < CLASS_COUNT; ++i) {
+            move_blocks(free[i], depot->free[i], free[i].size());
+        }
+    }
+
+    std::shared_ptr<_Depot> depot;          ///< Where overflow goes, kept alive for the flush.
+    std::vector<void*> free[CLASS_COUNT];   ///< Free blocks for each size class.
+};
+
+// ---------------------------------------------------------------------------------------------- //
+
+namespace {
+    /// @brief Set once this thread's caches are being torn down, after which pools skip them.
+    ///
+    /// Being trivially destructible, this stays readable for the rest of the thread's shutdown.
+    thread_local bool thread_caches_gone = false;
+
+    /// @brief Every pool's cache for this thread.
+    template<typename Cache>
+    struct ThreadCaches {
+        ~ThreadCaches(void){
+            thread_caches_gone = true;
+        }
+
+        std::unordered_map<std::uint64_t, Cache> caches;    ///< Caches by pool identifier.
+        std::uint64_t last_id = 0;                          ///< The pool used most recently.
+        Cache* last = nullptr;                              ///< That pool's cache.
+    };
+
+    /// @brief This thread's caches, created on first use.
+    template<typename Cache>
+    ThreadCaches<Cache>& thread_caches(void){
+        thread_local ThreadCaches<Cache> caches;
+        return caches;
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+BufferPool::BufferPool(const std::size_t limit, const std::size_t cache_blocks):
+    m_id(next_pool_id++),
+    m_cache_blocks(cache_blocks),
+    m_depot(std::make_shared<_Depot>(limit))
+{}
+
+// ---------------------------------------------------------------------------------------------- //
+
+BufferPool::~BufferPool(void){
+    // Caches left in other threads are swept up as they find new pools, or when they exit.
+    m_depot->closed = true;
+    trim();
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void* BufferPool::allocate(const std::size_t size){
+    if (size > max_class_size) {
+        return _new_block(size);
+    }
+
+    const std::size_t index = class_of(size);
+    _ThreadCache* cache = _cache();
+    if (cache) {
+        std::vector<void*>& blocks = cache->free[index];
+        if (blocks.empty()) {
+            // Refill in a batch so the depot lock is taken once for many allocations.
+            std::lock_guard<std::mutex> lock(m_depot->mutex);
+            std::vector<void*>& shared = m_depot->free[index];
+            const std::size_t batch = std::max<std::size_t>(m_cache_blocks / 2, 1);
+            move_blocks(shared, blocks, std::min(batch, shared.size()));
+        }
+        if (!blocks.empty()) {
+            void* data = blocks.back();
+            blocks.pop_back();
+            return data;
+        }
+    }
+    else {
+        std::lock_guard<std::mutex> lock(m_depot->mutex);
+        std::vector<void*>& shared = m_depot->free[index];
+        if (!shared.empty()) {
+            void* data = shared.back();
+            shared.pop_back();
+            return data;
+        }
+    }
+
+    return _new_block(class_size(index));
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void BufferPool::deallocate(void* data){
+    if (!data) {
+        return;
+    }
+
+    const std::size_t size = block_size(data);
+    if (size > max_class_size) {
+        free_block(data);
+        m_depot->reserved -= size;
+        return;
+    }
+
+    const std::size_t index = class_of(size);
+    _ThreadCache* cache = _cache();
+    if (!cache) {
+        std::lock_guard<std::mutex> lock(m_depot->mutex);
+        m_depot->free[index].push_back(data);
+        return;
+    }
+
+    std::vector<void*>& blocks = cache->free[index];
+    blocks.push_back(data);
+    if (blocks.size() > m_cache_blocks) {
+        // Keep half so alternating frees and allocations do not bounce off the depot.
+        std::lock_guard<std::mutex> lock(m_depot->mutex);
+        move_blocks(blocks, m_depot->free[index], blocks.size() - m_cache_blocks / 2);
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+std::size_t BufferPool::round_size(const std::size_t size) const {
+    return size > max_class_size ? size : class_size(class_of(size));
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void BufferPool::trim(void){
+    if (!thread_caches_gone) {
+        // Dropping this thread's cache flushes it into the depot.
+        auto& caches = thread_caches<_ThreadCache>();
+        caches.caches.erase(m_id);
+        caches.last_id = 0;
+        caches.last = nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(m_depot->mutex);
+    for (std::size_t i = 0; i < CLASS_COUNT; ++i) {
+        for (void* data : m_depot->free[i]) {
+            free_block(data);
+        }
+        m_depot->reserved -= m_depot->free[i].size() * class_size(i);
+        m_depot->free[i].clear();
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+std::size_t BufferPool::limit(void) const {
+    return m_depot->limit;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+std::size_t BufferPool::reserved(void) const {
+    return m_depot->reserved;
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void* BufferPool::_new_block(const std::size_t size){
+    try {
+        return m_depot->new_block(size);
+    }
+    catch (const std::bad_alloc&) {
+        if (!limit()) {
+            throw;
+        }
+    }
+
+    // Idle blocks of other sizes count against the limit, so free them and try once more.
+    trim();
+    return m_depot->new_block(size);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+BufferPool::_ThreadCache* BufferPool::_cache(void){
+    if (thread_caches_gone) {
+        return nullptr;
+    }
+
+    auto& caches = thread_caches<_ThreadCache>();
+    if (caches.last_id == m_id) {
+        return caches.last;
+    }
+
+    auto it = caches.caches.find(m_id);
+    if (it == caches.caches.end()) {
+        // Clear out caches for pools which have since been destroyed.
+        for (auto old = caches.caches.begin(); old != caches.caches.end();) {
+            if (old->second.depot->closed) {
+                old = caches.caches.erase(old);
+            }
+            else {
+                ++old;
+            }
+        }
+        it = caches.caches.emplace(m_id, _ThreadCache(m_depot, m_cache_blocks)).first;
+    }
+
+    caches.last_id = m_id;
+    caches.last = &it->second;
+    return caches.last;
+}
+
+}
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "lw/memory/Allocator.hpp"
+
+namespace lw {
+namespace memory {
+
+/// @brief Recycles buffer memory in power-of-two size classes.
+///
+/// Requests up to `max_class_size` are rounded up to a power of two, no smaller than
+/// `min_class_size`, and freed blocks are kept for the next request of the same class. Each thread
+/// keeps its own cache of free blocks which it reaches without locking. When a thread's cache for a
+/// class fills up, half of it moves to a depot shared by every thread, and an empty cache refills
+/// from the depot in one batch before anything new is allocated. Larger requests bypass the
+/// classes and go straight to the system.
+///
+/// A pool with a limit refuses to hold more than that many bytes at once, counting blocks in use
+/// and blocks cached. When a new block would go over, the pool first frees what the depot and the
+/// calling thread have cached, and if that is not enough throws `std::bad_alloc`.
+///
+/// As with any `Allocator`, buffers made from the pool give their memory back to it when destroyed
+/// and the pool must outlive them. Blocks cached by other threads are released when those threads
+/// exit.
+class BufferPool : public Allocator {
+public:
+    static const std::size_t min_class_size;    ///< The size of the smallest class.
+    static const std::size_t max_class_size;    ///< The size of the largest class.
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Creates an empty pool.
+    ///
+    /// @param limit        The most bytes the pool may hold at once, or 0 for no limit.
+    /// @param cache_blocks The most free blocks each thread caches per size class.
+    explicit BufferPool(const std::size_t limit = 0, const std::size_t cache_blocks = 64);
+
+    /// @brief No copying.
+    BufferPool(const BufferPool&) = delete;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Releases the free blocks held by the depot and this thread's cache.
+    ~BufferPool(void);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Takes a block from the caches, or allocates one if they are empty.
+    ///
+    /// @param size The number of bytes needed, as already passed through `round_size`.
+    ///
+    /// @return A pointer to the block.
+    ///
+    /// @throws std::bad_alloc If a new block would take the pool over its limit.
+    void* allocate(const std::size_t size) override;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Returns a block to this thread's cache, or to the system if it has no class.
+    ///
+    /// @param data The block to release.
+    void deallocate(void* data) override;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Rounds the size up to its size class.
+    ///
+    /// @param size The number of bytes requested.
+    ///
+    /// @return The size of the class `size` falls in, or `size` itself if it is above every class.
+    std::size_t round_size(const std::size_t size) const override;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Frees the blocks held by the depot and this thread's cache.
+    ///
+    /// Blocks in use and blocks cached by other threads are untouched.
+    void trim(void);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief The most bytes the pool may hold, or 0 if there is no limit.
+    std::size_t limit(void) const;
+
+    /// @brief The number of bytes the pool holds, in use or cached.
+    std::size_t reserved(void) const;
+
+    // ------------------------------------------------------------------------------------------ //
+
+private:
+    struct _Depot;
+    struct _ThreadCache;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Allocates a block from the system, trimming the caches if the limit is reached.
+    ///
+    /// @throws std::bad_alloc If the block would still take the pool over its limit.
+    void* _new_block(const std::size_t size);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Finds this thread's cache for the pool, creating it if needed.
+    ///
+    /// @return The cache, or null once the thread has started shutting down.
+    _ThreadCache* _cache(void);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    std::uint64_t m_id;                 ///< Unique identifier for finding thread caches.
+    std::size_t m_cache_blocks;         ///< The most blocks cached per thread and class.
+    std::shared_ptr<_Depot> m_depot;    ///< Free blocks shared between threads.
+};
+
+}
+}
@@ -0,0 +1,132 @@
+
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+    #include <nmmintrin.h>
+    #define LW_CRC32C_SSE42 1
+#endif
+
+#include "lw/memory/Crc32c.hpp"
+
+namespace lw {
+namespace memory {
+
+namespace _details {
+    /// @brief The CRC-32C polynomial, bit-reversed.
+    const std::uint32_t CRC32C_POLYNOMIAL = 0x82f63b78;
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Lookup tables for checksumming eight bytes at a time in software.
+    struct Crc32cTables {
+        Crc32cTables(void){
+            for (std::uint32_t i = 0; i < 256; ++i) {
+                std::uint32_t crc = i;
+                for (int bit = 0; bit < 8; ++bit) {
+                    crc = (crc >> 1) ^ (crc & 1 ? CRC32C_POLYNOMIAL : 0);
+                }
+                table[0][i] = crc;
+            }
+            for (std::uint32_t i = 0; i < 256; ++i) {
+                for (int slice = 1; slice < 8; ++slice) {
+                    const std::uint32_t prev = table[slice - 1][i];
+                    table[slice][i] = (prev >> 8) ^ table[0][prev & 0xff];
+                }
+            }
+        }
+
+        std::uint32_t table[8][256];
+    };
+
+    // ------------------------------------------------------------------------------------------ //
+
+    std::uint32_t crc32c_software(std::uint32_t crc, const byte* data, std::size_t size){
+        static const Crc32cTables tables;
+        const auto& table = tables.table;
+
+        while (size >= 8) {
+            std::uint32_t low;
+            std::uint32_t high;
+            std::memcpy(&low, data, 4);
+            std::memcpy(&high, data + 4, 4);
+            low ^= crc;
+            crc = table[7][low & 0xff] ^ table[6][(low >> 8) & 0xff] ^
+                table[5][(low >> 16) & 0xff] ^ table[4][low >> 24] ^
+                table[3][high & 0xff] ^ table[2][(high >> 8) & 0xff] ^
+                table[1][(high >> 16) & 0xff] ^ table[0][high >> 24];
+            data += 8;
+            size -= 8;
+        }
+        while (size--) {
+            crc = (crc >> 8) ^ table[0][(crc ^ *data++) & 0xff];
+        }
+        return crc;
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+#ifdef LW_CRC32C_SSE42
+    __attribute__((target("sse4.2")))
+    std::uint32_t crc32c_sse42(std::uint32_t crc, const byte* data, std::size_t size){
+        while (size && ((std::uintptr_t)data & 7)) {
+            crc = _mm_crc32_u8(crc, *data++);
+            --size;
+        }
+
+        std::uint64_t wide = crc;
+        while (size >= 8) {
+            std::uint64_t word;
+            std::memcpy(&word, data, 8);
+            wide = _mm_crc32_u64(wide, word);
+            data += 8;
+            size -= 8;
+        }
+
+        crc = (std::uint32_t)wide;
+        while (size--) {
+            crc = _mm_crc32_u8(crc, *data++);
+        }
+        return crc;
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    bool crc32c_has_sse42(void){
+        static const bool has_sse42 = __builtin_cpu_supports("sse4.2");
+        return has_sse42;
+    }
+#endif
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+void Crc32c::update(const void* data, const std::size_t size){
+#ifdef LW_CRC32C_SSE42
+    if (_details::crc32c_has_sse42()) {
+        m_state = _details::crc32c_sse42(m_state, (const byte*)data, size);
+        return;
+    }
+#endif
+    m_state = _details::crc32c_software(m_state, (const byte*)data, size);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+std::uint32_t Crc32c::compute(const void* data, const std::size_t size){
+    Crc32c crc;
+    crc.update(data, size);
+    return crc.value();
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+bool Crc32c::hardware_accelerated(void){
+#ifdef LW_CRC32C_SSE42
+    return _details::crc32c_has_sse42();
+#else
+    return false;
+#endif
+}
+
+}
+}
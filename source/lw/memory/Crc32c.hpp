@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "lw/memory/Buffer.hpp"
+
+namespace lw {
+namespace memory {
+
+/// @brief Accumulates a CRC-32C (Castagnoli) checksum over a sequence of buffers.
+///
+/// Each buffer is folded into the running checksum as it is given, so data can be checked while it
+/// streams past without a second pass over it. The SSE4.2 `crc32` instruction is used when the
+/// processor has it, with a table-driven fallback otherwise.
+class Crc32c {
+public:
+    /// @brief Starts an empty checksum.
+    Crc32c(void):
+        m_state(0xffffffff)
+    {}
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Folds some bytes into the checksum.
+    ///
+    /// @param data The bytes to add.
+    /// @param size The number of bytes to add.
+    void update(const void* data, const std::size_t size);
+
+    /// @brief Folds a buffer's contents into the checksum.
+    ///
+    /// @param buffer The buffer to add.
+    void update(const Buffer& buffer){
+        update(buffer.data(), buffer.size());
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief The checksum of everything added so far.
+    std::uint32_t value(void) const {
+        return ~m_state;
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Starts the checksum over.
+    void reset(void){
+        m_state = 0xffffffff;
+    }
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Checksums a single block of bytes.
+    ///
+    /// @param data The bytes to checksum.
+    /// @param size The number of bytes to checksum.
+    ///
+    /// @return The CRC-32C of the bytes.
+    static std::uint32_t compute(const void* data, const std::size_t size);
+
+    // ------------------------------------------------------------------------------------------ //
+
+    /// @brief Indicates if checksums are computed by the processor's `crc32` instruction.
+    static bool hardware_accelerated(void);
+
+    // ------------------------------------------------------------------------------------------ //
+
+private:
+    std::uint32_t m_state; ///< The running checksum, before the final inversion.
+};
+
+}
+}
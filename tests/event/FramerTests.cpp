@@ -0,0 +1,179 @@
+
+#include <chrono>
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "lw/event.hpp"
+#include "lw/io.hpp"
+#include "lw/memory.hpp"
+
+using namespace std::chrono_literals;
+
+namespace lw {
+namespace tests {
+
+struct FramerTests : public testing::Test {
+    typedef event::Framer::buffer_ptr_t buffer_ptr_t;
+
+    std::vector<buffer_ptr_t> frames;
+
+    static buffer_ptr_t chunk(const std::string& str){
+        return std::make_shared<const memory::Buffer>(str.begin(), str.end());
+    }
+
+    static std::string to_string(const buffer_ptr_t& buffer){
+        return std::string((const char*)buffer->data(), buffer->size());
+    }
+
+    void collect(event::Framer& framer){
+        framer.on_frame([this](const buffer_ptr_t& frame){ frames.push_back(frame); });
+    }
+};
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(FramerTests, LengthPrefixWithinChunk){
+    event::LengthPrefixFramer framer(event::LengthPrefixFramer::U32_BE);
+    collect(framer);
+
+    auto data = chunk(std::string("\0\0\0\5hello\0\0\0\0\0\0\0\3abc", 20));
+    framer.feed(data);
+
+    ASSERT_EQ(3, frames.size());
+    EXPECT_EQ("hello", to_string(frames[0]));
+    EXPECT_EQ("", to_string(frames[1]));
+    EXPECT_EQ("abc", to_string(frames[2]));
+    EXPECT_FALSE(framer.has_partial_frame());
+
+    // Whole frames should be views straight into the chunk.
+    EXPECT_EQ(data->data() + 4, frames[0]->data());
+    EXPECT_EQ(data->data() + 17, frames[2]->data());
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(FramerTests, LengthPrefixAcrossChunks){
+    event::LengthPrefixFramer framer(event::LengthPrefixFramer::U32_BE);
+    collect(framer);
+
+    framer.feed(chunk(std::string("\0\0", 2)));
+    EXPECT_TRUE(framer.has_partial_frame());
+    framer.feed(chunk(std::string("\0\13hello", 7)));
+    EXPECT_EQ(0, frames.size());
+    framer.feed(chunk(std::string(" world\0\0\0\2", 10)));
+    ASSERT_EQ(1, frames.size());
+    EXPECT_EQ("hello world", to_string(frames[0]));
+    EXPECT_TRUE(framer.has_partial_frame());
+    framer.feed(chunk("ok"));
+
+    ASSERT_EQ(2, frames.size());
+    EXPECT_EQ("ok", to_string(frames[1]));
+    EXPECT_FALSE(framer.has_partial_frame());
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(FramerTests, LengthPrefixVarint){
+    event::LengthPrefixFramer framer(event::LengthPrefixFramer::VARINT);
+    collect(framer);
+
+    const std::string body(300, 'x');
+    memory::byte prefix[10];
+    const std::size_t prefix_size =
+        event::LengthPrefixFramer::encode(event::LengthPrefixFramer::VARINT, body.size(), prefix);
+    EXPECT_EQ(2, prefix_size);
+
+    const std::string message = std::string((const char*)prefix, prefix_size) + body;
+    framer.feed(chunk(message.substr(0, 1)));
+    framer.feed(chunk(message.substr(1)));
+
+    ASSERT_EQ(1, frames.size());
+    EXPECT_EQ(body, to_string(frames[0]));
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(FramerTests, LengthPrefixMaxFrameSize){
+    event::LengthPrefixFramer framer(event::LengthPrefixFramer::U32_BE, 4);
+    collect(framer);
+
+    EXPECT_THROW(framer.feed(chunk(std::string("\0\0\0\5hello", 9))), event::FramingError);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(FramerTests, Delimiter){
+    event::DelimiterFramer framer("\n");
+    collect(framer);
+
+    auto data = chunk("one\ntwo\n\nthr");
+    framer.feed(data);
+    ASSERT_EQ(3, frames.size());
+    EXPECT_EQ("one", to_string(frames[0]));
+    EXPECT_EQ("two", to_string(frames[1]));
+    EXPECT_EQ("", to_string(frames[2]));
+    EXPECT_EQ(data->data(), frames[0]->data());
+    EXPECT_TRUE(framer.has_partial_frame());
+
+    framer.feed(chunk("ee\n"));
+    ASSERT_EQ(4, frames.size());
+    EXPECT_EQ("three", to_string(frames[3]));
+    EXPECT_FALSE(framer.has_partial_frame());
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(FramerTests, MultiByteDelimiterAcrossChunks){
+    event::DelimiterFramer framer("\r\n");
+    collect(framer);
+
+    framer.feed(chunk("GET / HTTP/1.1\r"));
+    framer.feed(chunk("\nHost: a\r\n\r"));
+    framer.feed(chunk("\n"));
+
+    ASSERT_EQ(3, frames.size());
+    EXPECT_EQ("GET / HTTP/1.1", to_string(frames[0]));
+    EXPECT_EQ("Host: a", to_string(frames[1]));
+    EXPECT_EQ("", to_string(frames[2]));
+    EXPECT_FALSE(framer.has_partial_frame());
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(FramerTests, ReadStream){
+    event::Loop loop;
+    int pipes[2];
+    ::pipe(pipes);
+
+    io::Pipe pipe(loop);
+    event::DelimiterFramer framer("\n");
+    std::vector<std::string> lines;
+    bool promise_called = false;
+
+    pipe.open(pipes[0]);
+    framer.read(pipe, [&](const buffer_ptr_t& frame){
+        lines.push_back(to_string(frame));
+    }).then([&](const std::size_t frame_count){
+        promise_called = true;
+        EXPECT_EQ(2, frame_count);
+    });
+
+    event::wait(loop, 0s).then([&](){
+        const std::string data = "first line\nsecond line\n";
+        ::write(pipes[1], data.c_str(), data.size());
+        ::close(pipes[1]);
+    });
+
+    loop.run();
+
+    EXPECT_TRUE(promise_called);
+    ASSERT_EQ(2, lines.size());
+    EXPECT_EQ("first line", lines[0]);
+    EXPECT_EQ("second line", lines[1]);
+}
+
+}
+}
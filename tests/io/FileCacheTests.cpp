@@ -0,0 +1,202 @@
+
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "lw/event.hpp"
+#include "lw/io.hpp"
+
+namespace lw {
+namespace tests {
+
+struct FileCacheTests : public testing::Test {
+    event::Loop loop;
+    std::string directory = "/tmp/liblw-filecachetests";
+    std::vector<std::string> files;
+
+    void SetUp(void) override {
+        ::mkdir(directory.c_str(), 0755);
+        for (int i = 0; i < 3; ++i) {
+            files.push_back(directory + "/file-" + std::to_string(i));
+            std::ofstream(files.back()) << "contents " << i;
+        }
+    }
+
+    void TearDown(void) override {
+        for (const auto& file : files) {
+            std::remove(file.c_str());
+        }
+        ::rmdir(directory.c_str());
+    }
+};
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(FileCacheTests, Hit){
+    io::FileCache cache(loop);
+    std::shared_ptr<io::File> first;
+    std::shared_ptr<io::File> second;
+    std::shared_ptr<io::File> concurrent;
+
+    cache.open(files[0]).then([&](std::shared_ptr<io::File>&& file){ concurrent = file; });
+    cache.open(files[0])
+        .then([&](std::shared_ptr<io::File>&& file){
+            first = file;
+            return cache.open(files[0]);
+        })
+        .then([&](std::shared_ptr<io::File>&& file){
+            second = file;
+        });
+
+    loop.run();
+
+    ASSERT_NE(nullptr, first);
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(first, concurrent);
+    EXPECT_EQ(1, cache.size());
+    EXPECT_EQ(1, cache.stats().hits);
+    EXPECT_EQ(2, cache.stats().misses);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(FileCacheTests, Evict){
+    io::FileCache::Options options;
+    options.max_files = 2;
+    io::FileCache cache(loop, options);
+    std::shared_ptr<io::File> evicted;
+    std::string contents;
+
+    cache.open(files[0])
+        .then([&](std::shared_ptr<io::File>&& file){
+            evicted = file;
+            return cache.open(files[1]);
+        })
+        .then([&](std::shared_ptr<io::File>&&){ return cache.open(files[2]); })
+        .then([&](std::shared_ptr<io::File>&&){
+            // Evicted files stay open for as long as they are in use.
+            return evicted->read_at(0, 10);
+        })
+        .then([&](memory::Buffer&& data){
+            contents = std::string((const char*)data.data(), data.size());
+        });
+
+    loop.run();
+
+    EXPECT_EQ(2, cache.size());
+    EXPECT_EQ(1, cache.stats().evictions);
+    EXPECT_EQ("contents 0", contents);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(FileCacheTests, InvalidateOnChange){
+    io::FileCache cache(loop);
+    std::shared_ptr<io::File> first;
+    std::shared_ptr<io::File> second;
+
+    cache.open(files[0])
+        .then([&](std::shared_ptr<io::File>&& file){
+            first = file;
+            std::ofstream(files[0], std::ios::app) << " and then some";
+            return event::wait(loop, std::chrono::milliseconds(50));
+        })
+        .then([&](){
+            return cache.open(files[0]);
+        })
+        .then([&](std::shared_ptr<io::File>&& file){
+            second = file;
+        });
+
+    loop.run();
+
+    ASSERT_NE(nullptr, second);
+    EXPECT_NE(first, second);
+    EXPECT_LE(1, cache.stats().invalidations);
+    EXPECT_EQ(2, cache.stats().misses);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(FileCacheTests, Modes){
+    io::FileCache cache(loop);
+    std::shared_ptr<io::File> reader;
+    std::shared_ptr<io::File> writer;
+
+    cache.open(files[1])
+        .then([&](std::shared_ptr<io::File>&& file){
+            reader = file;
+            return cache.open(files[1], std::ios::in | std::ios::out);
+        })
+        .then([&](std::shared_ptr<io::File>&& file){
+            writer = file;
+        });
+
+    loop.run();
+
+    EXPECT_NE(reader, writer);
+    EXPECT_EQ(2, cache.size());
+    cache.invalidate(files[1]);
+    EXPECT_EQ(0, cache.size());
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(FileCacheTests, Missing){
+    io::FileCache cache(loop);
+    const std::string missing = directory + "/missing";
+    bool rejected = false;
+
+    cache.open(missing).then(
+        [&](std::shared_ptr<io::File>&&){ FAIL() << "Should not open a missing file."; },
+        [&](const error::Exception&){ rejected = true; }
+    );
+
+    loop.run();
+
+    // Looking a file up does not create it.
+    EXPECT_TRUE(rejected);
+    EXPECT_EQ(0, cache.size());
+    EXPECT_NE(0, ::access(missing.c_str(), F_OK));
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(FileCacheTests, NestedDirectories){
+    io::FileCache::Options options;
+    options.max_files = 1;
+    io::FileCache cache(loop, options);
+    const std::string nested = directory + "/nested";
+    const std::string nested_file = nested + "/file";
+    ::mkdir(nested.c_str(), 0755);
+    std::ofstream(nested_file) << "contents";
+    std::shared_ptr<io::File> first;
+    std::shared_ptr<io::File> second;
+
+    // Evicting the parent's only entry must leave the child directory watched.
+    cache.open(files[0])
+        .then([&](std::shared_ptr<io::File>&&){ return cache.open(nested_file); })
+        .then([&](std::shared_ptr<io::File>&& file){
+            first = file;
+            std::ofstream(nested_file, std::ios::app) << " and then some";
+            return event::wait(loop, std::chrono::milliseconds(50));
+        })
+        .then([&](){ return cache.open(nested_file); })
+        .then([&](std::shared_ptr<io::File>&& file){ second = file; });
+
+    loop.run();
+    std::remove(nested_file.c_str());
+    ::rmdir(nested.c_str());
+
+    ASSERT_NE(nullptr, second);
+    EXPECT_NE(first, second);
+    EXPECT_EQ(1, cache.stats().evictions);
+    EXPECT_EQ(1, cache.stats().invalidations);
+}
+}
+}
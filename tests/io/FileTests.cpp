@@ -1,7 +1,17 @@
 
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
 #include <cstdio>
 #include <fstream>
+#include <functional>
 #include <gtest/gtest.h>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
 
 #include "lw/event.hpp"
 #include "lw/io.hpp"
@@ -105,5 +115,707 @@ TEST_F( FileTests, Read ){
     EXPECT_TRUE( made_it_to_the_end );
 }
 
+// -------------------------------------------------------------------------- //
+
+TEST_F( FileTests, PooledRead ){
+    memory::BufferPool pool;
+    io::File file( loop );
+    bool made_it_to_the_end = false;
+    file.allocator( &pool );
+    file
+        .open( file_name )
+        .then([&](){ return file.write( contents );                 })
+        .then([&](){ return file.read_at( 0, contents.size() );    })
+        .then([&]( memory::Buffer&& data ){
+            // The pool rounds up, but the read only reports what it was asked for.
+            EXPECT_EQ( contents, data );
+            EXPECT_EQ( memory::BufferPool::min_class_size, pool.reserved() );
+            made_it_to_the_end = true;
+            return file.close();
+        });
+    ;
+
+    loop.run();
+
+    EXPECT_TRUE( made_it_to_the_end );
+}
+
+// -------------------------------------------------------------------------- //
+
+TEST_F( FileTests, ConcurrentReads ){
+    io::File write_file( loop );
+    io::File read_file( loop );
+    std::vector< std::unique_ptr< memory::Buffer > > bytes;
+    std::size_t total_read = 0;
+    std::size_t most_in_flight = 0;
+
+    write_file
+        .open( file_name )
+        .then([&](){ return write_file.write( contents );   })
+        .then([&](){ return write_file.close();             })
+        .then([&](){ return read_file.open( file_name );    })
+        .then([&](){
+            // Each read shares the file position, so together they read every byte.
+            for( std::size_t i = 0; i < contents.size(); ++i ){
+                bytes.emplace_back( new memory::Buffer( 1 ) );
+                read_file.read( *bytes.back() ).then([&]( int size ){
+                    EXPECT_EQ( 1, size );
+                    total_read += size;
+                });
+            }
+            most_in_flight = read_file.in_flight();
+        });
+
+    loop.run();
+
+    EXPECT_EQ( contents.size(), most_in_flight );
+    EXPECT_EQ( contents.size(), total_read );
+    EXPECT_EQ( 0, read_file.in_flight() );
+
+    std::string read_str;
+    for( auto& byte : bytes ){
+        read_str.push_back( (char)byte->data()[ 0 ] );
+    }
+    std::sort( read_str.begin(), read_str.end() );
+    std::string expected_str = content_str;
+    std::sort( expected_str.begin(), expected_str.end() );
+    EXPECT_EQ( expected_str, read_str );
+}
+
+// -------------------------------------------------------------------------- //
+
+TEST_F( FileTests, PositionalReadWrite ){
+    io::File file( loop );
+    const std::size_t half = contents.size() / 2;
+    memory::Buffer front( contents.data(), half );
+    memory::Buffer back( contents.data() + half, contents.size() - half );
+    memory::Buffer front_read;
+    memory::Buffer back_read;
+    bool read_past_end = false;
+
+    // Write the halves out of order, then read them all back at once.
+    file.open( file_name )
+        .then([&](){ return file.write_at( half, back );   })
+        .then([&](){ return file.write_at( 0, front );     })
+        .then([&](){
+            file.read_at( half, back.size() ).then([&]( memory::Buffer&& data ){
+                back_read = std::move( data );
+            });
+            file.read_at( 0, half ).then([&]( memory::Buffer&& data ){
+                front_read = std::move( data );
+            });
+            file.read_at( contents.size(), 1 ).then([&]( memory::Buffer&& data ){
+                EXPECT_EQ( 0, data.size() );
+                read_past_end = true;
+            });
+        });
+
+    loop.run();
+
+    EXPECT_EQ( front, front_read );
+    EXPECT_EQ( back, back_read );
+    EXPECT_TRUE( read_past_end );
+}
+
+// -------------------------------------------------------------------------- //
+
+TEST_F( FileTests, VectoredReadWrite ){
+    io::File file( loop );
+    const std::size_t half = contents.size() / 2;
+    memory::Buffer header( contents.data(), half );
+    memory::Buffer body( contents.data() + half, contents.size() - half );
+    memory::Buffer header_read( header.size() );
+    memory::Buffer body_read( body.size() );
+    bool made_it_to_the_end = false;
+
+    file.open( file_name )
+        .then([&](){ return file.writev({ &header, &body }); })
+        .then([&]( int written ){
+            EXPECT_EQ( contents.size(), written );
+            return file.readv( 0, { &header_read, &body_read } );
+        })
+        .then([&]( int read ){
+            EXPECT_EQ( contents.size(), read );
+            EXPECT_EQ( header, header_read );
+            EXPECT_EQ( body, body_read );
+            made_it_to_the_end = true;
+        });
+
+    loop.run();
+
+    EXPECT_TRUE( made_it_to_the_end );
+}
+
+// -------------------------------------------------------------------------- //
+
+TEST_F( FileTests, WriteChain ){
+    io::File file( loop );
+    memory::BufferChain chain;
+    chain.append( memory::Buffer( contents.begin() + 5, contents.end() ) );
+    chain.prepend( memory::Buffer( contents.begin(), contents.begin() + 5 ) );
+    memory::Buffer read( contents.size() );
+    int written = 0;
+
+    file.open( file_name )
+        .then([&](){ return file.writev( 0, chain ); })
+        .then([&]( int bytes ){
+            written = bytes;
+            return file.read_at( 0, read );
+        });
+
+    loop.run();
+
+    EXPECT_EQ( contents.size(), written );
+    EXPECT_EQ( contents, read );
+}
+
+// -------------------------------------------------------------------------- //
+
+TEST_F( FileTests, ReadStream ){
+    const std::size_t chunk_size = 64;
+    memory::Buffer large( chunk_size * 20 + 13 );
+    for( std::size_t i = 0; i < large.size(); ++i ){
+        large[ i ] = (memory::byte)( i * 7 );
+    }
+
+    io::File file( loop );
+    std::vector< io::File::buffer_ptr_t > chunks;
+    std::uint64_t total = 0;
+
+    file.open( file_name )
+        .then([&](){ return file.write( large ); })
+        .then([&](){
+            return file.read_stream( chunk_size, 4, [&]( io::File::buffer_ptr_t chunk ){
+                EXPECT_LE( chunk->size(), chunk_size );
+                chunks.push_back( chunk );
+            });
+        })
+        .then([&]( std::uint64_t bytes ){
+            total = bytes;
+        });
+
+    loop.run();
+
+    EXPECT_EQ( large.size(), total );
+    ASSERT_EQ( 21, chunks.size() );
+
+    memory::Buffer joined( large.size() );
+    std::size_t offset = 0;
+    for( auto& chunk : chunks ){
+        std::copy( chunk->begin(), chunk->end(), joined.begin() + offset );
+        offset += chunk->size();
+    }
+    EXPECT_EQ( large, joined );
+}
+
+// -------------------------------------------------------------------------- //
+
+TEST_F( FileTests, ReadStreamEmpty ){
+    io::File file( loop );
+    bool finished = false;
+
+    file.open( file_name, std::ios::in | std::ios::out | std::ios::trunc )
+        .then([&](){
+            return file.read_stream( 64, 4, [&]( io::File::buffer_ptr_t ){
+                FAIL() << "An empty file has no chunks.";
+            });
+        })
+        .then([&]( std::uint64_t bytes ){
+            EXPECT_EQ( 0, bytes );
+            finished = true;
+        });
+
+    loop.run();
+
+    EXPECT_TRUE( finished );
+}
+
+// -------------------------------------------------------------------------- //
+
+TEST_F( FileTests, Digest ){
+    memory::Buffer large( 64 * 10 + 5 );
+    for( std::size_t i = 0; i < large.size(); ++i ){
+        large[ i ] = (memory::byte)( i * 13 );
+    }
+    const std::uint32_t expected = memory::Crc32c::compute( large.data(), large.size() );
+
+    io::File file( loop );
+    io::File reader( loop );
+    auto written = std::make_shared< memory::Crc32c >();
+    auto read = std::make_shared< memory::Crc32c >();
+    io::File::StreamDigest streamed = { 0, 0 };
+
+    file.open( file_name, std::ios::in | std::ios::out | std::ios::trunc )
+        .then([&](){
+            file.digest_writes( written );
+            return file.write( large );
+        })
+        .then([&](){
+            return file.read_stream_digest( 64, 4, []( io::File::buffer_ptr_t ){} );
+        })
+        .then([&]( io::File::StreamDigest&& result ){
+            streamed = result;
+            return reader.open( file_name );
+        })
+        .then([&](){
+            // Positional reads leave the checksum alone.
+            reader.digest_reads( read );
+            return reader.read_at( 0, large.size() );
+        })
+        .then([&]( memory::Buffer&& ){
+            return reader.read( large.size() );
+        });
+
+    loop.run();
+
+    EXPECT_EQ( expected, written->value() );
+    EXPECT_EQ( large.size(), streamed.bytes );
+    EXPECT_EQ( expected, streamed.crc32c );
+    EXPECT_EQ( expected, read->value() );
+}
+
+// -------------------------------------------------------------------------- //
+
+TEST_F( FileTests, DigestOverlap ){
+    io::File file( loop );
+    auto digest = std::make_shared< memory::Crc32c >();
+    bool refused = false;
+    std::size_t bytes_read = 0;
+
+    file.open( file_name )
+        .then([&](){ return file.write_at( 0, contents ); })
+        .then([&](){
+            // The second read could complete first and checksum out of order.
+            file.digest_reads( digest );
+            auto first = file.read( 5 );
+            try {
+                file.read( 5 );
+            }
+            catch( const io::FileError& ){
+                refused = true;
+            }
+            return first;
+        })
+        .then([&]( memory::Buffer&& data ){
+            bytes_read = data.size();
+
+            // Once the first is done, the next may start.
+            return file.read( contents.size() );
+        })
+        .then([&]( memory::Buffer&& data ){
+            bytes_read += data.size();
+        });
+
+    loop.run();
+
+    EXPECT_TRUE( refused );
+    EXPECT_EQ( contents.size(), bytes_read );
+    EXPECT_EQ(
+        memory::Crc32c::compute( contents.data(), contents.size() ),
+        digest->value()
+    );
+}
+
+// -------------------------------------------------------------------------- //
+
+TEST_F( FileTests, Sync ){
+    io::File file( loop );
+    bool synced = false;
+
+    file.open( file_name )
+        .then([&](){ return file.write( contents ); })
+        .then([&](){ return file.sync();            })
+        .then([&](){ return file.datasync();        })
+        .then([&](){ synced = true;                 })
+    ;
+
+    loop.run();
+
+    EXPECT_TRUE( synced );
+}
+
+// -------------------------------------------------------------------------- //
+
+TEST_F( FileTests, Uring ){
+    auto uring = io::Uring::create( loop );
+    if( !uring ){
+        // Kernels without io_uring have nothing to check, so note why in the results.
+        RecordProperty( "skipped", "io_uring is unavailable" );
+        return;
+    }
+
+    const std::size_t chunk_size = 64;
+    memory::Buffer large( chunk_size * 32 );
+    for( std::size_t i = 0; i < large.size(); ++i ){
+        large[ i ] = (memory::byte)( i * 7 );
+    }
+
+    io::File file( loop, uring );
+    memory::Buffer joined( large.size() );
+    std::size_t offset = 0;
+    std::uint64_t total = 0;
+
+    file.open( file_name )
+        .then([&](){ return file.write_at( 0, large ); })
+        .then([&](){
+            return file.read_stream( chunk_size, 16, [&]( io::File::buffer_ptr_t chunk ){
+                std::copy( chunk->begin(), chunk->end(), joined.begin() + offset );
+                offset += chunk->size();
+            });
+        })
+        .then([&]( std::uint64_t bytes ){
+            total = bytes;
+            return file.close();
+        });
+
+    loop.run();
+
+    EXPECT_EQ( large.size(), total );
+    EXPECT_EQ( large, joined );
+    EXPECT_EQ( 0, uring->in_flight() );
+
+    // The stream queues reads several at a time, so they share submissions.
+    EXPECT_LT( uring->submit_calls(), 32 );
+}
+
+// -------------------------------------------------------------------------- //
+
+/// @brief Compares random 4 KiB direct reads through io_uring against the
+/// threadpool, over a range of queue depths.
+///
+/// Timings are machine dependent, so this only runs when asked for with
+/// `--gtest_also_run_disabled_tests`.
+TEST_F( FileTests, DISABLED_UringBenchmark ){
+    auto uring = io::Uring::create( loop );
+    if( !uring ){
+        RecordProperty( "skipped", "io_uring is unavailable" );
+        return;
+    }
+
+    // Direct reads skip the page cache, so every one of them goes to the disk.
+    const std::size_t file_size = 256 * 1024 * 1024;
+    const std::size_t block_size = io::File::direct_alignment;
+    const std::size_t read_count = 8192;
+    const std::size_t depths[] = { 1, 4, 16, 64, 256 };
+    typedef std::chrono::steady_clock clock;
+
+    memory::Buffer block( 1024 * 1024 );
+    block.set_memory( 0x5a );
+    {
+        io::File file( loop );
+        file.open( file_name ).then([&](){
+            auto write = file.write_at( 0, block );
+            const std::size_t step = block.size();
+            for( std::size_t offset = step; offset < file_size; offset += step ){
+                write = write.then([&, offset](){
+                    return file.write_at( offset, block );
+                });
+            }
+            return write;
+        })
+        .then([&](){ return file.close(); });
+        loop.run();
+    }
+
+    auto simulate = [&](
+        const std::shared_ptr< io::Uring >& ring,
+        const std::size_t depth
+    ){
+        io::File file( loop, ring );
+        std::vector< memory::Buffer > buffers;
+        std::size_t issued = 0;
+        std::size_t completed = 0;
+        std::mt19937 random( 42 );
+        std::uniform_int_distribution< std::size_t > pick(
+            0,
+            file_size / block_size - 1
+        );
+
+        // Each buffer always has one read in flight until the count is met.
+        std::function< void( memory::Buffer& ) > issue;
+        issue = [&]( memory::Buffer& buffer ){
+            if( issued == read_count ){
+                return;
+            }
+            ++issued;
+            file.read_at( pick( random ) * block_size, buffer ).then(
+                [&]( int bytes ){
+                    EXPECT_EQ( (int)block_size, bytes );
+                    if( ++completed == read_count ){
+                        file.close();
+                    }
+                    issue( buffer );
+                }
+            );
+        };
+
+        clock::time_point start;
+        file.open( file_name, std::ios::in, io::File::DIRECT ).then([&](){
+            buffers.reserve( depth );
+            for( std::size_t i = 0; i < depth; ++i ){
+                buffers.emplace_back( file.allocate( block_size ) );
+            }
+            start = clock::now();
+            for( auto& buffer : buffers ){
+                issue( buffer );
+            }
+        });
+        loop.run();
+        const auto elapsed = std::chrono::duration_cast< std::chrono::microseconds >(
+            clock::now() - start
+        ).count();
+        EXPECT_EQ( read_count, completed );
+
+        std::cout
+            << ( ring ? "io_uring   " : "threadpool " )
+            << "depth " << depth << ": " << elapsed << "us, "
+            << (std::int64_t)read_count * 1000000 / std::max< std::int64_t >( elapsed, 1 )
+            << " reads/s" << std::endl;
+    };
+
+    for( const std::size_t depth : depths ){
+        simulate( nullptr, depth );
+        simulate( uring, depth );
+    }
+}
+
+// -------------------------------------------------------------------------- //
+
+TEST_F( FileTests, Direct ){
+    io::File file( loop );
+    memory::Buffer written;
+    memory::Buffer read;
+
+    file.open( file_name, std::ios::in | std::ios::out, io::File::DIRECT )
+        .then([&](){
+            written = file.allocate( 100 );
+            EXPECT_EQ( io::File::direct_alignment, written.size() );
+            for( std::size_t i = 0; i < written.size(); ++i ){
+                written[ i ] = (memory::byte)i;
+            }
+            return file.write_at( io::File::direct_alignment, written );
+        })
+        .then([&](){
+            return file.read_at( io::File::direct_alignment, written.size() );
+        })
+        .then([&]( memory::Buffer&& data ){
+            read = std::move( data );
+            return file.close();
+        });
+
+    loop.run();
+
+    EXPECT_EQ( written, read );
+}
+
+// -------------------------------------------------------------------------- //
+
+TEST_F( FileTests, DirectMisaligned ){
+    io::File file( loop );
+    memory::Buffer aligned;
+    bool checked = false;
+
+    file.open( file_name, std::ios::in | std::ios::out, io::File::DIRECT )
+        .then([&](){
+            aligned = file.allocate( io::File::direct_alignment * 2 );
+            memory::Buffer bad_address( aligned.data() + 1, io::File::direct_alignment );
+            memory::Buffer bad_length( aligned.data(), 100 );
+
+            // Mistakes are caught before anything is submitted.
+            EXPECT_THROW( file.write_at( 0, bad_address ), io::FileError );
+            EXPECT_THROW( file.write_at( 0, bad_length ), io::FileError );
+            EXPECT_THROW( file.write_at( 1, aligned ), io::FileError );
+            EXPECT_THROW(
+                file.read_stream( 100, 1, []( io::File::buffer_ptr_t ){} ),
+                io::FileError
+            );
+            EXPECT_EQ( 0, file.in_flight() );
+            checked = true;
+            return file.close();
+        });
+
+    loop.run();
+
+    EXPECT_TRUE( checked );
+}
+
+// -------------------------------------------------------------------------- //
+
+TEST_F( FileTests, SendTo ){
+    // Bigger than a pipe's buffer and a send chunk, so the send has to wait.
+    memory::Buffer large( 3 * 1024 * 1024 + 100 );
+    for( std::size_t i = 0; i < large.size(); ++i ){
+        large[ i ] = (memory::byte)( i * 13 );
+    }
+
+    int pipe_fds[ 2 ];
+    ASSERT_EQ( 0, ::pipe( pipe_fds ) );
+    io::Pipe reader( loop );
+    io::Pipe writer( loop );
+    reader.open( pipe_fds[ 0 ] );
+    writer.open( pipe_fds[ 1 ] );
+
+    const std::uint64_t offset = 100;
+    const std::uint64_t length = large.size() - offset;
+    memory::Buffer received( length );
+    std::size_t received_size = 0;
+    std::uint64_t sent = 0;
+    std::uint64_t last_progress = 0;
+    int progress_calls = 0;
+
+    reader.read([&]( io::Pipe::buffer_ptr_t chunk ){
+        std::copy( chunk->begin(), chunk->end(), received.begin() + received_size );
+        received_size += chunk->size();
+        if( received_size == length ){
+            reader.stop_read();
+        }
+    });
+
+    io::File file( loop );
+    file.open( file_name )
+        .then([&](){ return file.write( large ); })
+        .then([&](){
+            return file.send_to( writer, offset, length, [&]( std::uint64_t bytes ){
+                EXPECT_GT( bytes, last_progress );
+                last_progress = bytes;
+                ++progress_calls;
+            });
+        })
+        .then([&]( std::uint64_t bytes ){
+            sent = bytes;
+        });
+
+    loop.run();
+
+    EXPECT_EQ( length, sent );
+    EXPECT_EQ( length, last_progress );
+    EXPECT_LT( 1, progress_calls );
+    ASSERT_EQ( length, received_size );
+    EXPECT_EQ( memory::Buffer( large.data() + offset, length ), received );
+}
+
+// -------------------------------------------------------------------------- //
+
+TEST_F( FileTests, SendToWaitLeavesThreadpoolFree ){
+    // More stalled sends than the threadpool has workers.
+    const int send_count = 8;
+    memory::Buffer large( 256 * 1024 );
+    large.set_memory( 0x42 );
+
+    io::File file( loop );
+    std::vector< std::unique_ptr< io::Pipe > > readers;
+    std::vector< std::unique_ptr< io::Pipe > > writers;
+    std::vector< std::size_t > received( send_count, 0 );
+    int finished = 0;
+    bool work_done = false;
+
+    file.open( file_name )
+        .then([&](){ return file.write( large ); })
+        .then([&](){
+            for( int i = 0; i < send_count; ++i ){
+                int pipe_fds[ 2 ];
+                EXPECT_EQ( 0, ::pipe( pipe_fds ) );
+                readers.emplace_back( new io::Pipe( loop ) );
+                readers.back()->open( pipe_fds[ 0 ] );
+                writers.emplace_back( new io::Pipe( loop ) );
+                writers.back()->open( pipe_fds[ 1 ] );
+                file.send_to( *writers.back(), 0, large.size() )
+                    .then([&]( std::uint64_t bytes ){
+                        EXPECT_EQ( large.size(), bytes );
+                        ++finished;
+                    });
+            }
+
+            // Nobody is reading, so every send is waiting for its pipe.
+            return io::open( loop, file_name + "-other" );
+        })
+        .then([&]( std::shared_ptr< io::File > other ){
+            return other->close().then([ other ](){});
+        })
+        .then([&](){
+            work_done = true;
+            EXPECT_EQ( 0, finished );
+            for( int i = 0; i < send_count; ++i ){
+                readers[ i ]->read([&, i]( io::Pipe::buffer_ptr_t chunk ){
+                    received[ i ] += chunk->size();
+                    if( received[ i ] == large.size() ){
+                        readers[ i ]->stop_read();
+                    }
+                });
+            }
+        });
+
+    loop.run();
+    std::remove( ( file_name + "-other" ).c_str() );
+
+    EXPECT_TRUE( work_done );
+    EXPECT_EQ( send_count, finished );
+    for( const std::size_t size : received ){
+        EXPECT_EQ( large.size(), size );
+    }
+}
+
+// -------------------------------------------------------------------------- //
+
+TEST_F( FileTests, CopyFile ){
+    const std::string copy_name = file_name + "-copy";
+    memory::Buffer large( 1024 * 1024 );
+    for( std::size_t i = 0; i < large.size(); ++i ){
+        large[ i ] = (memory::byte)( i * 29 );
+    }
+
+    io::File file( loop );
+    std::uint64_t copied = 0;
+    std::uint64_t last_progress = 0;
+    memory::Buffer copy;
+
+    file.open( file_name )
+        .then([&](){ return file.write( large ); })
+        .then([&](){ return file.close(); })
+        .then([&](){
+            return io::copy_file( loop, file_name, copy_name, [&]( std::uint64_t bytes ){
+                last_progress = bytes;
+            });
+        })
+        .then([&]( std::uint64_t bytes ){
+            copied = bytes;
+            return io::open( loop, copy_name, std::ios::in );
+        })
+        .then([&]( std::shared_ptr< io::File > copy_file ){
+            return copy_file->read( large.size() + 1 ).then([ copy_file ]( memory::Buffer&& data ){
+                return std::move( data );
+            });
+        })
+        .then([&]( memory::Buffer&& data ){
+            copy = std::move( data );
+        });
+
+    loop.run();
+    std::remove( copy_name.c_str() );
+
+    EXPECT_EQ( large.size(), copied );
+    EXPECT_EQ( large.size(), last_progress );
+    EXPECT_EQ( large, copy );
+}
+
+// -------------------------------------------------------------------------- //
+
+TEST_F( FileTests, CopyMissingFile ){
+    const std::string copy_name = file_name + "-copy";
+    bool rejected = false;
+
+    io::copy_file( loop, file_name, copy_name ).then(
+        [&]( std::uint64_t ){ FAIL() << "Should not copy a missing file."; },
+        [&]( const error::Exception& ){ rejected = true; }
+    );
+
+    loop.run();
+
+    // Neither side of the copy is created along the way.
+    EXPECT_TRUE( rejected );
+    EXPECT_NE( 0, ::access( file_name.c_str(), F_OK ) );
+    EXPECT_NE( 0, ::access( copy_name.c_str(), F_OK ) );
+    std::remove( copy_name.c_str() );
+}
 }
 }
@@ -0,0 +1,185 @@
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "lw/event.hpp"
+#include "lw/io.hpp"
+
+namespace lw {
+namespace tests {
+
+struct FilesystemTests : public testing::Test {
+    event::Loop loop;
+    std::string root = "/tmp/liblw-filesystemtests";
+    std::vector<std::string> files;
+    std::vector<std::string> directories;
+
+    void SetUp(void) override {
+        directories = {root, root + "/a", root + "/a/b", root + "/c"};
+        for (const auto& directory : directories) {
+            ::mkdir(directory.c_str(), 0755);
+        }
+
+        // Enough files to need several batches.
+        for (const auto& directory : directories) {
+            for (int i = 0; i < 10; ++i) {
+                files.push_back(directory + "/file-" + std::to_string(i));
+                std::ofstream(files.back()) << "contents " << i;
+            }
+        }
+    }
+
+    void TearDown(void) override {
+        for (const auto& file : files) {
+            std::remove(file.c_str());
+        }
+        for (auto it = directories.rbegin(); it != directories.rend(); ++it) {
+            ::rmdir(it->c_str());
+        }
+    }
+};
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(FilesystemTests, Stat){
+    const std::string link = root + "/link";
+    ASSERT_EQ(0, ::symlink(files[0].c_str(), link.c_str()));
+    io::Stat file_info;
+    io::Stat link_info;
+    io::Stat followed_info;
+    bool missing = false;
+
+    io::stat(loop, files[0])
+        .then([&](io::Stat&& info){
+            file_info = info;
+            return io::lstat(loop, link);
+        })
+        .then([&](io::Stat&& info){
+            link_info = info;
+            return io::stat(loop, link);
+        })
+        .then([&](io::Stat&& info){
+            followed_info = info;
+            return io::stat(loop, root + "/missing");
+        })
+        .then(
+            [&](io::Stat&&){},
+            [&](const error::Exception&){ missing = true; }
+        );
+
+    loop.run();
+    std::remove(link.c_str());
+
+    EXPECT_TRUE(file_info.is_file());
+    EXPECT_EQ(std::string("contents 0").size(), file_info.size);
+    EXPECT_TRUE(link_info.is_symlink());
+    EXPECT_TRUE(followed_info.is_file());
+    EXPECT_EQ(file_info.inode, followed_info.inode);
+    EXPECT_TRUE(missing);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(FilesystemTests, Scandir){
+    std::vector<io::DirectoryEntry> entries;
+
+    io::scandir(loop, root + "/a").then([&](std::vector<io::DirectoryEntry>&& scanned){
+        entries = std::move(scanned);
+    });
+
+    loop.run();
+
+    ASSERT_EQ(11, entries.size());
+    std::sort(entries.begin(), entries.end(), [](const auto& lhs, const auto& rhs){
+        return lhs.name < rhs.name;
+    });
+    EXPECT_EQ("b", entries[0].name);
+    EXPECT_EQ(io::DirectoryEntry::DIRECTORY, entries[0].type);
+    EXPECT_EQ("file-0", entries[1].name);
+    EXPECT_EQ(io::DirectoryEntry::FILE, entries[1].type);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(FilesystemTests, Walk){
+    io::WalkOptions options;
+    options.max_in_flight = 2;
+    options.batch_size = 8;
+    std::vector<std::string> visited;
+    std::size_t batches = 0;
+    std::uint64_t total = 0;
+
+    io::walk(loop, root, [&](const std::vector<io::DirectoryEntry>& entries){
+        EXPECT_GE(options.batch_size, entries.size());
+        ++batches;
+        for (const auto& entry : entries) {
+            visited.push_back(entry.name);
+        }
+    }, options).then([&](std::uint64_t count){
+        total = count;
+    });
+
+    loop.run();
+
+    // Everything but the root itself is visited exactly once.
+    std::vector<std::string> expected(files);
+    expected.insert(expected.end(), directories.begin() + 1, directories.end());
+    std::sort(expected.begin(), expected.end());
+    std::sort(visited.begin(), visited.end());
+    EXPECT_EQ(expected, visited);
+    EXPECT_EQ(expected.size(), total);
+    EXPECT_EQ((expected.size() + options.batch_size - 1) / options.batch_size, batches);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(FilesystemTests, WalkDanglingLink){
+    const std::string link = root + "/a/dangling";
+    ASSERT_EQ(0, ::symlink((root + "/missing").c_str(), link.c_str()));
+    io::WalkOptions options;
+    options.follow_links = true;
+    std::vector<io::DirectoryEntry> visited;
+    std::uint64_t total = 0;
+
+    io::walk(loop, root, [&](const std::vector<io::DirectoryEntry>& entries){
+        visited.insert(visited.end(), entries.begin(), entries.end());
+    }, options).then(
+        [&](std::uint64_t count){ total = count; },
+        [&](const error::Exception&){ FAIL() << "A dangling link should not end the walk."; }
+    );
+
+    loop.run();
+    std::remove(link.c_str());
+
+    // Everything below the root is still visited, along with the link itself.
+    EXPECT_EQ(files.size() + (directories.size() - 1) + 1, total);
+    auto found = std::find_if(visited.begin(), visited.end(), [&](const io::DirectoryEntry& entry){
+        return entry.name == link;
+    });
+    ASSERT_NE(visited.end(), found);
+    EXPECT_EQ(io::DirectoryEntry::LINK, found->type);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(FilesystemTests, WalkMissing){
+    bool failed = false;
+
+    io::walk(loop, root + "/missing", [](const std::vector<io::DirectoryEntry>&){}).then(
+        [](std::uint64_t){},
+        [&](const error::Exception&){ failed = true; }
+    );
+
+    loop.run();
+
+    EXPECT_TRUE(failed);
+}
+
+}
+}
@@ -0,0 +1,190 @@
+
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "lw/event.hpp"
+#include "lw/io.hpp"
+#include "lw/memory.hpp"
+
+namespace lw {
+namespace tests {
+
+struct GroupCommitWriterTests : public testing::Test {
+    event::Loop loop;
+    io::File file;
+    std::string file_name = "/tmp/liblw-groupcommitwritertests-testfile";
+
+    GroupCommitWriterTests(void):
+        file(loop)
+    {}
+
+    void TearDown(void){
+        std::remove(file_name.c_str());
+    }
+
+    io::GroupCommitWriter::buffer_ptr_t make_record(const int i){
+        const std::string str = "record " + std::to_string(i) + "\n";
+        return std::make_shared<memory::Buffer>(str.begin(), str.end());
+    }
+
+    std::string read_file(void){
+        std::ifstream in(file_name);
+        std::stringstream contents;
+        contents << in.rdbuf();
+        return contents.str();
+    }
+};
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(GroupCommitWriterTests, SingleGroup){
+    const int record_count = 50;
+    io::GroupCommitWriter writer(loop, file);
+    std::string expected;
+    int committed = 0;
+
+    file.open(file_name, std::ios::out | std::ios::trunc | std::ios::app).then([&](){
+        for (int i = 0; i < record_count; ++i) {
+            auto record = make_record(i);
+            expected.append((const char*)record->data(), record->size());
+            writer.append(record).then([&](){ ++committed; });
+        }
+    });
+
+    loop.run();
+
+    EXPECT_EQ(record_count, committed);
+    EXPECT_EQ(1, writer.commits());
+    EXPECT_EQ(expected, read_file());
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(GroupCommitWriterTests, MaxBatch){
+    const int record_count = 50;
+    io::GroupCommitWriter::Options options;
+    options.max_batch = 10;
+    io::GroupCommitWriter writer(loop, file, options);
+    std::string expected;
+    int committed = 0;
+
+    file.open(file_name, std::ios::out | std::ios::trunc | std::ios::app).then([&](){
+        for (int i = 0; i < record_count; ++i) {
+            auto record = make_record(i);
+            expected.append((const char*)record->data(), record->size());
+            writer.append(record).then([&, i](){
+                // Groups commit in order, so records do too.
+                EXPECT_EQ(committed, i);
+                ++committed;
+            });
+        }
+    });
+
+    loop.run();
+
+    EXPECT_EQ(record_count, committed);
+    EXPECT_EQ(5, writer.commits());
+    EXPECT_EQ(expected, read_file());
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(GroupCommitWriterTests, Window){
+    io::GroupCommitWriter::Options options;
+    options.window = std::chrono::milliseconds(20);
+    io::GroupCommitWriter writer(loop, file, options);
+    int committed = 0;
+
+    // Appends spread across the window still land in one group.
+    file.open(file_name, std::ios::out | std::ios::trunc | std::ios::app)
+        .then([&](){
+            writer.append(make_record(0)).then([&](){ ++committed; });
+            return event::wait(loop, std::chrono::milliseconds(5));
+        })
+        .then([&](){
+            writer.append(make_record(1)).then([&](){ ++committed; });
+        });
+
+    loop.run();
+
+    EXPECT_EQ(2, committed);
+    EXPECT_EQ(1, writer.commits());
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(GroupCommitWriterTests, RefusedGroup){
+    io::GroupCommitWriter writer(loop, file);
+    bool refused = false;
+    bool committed = false;
+    memory::Buffer aligned;
+
+    // A misaligned record on a direct file never reaches the disk, so later groups still commit.
+    file.open(file_name, std::ios::out | std::ios::trunc, io::File::DIRECT)
+        .then([&](){
+            return writer.append(make_record(0));
+        })
+        .then(
+            [&](){ return file.close(); },
+            [&](const error::Exception&){
+                refused = true;
+                aligned = file.allocate(io::File::direct_alignment);
+                aligned.set_memory('a');
+                auto record = std::make_shared<memory::Buffer>(aligned.data(), aligned.size());
+                return writer.append(record).then([&](){
+                    committed = true;
+                    return file.close();
+                });
+            }
+        );
+
+    loop.run();
+
+    EXPECT_TRUE(refused);
+    EXPECT_TRUE(committed);
+    EXPECT_FALSE(writer.failed());
+    EXPECT_EQ(1, writer.commits());
+    EXPECT_EQ(std::string(io::File::direct_alignment, 'a'), read_file());
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(GroupCommitWriterTests, FailedCommit){
+    io::GroupCommitWriter::Options options;
+    options.max_batch = 1;
+    io::GroupCommitWriter writer(loop, file, options);
+    int rejected = 0;
+    bool rejected_later = false;
+
+    // A read-only file fails the first write, taking the queued record down with it.
+    file.open(file_name, std::ios::in).then([&](){
+        writer.append(make_record(0)).then(
+            [&](){ FAIL() << "Should not commit to a read-only file."; },
+            [&](const error::Exception&){
+                ++rejected;
+                EXPECT_TRUE(writer.failed());
+                writer.append(make_record(2)).then(
+                    [&](){ FAIL() << "Should not commit after a failure."; },
+                    [&](const error::Exception&){ rejected_later = true; }
+                );
+            }
+        );
+        writer.append(make_record(1)).then(
+            [&](){ FAIL() << "Should not commit to a read-only file."; },
+            [&](const error::Exception&){ ++rejected; }
+        );
+    });
+
+    loop.run();
+
+    EXPECT_EQ(2, rejected);
+    EXPECT_TRUE(rejected_later);
+    EXPECT_EQ(0, writer.commits());
+    EXPECT_EQ("", read_file());
+}
+}
+}
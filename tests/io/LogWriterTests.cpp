@@ -0,0 +1,203 @@
+
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <csignal>
+#include <string>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "lw/event.hpp"
+#include "lw/io.hpp"
+#include "lw/memory.hpp"
+
+namespace lw {
+namespace tests {
+
+struct LogWriterTests : public testing::Test {
+    event::Loop loop;
+    std::string path = "/tmp/liblw-logwritertests-log";
+
+    void TearDown(void){
+        for (int i = 0; i < 10; ++i) {
+            char suffix[32];
+            std::snprintf(suffix, sizeof(suffix), ".%06d", i);
+            std::remove((path + suffix).c_str());
+        }
+    }
+
+    std::string read_file(const std::string& file_name){
+        std::ifstream in(file_name);
+        std::stringstream contents;
+        contents << in.rdbuf();
+        return contents.str();
+    }
+};
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(LogWriterTests, WriteAndClose){
+    io::LogWriter writer(loop, path);
+    std::string expected;
+    bool closed = false;
+
+    writer.open()
+        .then([&](){
+            for (int i = 0; i < 100; ++i) {
+                const std::string record = "record " + std::to_string(i) + "\n";
+                writer.write(record.data(), record.size());
+                expected += record;
+            }
+            return writer.close();
+        })
+        .then([&](){
+            closed = true;
+        });
+
+    loop.run();
+
+    EXPECT_TRUE(closed);
+    EXPECT_EQ(0, writer.segment());
+    EXPECT_EQ(expected, read_file(writer.segment_path(0)));
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(LogWriterTests, FlushOnInterval){
+    io::LogWriter::Options options;
+    options.flush_interval = std::chrono::milliseconds(5);
+    io::LogWriter writer(loop, path, options);
+    const std::string record = "hello";
+    std::string flushed;
+
+    // Nothing asks for a flush, so only the timer can have written the record.
+    writer.open()
+        .then([&](){
+            writer.write(record.data(), record.size());
+            return event::wait(loop, std::chrono::milliseconds(50));
+        })
+        .then([&](){
+            flushed = read_file(writer.segment_path(0));
+            return writer.close();
+        });
+
+    loop.run();
+
+    EXPECT_EQ(record, flushed);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(LogWriterTests, Rotate){
+    io::LogWriter::Options options;
+    options.buffer_size = 32;
+    options.segment_size = 100;
+    options.preallocate = 4096;
+    io::LogWriter writer(loop, path, options);
+    std::string expected;
+
+    writer.open()
+        .then([&](){
+            for (int i = 0; i < 10; ++i) {
+                memory::Buffer record(30);
+                for (auto& byte : record) {
+                    byte = (memory::byte)('a' + i);
+                }
+                writer.write(record);
+                expected.append((const char*)record.data(), record.size());
+            }
+            return writer.flush();
+        })
+        .then([&](){
+            return writer.close();
+        });
+
+    loop.run();
+
+    // Preallocation must not show up in the size of a segment.
+    EXPECT_LE(1, writer.segment());
+    std::string joined;
+    for (std::size_t i = 0; i <= writer.segment(); ++i) {
+        const std::string segment = read_file(writer.segment_path(i));
+        if (i < writer.segment()) {
+            EXPECT_LE(options.segment_size, segment.size());
+        }
+        joined += segment;
+    }
+    EXPECT_EQ(expected, joined);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(LogWriterTests, FailedFlush){
+    // Every write to the first segment fails with ENOSPC.
+    ASSERT_EQ(0, ::symlink("/dev/full", (path + ".000000").c_str()));
+    io::LogWriter writer(loop, path);
+    const std::string record = "record";
+    int rejected = 0;
+
+    writer.open().then([&](){
+        writer.write(record.data(), record.size());
+        writer.flush().then(
+            [&](){ FAIL() << "Should not flush to a full device."; },
+            [&](const error::Exception&){
+                ++rejected;
+
+                // The failed bytes are still buffered, so closing retries them instead of
+                // waiting for a write that will never happen.
+                writer.close().then(
+                    [&](){ FAIL() << "Should not flush to a full device."; },
+                    [&](const error::Exception&){ ++rejected; }
+                );
+            }
+        );
+    });
+
+    loop.run();
+
+    EXPECT_EQ(2, rejected);
+}
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(LogWriterTests, ShortWrite){
+    // Past the size limit a write is cut short, and the one after that fails with EFBIG.
+    const std::string record(150, 'x');
+    ::rlimit original;
+    ASSERT_EQ(0, ::getrlimit(RLIMIT_FSIZE, &original));
+    ::rlimit limited = original;
+    limited.rlim_cur = 100;
+    auto old_handler = std::signal(SIGXFSZ, SIG_IGN);
+
+    io::LogWriter writer(loop, path);
+    std::string partial;
+    bool closed = false;
+    writer.open().then([&](){
+        ASSERT_EQ(0, ::setrlimit(RLIMIT_FSIZE, &limited));
+        writer.write(record.data(), record.size());
+        writer.flush().then(
+            [&](){ FAIL() << "Should not flush past the size limit."; },
+            [&](const error::Exception&){
+                // Only what the kernel took is in the file, and the flush did not claim the rest.
+                ::setrlimit(RLIMIT_FSIZE, &original);
+                partial = read_file(path + ".000000");
+
+                // Without the limit the rest goes out on close, and closing again does nothing.
+                writer.close()
+                    .then([&](){ return writer.close(); })
+                    .then([&](){ closed = true; });
+            }
+        );
+    });
+
+    loop.run();
+    ::setrlimit(RLIMIT_FSIZE, &original);
+    std::signal(SIGXFSZ, old_handler);
+
+    EXPECT_EQ(record.substr(0, 100), partial);
+    EXPECT_TRUE(closed);
+    EXPECT_EQ(record, read_file(path + ".000000"));
+}
+
+}
+}
@@ -0,0 +1,114 @@
+
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+
+#include "lw/event.hpp"
+#include "lw/io.hpp"
+#include "lw/memory.hpp"
+
+namespace lw {
+namespace tests {
+
+struct MappedFileTests : public testing::Test {
+    event::Loop loop;
+    std::string file_name = "/tmp/liblw-mappedfiletests-testfile";
+    std::string content_str;
+
+    void SetUp(void){
+        // Spread the content over several pages so offsets cross page boundaries.
+        for (int i = 0; content_str.size() < 3 * 4096 + 100; ++i) {
+            content_str += "line " + std::to_string(i) + "\n";
+        }
+        std::ofstream out(file_name);
+        out << content_str;
+    }
+
+    void TearDown(void){
+        std::remove(file_name.c_str());
+    }
+};
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(MappedFileTests, Map){
+    io::File file(loop);
+    std::shared_ptr<io::MappedFile> mapping;
+
+    file.open(file_name, std::ios::in).then([&](){
+        mapping = file.map();
+        return file.close();
+    });
+
+    loop.run();
+
+    ASSERT_TRUE((bool)mapping);
+    EXPECT_EQ(content_str.size(), mapping->size());
+    EXPECT_EQ(
+        memory::Buffer(content_str.begin(), content_str.end()),
+        mapping->buffer()
+    );
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(MappedFileTests, UnalignedOffset){
+    io::File file(loop);
+    const std::size_t offset = 4096 + 17;
+    const std::size_t length = 5000;
+    io::MappedFile::buffer_ptr_t view;
+
+    file.open(file_name, std::ios::in).then([&](){
+        // The view should keep the mapping alive after the mapping itself is dropped.
+        view = file.map(offset, length)->view(10, 100);
+    });
+
+    loop.run();
+
+    ASSERT_TRUE((bool)view);
+    const auto begin = content_str.begin() + offset + 10;
+    EXPECT_EQ(memory::Buffer(begin, begin + 100), *view);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(MappedFileTests, BadRanges){
+    io::File file(loop);
+
+    file.open(file_name, std::ios::in).then([&](){
+        EXPECT_THROW(file.map(content_str.size()), io::FileError);
+
+        auto mapping = file.map(0, 100);
+        EXPECT_THROW(mapping->view(101), io::FileError);
+        EXPECT_THROW(mapping->view(50, 51), io::FileError);
+    });
+
+    loop.run();
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(MappedFileTests, AdviseAndPrefault){
+    io::File file(loop);
+    bool prefaulted = false;
+
+    file.open(file_name, std::ios::in)
+        .then([&](){
+            auto mapping = file.map();
+            mapping->advise(io::MappedFile::SEQUENTIAL);
+            mapping->advise(io::MappedFile::WILL_NEED);
+            return mapping->prefault();
+        })
+        .then([&](){
+            prefaulted = true;
+        });
+
+    loop.run();
+
+    EXPECT_TRUE(prefaulted);
+}
+
+}
+}
@@ -1,8 +1,13 @@
 
+#include <algorithm>
 #include <chrono>
 #include <cstdio>
 #include <gtest/gtest.h>
+#include <memory>
+#include <sys/socket.h>
+#include <thread>
 #include <unistd.h>
+#include <vector>
 
 #include "lw/event.hpp"
 #include "lw/io.hpp"
@@ -72,6 +77,26 @@ TEST_F(PipeTests, Read){
 
 // ---------------------------------------------------------------------------------------------- //
 
+TEST_F(PipeTests, ReadDigest){
+    io::Pipe pipe(loop);
+    auto digest = std::make_shared<memory::Crc32c>();
+
+    pipe.open(pipes[0]);
+    pipe.digest_reads(digest);
+    pipe.read([&](const std::shared_ptr<const memory::Buffer>&){});
+
+    event::wait(loop, 0s).then([&](){
+        ::write(pipes[1], content_str.c_str(), content_str.size());
+        ::close(pipes[1]);
+    });
+
+    loop.run();
+
+    EXPECT_EQ(memory::Crc32c::compute(contents.data(), contents.size()), digest->value());
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
 TEST_F(PipeTests, StopRead){
     io::Pipe pipe(loop);
     bool started = false;
@@ -109,6 +134,80 @@ TEST_F(PipeTests, StopRead){
 
 // ---------------------------------------------------------------------------------------------- //
 
+TEST_F(PipeTests, ReadSome){
+    io::Pipe pipe(loop);
+    memory::Buffer buffer(1024);
+    bool promise_called = false;
+
+    pipe.open(pipes[0]);
+    pipe.read_some(buffer).then([&](const std::size_t bytes_read){
+        promise_called = true;
+        EXPECT_EQ(contents.size(), bytes_read);
+        EXPECT_EQ(contents, memory::Buffer(buffer.data(), bytes_read));
+    });
+
+    event::wait(loop, 0s).then([&](){
+        ::write(pipes[1], content_str.c_str(), content_str.size());
+        // No close here, pulls should stop reading on their own.
+    });
+
+    loop.run();
+    EXPECT_TRUE(promise_called);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(PipeTests, ReadExactly){
+    io::Pipe pipe(loop);
+    const std::size_t half = content_str.size() / 2;
+    bool promise_called = false;
+
+    pipe.open(pipes[0]);
+    pipe.read_exactly(half)
+        .then([&](memory::Buffer&& head){
+            EXPECT_EQ(memory::Buffer(contents.data(), half), head);
+            return pipe.read_exactly(contents.size() - half);
+        })
+        .then([&](memory::Buffer&& tail){
+            promise_called = true;
+            EXPECT_EQ(memory::Buffer(contents.data() + half, contents.size() - half), tail);
+        });
+
+    // Send the data in several small pieces so the reads must be reassembled.
+    event::wait(loop, 0s).then([&](){
+        for (std::size_t i = 0; i < content_str.size(); i += 5) {
+            const std::size_t size = std::min<std::size_t>(5, content_str.size() - i);
+            ::write(pipes[1], content_str.c_str() + i, size);
+        }
+    });
+
+    loop.run();
+    EXPECT_TRUE(promise_called);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(PipeTests, ReadExactlyEndOfStream){
+    io::Pipe pipe(loop);
+    bool rejected = false;
+
+    pipe.open(pipes[0]);
+    pipe.read_exactly(contents.size() * 2).then(
+        [&](memory::Buffer&&){ FAIL() << "Should not have read past the end of the stream."; },
+        [&](const error::Exception&){ rejected = true; }
+    );
+
+    event::wait(loop, 0s).then([&](){
+        ::write(pipes[1], content_str.c_str(), content_str.size());
+        ::close(pipes[1]);
+    });
+
+    loop.run();
+    EXPECT_TRUE(rejected);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
 TEST_F(PipeTests, Write){
     io::Pipe pipe(loop);
     bool started = false;
@@ -142,5 +241,194 @@ TEST_F(PipeTests, Write){
     EXPECT_TRUE(promise_called);
 }
 
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(PipeTests, WriteChain){
+    io::Pipe pipe(loop);
+    auto chain = std::make_shared<memory::BufferChain>();
+    chain->append(memory::Buffer(contents.begin() + 3, contents.end()));
+    chain->prepend(memory::Buffer(contents.begin(), contents.begin() + 3));
+    std::size_t written = 0;
+
+    pipe.open(pipes[1]);
+    pipe.write(chain).then([&](const std::size_t bytes_written){
+        written = bytes_written;
+    });
+
+    loop.run();
+
+    memory::Buffer buffer(1024);
+    int bytes_read = ::read(pipes[0], buffer.data(), buffer.capacity());
+    EXPECT_EQ(contents.size(), written);
+    EXPECT_EQ(contents, memory::Buffer(buffer.data(), bytes_read));
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(PipeTests, PipeTo){
+    int out_pipes[2];
+    ::pipe(out_pipes);
+
+    io::Pipe source(loop);
+    io::Pipe destination(loop);
+    bool promise_called = false;
+
+    source.open(pipes[0]);
+    destination.open(out_pipes[1]);
+    source.pipe_to(destination).then([&](const std::size_t bytes_written){
+        promise_called = true;
+        EXPECT_EQ(contents.size(), bytes_written);
+    });
+
+    event::wait(loop, 0s).then([&](){
+        ::write(pipes[1], content_str.c_str(), content_str.size());
+        ::close(pipes[1]);
+    });
+
+    loop.run();
+    EXPECT_TRUE(promise_called);
+
+    memory::Buffer buffer(1024);
+    int bytes_read = ::read(out_pipes[0], buffer.data(), buffer.capacity());
+    EXPECT_EQ((int)contents.size(), bytes_read);
+    EXPECT_EQ(contents, memory::Buffer(buffer.data(), bytes_read));
+    ::close(out_pipes[0]);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(PipeTests, PipeToDigest){
+    int out_pipes[2];
+    ::pipe(out_pipes);
+
+    io::Pipe source(loop);
+    io::Pipe destination(loop);
+    auto digest = std::make_shared<memory::Crc32c>();
+
+    // A checksummed source is copied through userspace rather than spliced.
+    source.open(pipes[0]);
+    source.digest_reads(digest);
+    destination.open(out_pipes[1]);
+    source.pipe_to(destination);
+
+    event::wait(loop, 0s).then([&](){
+        ::write(pipes[1], content_str.c_str(), content_str.size());
+        ::close(pipes[1]);
+    });
+
+    loop.run();
+    ::close(out_pipes[0]);
+
+    EXPECT_EQ(memory::Crc32c::compute(contents.data(), contents.size()), digest->value());
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(PipeTests, PipeToWithBackpressure){
+    const std::size_t total_size = 4 * 1024 * 1024;
+    int in_sockets[2];
+    int out_sockets[2];
+    ::socketpair(AF_UNIX, SOCK_STREAM, 0, in_sockets);
+    ::socketpair(AF_UNIX, SOCK_STREAM, 0, out_sockets);
+
+    io::Pipe source(loop);
+    io::Pipe destination(loop);
+    io::Pipe reader(loop);
+    std::size_t bytes_received = 0;
+    bool promise_called = false;
+
+    source.open(in_sockets[0]);
+    destination.open(out_sockets[0]);
+    destination.high_water_mark(4 * 1024);
+    reader.open(out_sockets[1]);
+
+    source.pipe_to(destination).then([&](const std::size_t bytes_written){
+        promise_called = true;
+        EXPECT_EQ(total_size, bytes_written);
+    });
+
+    // Nothing drains the destination yet, so the source must stop just past the mark.
+    event::wait(loop, 200ms).then([&](){
+        EXPECT_LT(destination.high_water_mark(), destination.write_queue_size());
+        EXPECT_GE(destination.high_water_mark() + 1024, destination.write_queue_size());
+
+        reader.read([&](const std::shared_ptr<const memory::Buffer>& buffer){
+            bytes_received += buffer->size();
+            if (bytes_received == total_size) {
+                reader.stop_read();
+            }
+        });
+    });
+
+    std::thread producer([&](){
+        memory::Buffer chunk(64 * 1024);
+        chunk.set_memory('x');
+        for (std::size_t written = 0; written < total_size; written += chunk.size()) {
+            ::write(in_sockets[1], chunk.data(), chunk.size());
+        }
+        ::shutdown(in_sockets[1], SHUT_WR);
+    });
+
+    loop.run();
+    producer.join();
+    ::close(in_sockets[1]);
+
+    EXPECT_TRUE(promise_called);
+    EXPECT_EQ(total_size, bytes_received);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(PipeTests, PipeToSpliceLeavesThreadpoolFree){
+    // More idle splices than the threadpool has workers.
+    const int splice_count = 8;
+    std::vector<std::unique_ptr<io::Pipe>> streams;
+    std::vector<int> writers;
+    std::vector<int> readers;
+    int finished = 0;
+    for (int i = 0; i < splice_count; ++i) {
+        int in_pipes[2];
+        int out_pipes[2];
+        ::pipe(in_pipes);
+        ::pipe(out_pipes);
+        writers.push_back(in_pipes[1]);
+        readers.push_back(out_pipes[0]);
+
+        streams.emplace_back(new io::Pipe(loop));
+        streams.back()->open(in_pipes[0]);
+        streams.emplace_back(new io::Pipe(loop));
+        streams.back()->open(out_pipes[1]);
+        streams[2 * i]->pipe_to(*streams[2 * i + 1]).then([&](const std::size_t bytes_written){
+            EXPECT_EQ(contents.size(), bytes_written);
+            ++finished;
+        });
+    }
+
+    // Work on the threadpool still gets done while every splice waits for data.
+    bool work_done = false;
+    io::File file(loop);
+    file.open("/tmp/liblw-pipetests-splicefile")
+        .then([&](){ return file.close(); })
+        .then([&](){
+            work_done = true;
+            EXPECT_EQ(0, finished);
+            for (const int writer : writers) {
+                ::write(writer, content_str.c_str(), content_str.size());
+                ::close(writer);
+            }
+        });
+
+    loop.run();
+    std::remove("/tmp/liblw-pipetests-splicefile");
+
+    EXPECT_TRUE(work_done);
+    EXPECT_EQ(splice_count, finished);
+    for (const int reader : readers) {
+        memory::Buffer buffer(1024);
+        EXPECT_EQ((int)contents.size(), ::read(reader, buffer.data(), buffer.size()));
+        ::close(reader);
+    }
+}
+
 }
 }
@@ -0,0 +1,171 @@
+
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "lw/event.hpp"
+#include "lw/io.hpp"
+
+namespace lw {
+namespace tests {
+
+struct StatCacheTests : public testing::Test {
+    event::Loop loop;
+    std::string directory = "/tmp/liblw-statcachetests";
+    std::vector<std::string> files;
+
+    void SetUp(void) override {
+        ::mkdir(directory.c_str(), 0755);
+        for (int i = 0; i < 3; ++i) {
+            files.push_back(directory + "/file-" + std::to_string(i));
+            std::ofstream(files.back()) << "contents " << i;
+        }
+    }
+
+    void TearDown(void) override {
+        for (const auto& file : files) {
+            std::remove(file.c_str());
+        }
+        ::rmdir(directory.c_str());
+    }
+};
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(StatCacheTests, Hit){
+    io::StatCache cache(loop);
+    std::uint64_t first_size = 0;
+    std::uint64_t second_size = 0;
+
+    cache.stat(files[0])
+        .then([&](io::Stat&& info){
+            first_size = info.size;
+            return cache.stat(files[0]);
+        })
+        .then([&](io::Stat&& info){
+            second_size = info.size;
+        });
+
+    loop.run();
+
+    EXPECT_EQ(std::string("contents 0").size(), first_size);
+    EXPECT_EQ(first_size, second_size);
+    EXPECT_EQ(1, cache.size());
+    EXPECT_EQ(1, cache.stats().hits);
+    EXPECT_EQ(1, cache.stats().misses);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(StatCacheTests, Expire){
+    io::StatCache::Options options;
+    options.ttl = std::chrono::milliseconds(10);
+    io::StatCache cache(loop, options);
+
+    cache.stat(files[0])
+        .then([&](io::Stat&&){
+            return event::wait(loop, std::chrono::milliseconds(30));
+        })
+        .then([&](){
+            return cache.stat(files[0]);
+        });
+
+    loop.run();
+
+    EXPECT_EQ(0, cache.stats().hits);
+    EXPECT_EQ(2, cache.stats().misses);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(StatCacheTests, Evict){
+    io::StatCache::Options options;
+    options.max_entries = 2;
+    io::StatCache cache(loop, options);
+
+    cache.stat(files[0])
+        .then([&](io::Stat&&){ return cache.stat(files[1]); })
+        .then([&](io::Stat&&){ return cache.stat(files[2]); })
+        .then([&](io::Stat&&){ return cache.stat(files[2]); });
+
+    loop.run();
+
+    EXPECT_EQ(2, cache.size());
+    EXPECT_EQ(1, cache.stats().evictions);
+    EXPECT_EQ(1, cache.stats().hits);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(StatCacheTests, InvalidateOnChange){
+    io::StatCache cache(loop);
+    std::uint64_t changed_size = 0;
+
+    cache.stat(files[0])
+        .then([&](io::Stat&&){
+            std::ofstream(files[0], std::ios::app) << " and then some";
+            return event::wait(loop, std::chrono::milliseconds(50));
+        })
+        .then([&](){
+            return cache.stat(files[0]);
+        })
+        .then([&](io::Stat&& info){
+            changed_size = info.size;
+        });
+
+    loop.run();
+
+    EXPECT_EQ(std::string("contents 0 and then some").size(), changed_size);
+    EXPECT_LE(1, cache.stats().invalidations);
+    EXPECT_EQ(2, cache.stats().misses);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(StatCacheTests, Open){
+    io::StatCache cache(loop);
+    std::shared_ptr<io::File> first;
+    std::shared_ptr<io::File> second;
+
+    cache.open(files[1])
+        .then([&](std::shared_ptr<io::File> file){
+            first = file;
+            return cache.open(files[1]);
+        })
+        .then([&](std::shared_ptr<io::File> file){
+            second = file;
+        });
+
+    loop.run();
+
+    EXPECT_NE(nullptr, first);
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(1, cache.stats().hits);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(StatCacheTests, OpenMissing){
+    io::StatCache cache(loop);
+    const std::string missing = directory + "/missing";
+    bool rejected = false;
+
+    cache.open(missing).then(
+        [&](std::shared_ptr<io::File>&&){ FAIL() << "Should not open a missing file."; },
+        [&](const error::Exception&){ rejected = true; }
+    );
+
+    loop.run();
+
+    // Opening through the cache does not create the file.
+    EXPECT_TRUE(rejected);
+    EXPECT_NE(0, ::access(missing.c_str(), F_OK));
+}
+
+}
+}
@@ -0,0 +1,261 @@
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lw/event.hpp"
+#include "lw/io.hpp"
+#include "lw/memory.hpp"
+
+namespace lw {
+namespace tests {
+
+struct TcpTests : public testing::Test {
+    event::Loop loop;
+    std::string content_str = "an awesome message to keep";
+    std::shared_ptr<memory::Buffer> contents;
+
+    TcpTests(void):
+        contents(std::make_shared<memory::Buffer>(content_str.size()))
+    {
+        contents->copy(content_str.begin(), content_str.end());
+    }
+};
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(TcpTests, Echo){
+    io::TcpServer server(loop);
+    io::Tcp client(loop);
+    bool echoed = false;
+    bool server_done = false;
+
+    server.bind("127.0.0.1", 0);
+    server.listen([&](std::shared_ptr<io::Tcp> connection){
+        connection->nodelay(true);
+        connection->pipe_to(*connection).then([&, connection](const std::size_t bytes){
+            EXPECT_EQ(contents->size(), bytes);
+            server.close();
+        });
+    }).then([&](){
+        server_done = true;
+    });
+
+    client.connect("127.0.0.1", server.port())
+        .then([&](){
+            client.nodelay(true);
+            client.keepalive(true);
+            return client.write(contents);
+        })
+        .then([&](const std::size_t bytes_written){
+            EXPECT_EQ(contents->size(), bytes_written);
+            return client.read_exactly(contents->size());
+        })
+        .then([&](memory::Buffer&& echo){
+            EXPECT_EQ(*contents, echo);
+            echoed = true;
+            return client.shutdown();
+        });
+
+    loop.run();
+
+    EXPECT_TRUE(echoed);
+    EXPECT_TRUE(server_done);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(TcpTests, ConnectRefused){
+    io::TcpServer server(loop);
+    server.bind("127.0.0.1", 0);
+    const std::uint16_t port = server.port();
+    server.close();
+
+    io::Tcp client(loop);
+    bool rejected = false;
+    client.connect("127.0.0.1", port).then(
+        [&](){ FAIL() << "Should not connect to a closed port."; },
+        [&](const error::Exception&){ rejected = true; }
+    );
+
+    loop.run();
+    EXPECT_TRUE(rejected);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(TcpTests, ClosedServer){
+    io::TcpServer server(loop);
+    server.bind("127.0.0.1", 0);
+    server.close();
+
+    EXPECT_THROW(server.port(), io::TcpError);
+    EXPECT_THROW(server.bind("127.0.0.1", 0), io::TcpError);
+    EXPECT_THROW(server.listen([](std::shared_ptr<io::Tcp>){}), io::TcpError);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(TcpTests, InvalidAddress){
+    io::Tcp client(loop);
+    EXPECT_THROW(client.connect("not an address", 80), io::TcpError);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(TcpTests, ReusePort){
+    // Each server gets its own loop and thread, the way a multi-threaded server would share a port.
+    const int connection_count = 16;
+    struct Server {
+        Server(void):
+            server(loop),
+            timer(loop),
+            accepted(0)
+        {}
+
+        event::Loop loop;
+        io::TcpServer server;
+        event::Timeout timer;
+        std::atomic<int> accepted;
+    };
+    Server servers[2];
+    std::atomic<int> accepted(0);
+    std::atomic<bool> done(false);
+
+    servers[0].server.bind("127.0.0.1", 0, true);
+    const std::uint16_t port = servers[0].server.port();
+    servers[1].server.bind("127.0.0.1", port, true);
+    EXPECT_EQ(port, servers[1].server.port());
+
+    std::vector<std::thread> threads;
+    for (auto& server : servers) {
+        server.server.listen([&](std::shared_ptr<io::Tcp>){
+            ++server.accepted;
+            ++accepted;
+        });
+
+        // Loops cannot be reached from other threads, so each checks in for the end itself.
+        server.timer.repeat(std::chrono::milliseconds(5), [&](event::Timeout& timer){
+            if (done) {
+                server.server.close();
+                timer.stop();
+            }
+        });
+        threads.emplace_back([&](){ server.loop.run(); });
+    }
+
+    std::vector<std::unique_ptr<io::Tcp>> clients;
+    for (int i = 0; i < connection_count; ++i) {
+        clients.emplace_back(new io::Tcp(loop));
+        clients.back()->connect("127.0.0.1", port);
+    }
+    event::Timeout timer(loop);
+    timer.repeat(std::chrono::milliseconds(5), [&](event::Timeout& timer){
+        if (accepted == connection_count) {
+            clients.clear();
+            done = true;
+            timer.stop();
+        }
+    });
+
+    loop.run();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // The kernel spreads connections over both sockets, so each server should see some.
+    EXPECT_EQ(connection_count, accepted);
+    EXPECT_LT(0, servers[0].accepted);
+    EXPECT_LT(0, servers[1].accepted);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+/// @brief Measures round-trip latency and bulk throughput against a loopback echo server.
+///
+/// Timings are machine dependent, so this only runs when asked for with
+/// `--gtest_also_run_disabled_tests`.
+TEST_F(TcpTests, DISABLED_EchoBenchmark){
+    const int round_trips = 10000;
+    const std::size_t chunk_size = 1024 * 1024;
+    const std::size_t chunk_count = 64;
+    typedef std::chrono::steady_clock clock;
+
+    io::TcpServer server(loop);
+    io::Tcp client(loop);
+    server.bind("127.0.0.1", 0);
+    server.listen([&](std::shared_ptr<io::Tcp> connection){
+        connection->nodelay(true);
+        connection->pipe_to(*connection).then([&, connection](const std::size_t){
+            server.close();
+        });
+    });
+
+    auto message = std::make_shared<memory::Buffer>(64);
+    auto chunk = std::make_shared<memory::Buffer>(chunk_size);
+    message->set_memory('x');
+    chunk->set_memory('y');
+
+    int remaining = round_trips;
+    std::size_t received = 0;
+    clock::time_point start;
+    long long round_trip_us = 0;
+    long long bulk_us = 0;
+
+    auto bulk = [&](){
+        start = clock::now();
+        client.read([&](const std::shared_ptr<const memory::Buffer>& buffer){
+            received += buffer->size();
+            if (received == chunk_size * chunk_count) {
+                bulk_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                    clock::now() - start
+                ).count();
+                client.stop_read();
+            }
+        });
+        for (std::size_t i = 0; i < chunk_count; ++i) {
+            client.write(chunk);
+        }
+        client.shutdown();
+    };
+
+    std::function<void()> ping = [&](){
+        client.write(message)
+            .then([&](const std::size_t){ return client.read_exactly(message->size()); })
+            .then([&](memory::Buffer&&){
+                if (--remaining > 0) {
+                    ping();
+                    return;
+                }
+                round_trip_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                    clock::now() - start
+                ).count();
+                bulk();
+            });
+    };
+
+    client.connect("127.0.0.1", server.port()).then([&](){
+        client.nodelay(true);
+        start = clock::now();
+        ping();
+    });
+
+    loop.run();
+    EXPECT_EQ(0, remaining);
+    EXPECT_EQ(chunk_size * chunk_count, received);
+
+    std::cout
+        << round_trips << " round trips: " << (double)round_trip_us / round_trips << "us each, "
+        << (chunk_size * chunk_count >> 20) << " MiB echoed: "
+        << (double)(chunk_size * chunk_count >> 20) * 1000000 / (bulk_us ? bulk_us : 1) << " MiB/s"
+        << std::endl;
+}
+
+}
+}
@@ -0,0 +1,170 @@
+
+#include <chrono>
+#include <functional>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "lw/event.hpp"
+#include "lw/io.hpp"
+#include "lw/memory.hpp"
+
+namespace lw {
+namespace tests {
+
+struct UdpTests : public testing::Test {
+    event::Loop loop;
+    std::string content_str = "an awesome message to keep";
+    std::shared_ptr<memory::Buffer> contents;
+
+    UdpTests(void):
+        contents(std::make_shared<memory::Buffer>(content_str.size()))
+    {
+        contents->copy(content_str.begin(), content_str.end());
+    }
+};
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(UdpTests, SendReceive){
+    io::Udp server(loop);
+    io::Udp client(loop);
+    bool received = false;
+    bool sent = false;
+
+    server.bind("127.0.0.1", 0);
+    server.receive([&](io::Udp::buffer_ptr_t datagram, const sockaddr&){
+        EXPECT_EQ(*contents, *datagram);
+        received = true;
+        server.stop_receive();
+    }).then([&](const std::size_t count){
+        EXPECT_EQ(1, count);
+    });
+
+    client.send(contents, "127.0.0.1", server.port()).then([&](const std::size_t count){
+        EXPECT_EQ(1, count);
+        sent = true;
+    });
+
+    loop.run();
+
+    EXPECT_TRUE(received);
+    EXPECT_TRUE(sent);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(UdpTests, BatchSendReceive){
+    const std::size_t datagram_count = 100;
+    io::Udp server(loop);
+    io::Udp client(loop);
+    client.bind("127.0.0.1", 0);
+    server.bind("127.0.0.1", 0);
+
+    std::vector<io::Udp::buffer_ptr_t> datagrams;
+    for (std::size_t i = 0; i < datagram_count; ++i) {
+        auto datagram = std::make_shared<memory::Buffer>(sizeof(i));
+        datagram->copy((memory::byte*)&i, (memory::byte*)&i + sizeof(i));
+        datagrams.push_back(datagram);
+    }
+
+    // Hold onto every datagram so the batch buffers they view stay in use.
+    std::vector<io::Udp::buffer_ptr_t> received;
+    server.receive([&](io::Udp::buffer_ptr_t datagram, const sockaddr&){
+        received.push_back(datagram);
+        if (received.size() == datagram_count) {
+            server.stop_receive();
+        }
+    });
+
+    client.send(datagrams, "127.0.0.1", server.port()).then([&](const std::size_t count){
+        EXPECT_EQ(datagram_count, count);
+    });
+
+    loop.run();
+
+    ASSERT_EQ(datagram_count, received.size());
+    for (std::size_t i = 0; i < datagram_count; ++i) {
+        EXPECT_EQ(*datagrams[i], *received[i]);
+    }
+
+    EXPECT_EQ(datagram_count, server.stats().datagrams_received);
+    EXPECT_GE(server.stats().received_per_syscall(), 1.0);
+    EXPECT_EQ(datagram_count, client.stats().datagrams_sent);
+    EXPECT_GE(client.stats().sent_per_syscall(), 1.0);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(UdpTests, InvalidAddress){
+    io::Udp client(loop);
+    EXPECT_THROW(client.send(contents, "not an address", 80), io::UdpError);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+/// @brief Compares batched sends and receives against one datagram per call over loopback.
+///
+/// Timings are machine dependent, so this only runs when asked for with
+/// `--gtest_also_run_disabled_tests`.
+TEST_F(UdpTests, DISABLED_BatchBenchmark){
+    const std::size_t datagram_count = 200000;
+    const std::size_t round_size = 64;
+    typedef std::chrono::steady_clock clock;
+
+    std::vector<io::Udp::buffer_ptr_t> round;
+    for (std::size_t i = 0; i < round_size; ++i) {
+        auto datagram = std::make_shared<memory::Buffer>(512);
+        datagram->set_memory((memory::byte)i);
+        round.push_back(datagram);
+    }
+
+    // Datagrams go out a round at a time so loopback never has cause to drop any.
+    auto simulate = [&](const bool batched){
+        io::Udp server(loop, batched ? io::Udp::default_batch_size : 1);
+        io::Udp client(loop);
+        client.bind("127.0.0.1", 0);
+        server.bind("127.0.0.1", 0);
+
+        std::function<void()> send_round = [&](){
+            if (batched) {
+                client.send(round, "127.0.0.1", server.port());
+                return;
+            }
+            for (const auto& datagram : round) {
+                client.send(datagram, "127.0.0.1", server.port());
+            }
+        };
+
+        std::size_t received = 0;
+        server.receive([&](io::Udp::buffer_ptr_t, const sockaddr&){
+            if (++received == datagram_count) {
+                server.stop_receive();
+            }
+            else if (received % round_size == 0) {
+                send_round();
+            }
+        });
+
+        const auto start = clock::now();
+        send_round();
+        loop.run();
+        const auto elapsed = clock::now() - start;
+        EXPECT_EQ(datagram_count, received);
+
+        std::cout
+            << (batched ? "batched: " : "single:  ")
+            << std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() << "us, "
+            << client.stats().sent_per_syscall() << " sent and "
+            << server.stats().received_per_syscall() << " received per syscall"
+            << std::endl;
+    };
+
+    simulate(false);
+    simulate(true);
+}
+
+}
+}
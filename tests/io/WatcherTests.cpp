@@ -0,0 +1,211 @@
+
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <map>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "lw/event.hpp"
+#include "lw/io.hpp"
+
+namespace lw {
+namespace tests {
+
+struct WatcherTests : public testing::Test {
+    event::Loop loop;
+    std::string root = "/tmp/liblw-watchertests";
+    std::vector<std::string> files;
+    std::vector<std::string> directories;
+    std::map<std::string, int> changes;
+    std::map<std::string, int> emits;
+
+    void SetUp(void) override {
+        directories = {root, root + "/a", root + "/a/b"};
+        for (const auto& directory : directories) {
+            ::mkdir(directory.c_str(), 0755);
+        }
+        files = {root + "/file", root + "/a/b/file"};
+        for (const auto& file : files) {
+            std::ofstream(file) << "contents";
+        }
+    }
+
+    void TearDown(void) override {
+        for (const auto& file : files) {
+            std::remove(file.c_str());
+        }
+        for (auto it = directories.rbegin(); it != directories.rend(); ++it) {
+            ::rmdir(it->c_str());
+        }
+    }
+
+    void listen(io::Watcher& watcher){
+        watcher.on(watcher.change_event, [&](const std::string& path, int events){
+            changes[path] |= events;
+            ++emits[path];
+        });
+    }
+};
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(WatcherTests, Debounce){
+    io::Watcher watcher(loop);
+    listen(watcher);
+
+    watcher.watch(root)
+        .then([&](){
+            for (int i = 0; i < 20; ++i) {
+                std::ofstream(files[0], std::ios::app) << " and more";
+            }
+            return event::wait(loop, std::chrono::milliseconds(150));
+        })
+        .then([&](){
+            watcher.close();
+        });
+
+    loop.run();
+
+    EXPECT_EQ(1, emits[files[0]]);
+    EXPECT_TRUE(changes[files[0]] & io::Watcher::CHANGE);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(WatcherTests, Recursive){
+    io::Watcher::Options options;
+    options.recursive = true;
+    io::Watcher watcher(loop, options);
+    listen(watcher);
+    const std::string added = root + "/c";
+    const std::string added_file = added + "/file";
+    std::size_t initial_size = 0;
+
+    watcher.watch(root)
+        .then([&](){
+            initial_size = watcher.size();
+            std::ofstream(files[1], std::ios::app) << " and more";
+            ::mkdir(added.c_str(), 0755);
+            directories.push_back(added);
+            return event::wait(loop, std::chrono::milliseconds(100));
+        })
+        .then([&](){
+            std::ofstream(added_file) << "contents";
+            files.push_back(added_file);
+            return event::wait(loop, std::chrono::milliseconds(100));
+        })
+        .then([&](){
+            watcher.close();
+        });
+
+    loop.run();
+
+    EXPECT_EQ(3, initial_size);
+    EXPECT_EQ(1, emits[files[1]]);
+    EXPECT_TRUE(changes[added] & io::Watcher::RENAME);
+    EXPECT_EQ(1, emits[added_file]);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(WatcherTests, NestedRoots){
+    io::Watcher watcher(loop);
+    io::Watcher::Options options;
+    options.recursive = true;
+    io::Watcher recursive(loop, options);
+    const std::string nested = root + "/a";
+    std::size_t remaining = 0;
+    std::size_t recursive_remaining = 0;
+
+    // Dropping the outer root leaves the nested one, and whatever it shares, still watched.
+    watcher.watch(root)
+        .then([&](){ return watcher.watch(nested); })
+        .then([&](){ return recursive.watch(root); })
+        .then([&](){ return recursive.watch(nested); })
+        .then([&](){
+            watcher.unwatch(root);
+            recursive.unwatch(root);
+            remaining = watcher.size();
+            recursive_remaining = recursive.size();
+
+            recursive.unwatch(nested);
+            EXPECT_EQ(0, recursive.size());
+            watcher.close();
+            recursive.close();
+        });
+
+    loop.run();
+
+    EXPECT_EQ(1, remaining);
+    EXPECT_EQ(2, recursive_remaining);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(WatcherTests, Polling){
+    io::Watcher::Options options;
+    options.use_polling = true;
+    options.poll_interval = std::chrono::milliseconds(10);
+    options.debounce = std::chrono::milliseconds(10);
+    io::Watcher watcher(loop, options);
+    listen(watcher);
+
+    watcher.watch(files[0])
+        .then([&](){
+            return event::wait(loop, std::chrono::milliseconds(30));
+        })
+        .then([&](){
+            std::ofstream(files[0], std::ios::app) << " and more";
+            return event::wait(loop, std::chrono::milliseconds(100));
+        })
+        .then([&](){
+            watcher.close();
+        });
+
+    loop.run();
+
+    EXPECT_EQ(0, watcher.size());
+    EXPECT_EQ(1, emits[files[0]]);
+    EXPECT_TRUE(changes[files[0]] & io::Watcher::CHANGE);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(WatcherTests, VanishedSubtree){
+    io::Watcher::Options options;
+    options.recursive = true;
+    io::Watcher watcher(loop, options);
+    const std::string added = root + "/c";
+    const std::string missing = added + "/missing";
+    std::size_t added_size = 0;
+    std::size_t vanished_size = 0;
+
+    // The missing path is its own root, polled until it appears, so losing the tree's watch on
+    // its parent must not take it along.
+    watcher.watch(root)
+        .then([&](){ return watcher.watch(missing); })
+        .then([&](){
+            ::mkdir(added.c_str(), 0755);
+            return event::wait(loop, std::chrono::milliseconds(100));
+        })
+        .then([&](){
+            added_size = watcher.size();
+            ::rmdir(added.c_str());
+            return event::wait(loop, std::chrono::milliseconds(100));
+        })
+        .then([&](){
+            vanished_size = watcher.size();
+            watcher.close();
+        });
+
+    loop.run();
+
+    EXPECT_EQ(5, added_size);
+    EXPECT_EQ(4, vanished_size);
+}
+
+}
+}
@@ -0,0 +1,46 @@
+
+#include <cstdint>
+#include <gtest/gtest.h>
+
+#include "lw/memory.hpp"
+
+namespace lw {
+namespace tests {
+
+struct AllocatorTests : public testing::Test {};
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(AllocatorTests, AlignedRoundSize){
+    memory::AlignedAllocator allocator(512);
+    EXPECT_EQ(512, allocator.alignment());
+    EXPECT_EQ(0, allocator.round_size(0));
+    EXPECT_EQ(512, allocator.round_size(1));
+    EXPECT_EQ(512, allocator.round_size(512));
+    EXPECT_EQ(1024, allocator.round_size(513));
+
+    EXPECT_THROW(memory::AlignedAllocator(0), memory::MemoryError);
+    EXPECT_THROW(memory::AlignedAllocator(3000), memory::MemoryError);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(AllocatorTests, AlignedBuffer){
+    memory::AlignedAllocator allocator;
+    memory::Buffer buffer(5000, allocator);
+
+    EXPECT_EQ(8192, buffer.size());
+    EXPECT_EQ(0, (std::uintptr_t)buffer.data() % 4096);
+
+    // Ownership, and with it the allocator, moves along with the memory.
+    memory::byte* data = buffer.data();
+    memory::Buffer moved;
+    moved = std::move(buffer);
+    EXPECT_EQ(data, moved.data());
+    EXPECT_EQ(nullptr, buffer.data());
+    moved.set_memory(0xff);
+    EXPECT_EQ(0xff, moved[8191]);
+}
+
+}
+}
@@ -0,0 +1,212 @@
+
+#include <chrono>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "lw/memory.hpp"
+
+namespace lw {
+namespace tests {
+
+struct ArenaTests : public testing::Test {
+    /// @brief Counts live instances so destruction can be checked.
+    struct Counted {
+        Counted(int& live):
+            live(live)
+        {
+            ++live;
+        }
+
+        ~Counted(void){
+            --live;
+        }
+
+        int& live;
+    };
+};
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(ArenaTests, Allocate){
+    memory::Arena arena(1024);
+    EXPECT_EQ(0, arena.reserved());
+
+    void* first = arena.allocate(10);
+    void* second = arena.allocate(10);
+    EXPECT_EQ(1024, arena.reserved());
+    EXPECT_EQ(0, (std::uintptr_t)second % alignof(std::max_align_t));
+    EXPECT_LT((std::uintptr_t)first, (std::uintptr_t)second);
+
+    void* aligned = arena.allocate(1, 256);
+    EXPECT_EQ(0, (std::uintptr_t)aligned % 256);
+
+    // Running off the end of a chunk takes a new one, and big blocks get one of their own.
+    arena.allocate(1000);
+    EXPECT_EQ(2048, arena.reserved());
+    arena.allocate(5000);
+    EXPECT_LT(2048 + 5000, arena.reserved());
+
+    // Resetting drops the oversized chunk but keeps regular ones.
+    arena.reset();
+    EXPECT_EQ(0, arena.used());
+    EXPECT_EQ(2048, arena.reserved());
+    EXPECT_EQ(first, arena.allocate(10));
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(ArenaTests, Buffer){
+    memory::Arena arena;
+    {
+        memory::Buffer buffer(100, arena);
+        EXPECT_EQ(100, buffer.size());
+        buffer.copy("hello", "hello" + 5);
+        EXPECT_EQ('h', buffer[0]);
+        EXPECT_LE(100, arena.used());
+    }
+    EXPECT_LE(100, arena.used());
+    arena.reset();
+    EXPECT_EQ(0, arena.used());
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(ArenaTests, Make){
+    int live = 0;
+    memory::Arena arena;
+    Counted* counted = arena.make<Counted>(live);
+    arena.make<Counted>(live);
+    int* number = arena.make<int>(42);
+
+    EXPECT_EQ(&live, &counted->live);
+    EXPECT_EQ(42, *number);
+    EXPECT_EQ(2, live);
+
+    arena.reset();
+    EXPECT_EQ(0, live);
+
+    arena.make<Counted>(live);
+    EXPECT_EQ(1, live);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(ArenaTests, Scope){
+    int live = 0;
+    memory::Arena arena;
+    arena.make<Counted>(live);
+    const std::size_t used = arena.used();
+    {
+        memory::ArenaScope scope(arena);
+        scope.arena().make<Counted>(live);
+        memory::Buffer buffer(100000, scope.arena());
+        EXPECT_EQ(2, live);
+        EXPECT_LT(used, arena.used());
+    }
+
+    // Only what the scope allocated is freed.
+    EXPECT_EQ(1, live);
+    EXPECT_EQ(used, arena.used());
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(ArenaTests, OverlappingScopes){
+    int live = 0;
+    memory::Arena arena;
+    const memory::Arena::Mark start = arena.mark();
+    std::unique_ptr<memory::ArenaScope> first(new memory::ArenaScope(arena));
+    arena.make<Counted>(live);
+    std::unique_ptr<memory::ArenaScope> second(new memory::ArenaScope(arena));
+    arena.make<Counted>(live);
+    const std::size_t used = arena.used();
+
+    // Rewinding past an open scope would free memory it is still using.
+    EXPECT_THROW(arena.rewind(start), memory::MemoryError);
+    EXPECT_THROW(arena.reset(), memory::MemoryError);
+
+    // The older scope ending first leaves everything in place for the newer one.
+    first.reset();
+    EXPECT_EQ(2, live);
+    EXPECT_EQ(used, arena.used());
+
+    second.reset();
+    EXPECT_EQ(0, live);
+    EXPECT_EQ(0, arena.used());
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(ArenaTests, AllocateShared){
+    int live = 0;
+    memory::Arena arena;
+    memory::ArenaScope scope(arena);
+    {
+        auto shared = std::allocate_shared<Counted>(
+            memory::ArenaAllocator<Counted>(arena),
+            live
+        );
+        EXPECT_EQ(1, live);
+        EXPECT_LT(0, arena.used());
+
+        std::vector<int, memory::ArenaAllocator<int>> numbers{memory::ArenaAllocator<int>(arena)};
+        for (int i = 0; i < 100; ++i) {
+            numbers.push_back(i);
+        }
+        EXPECT_EQ(99, numbers.back());
+    }
+
+    // Shared pointers still destroy their objects, the arena only keeps the memory.
+    EXPECT_EQ(0, live);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+/// @brief Compares an arena against the global allocator on a simulated request load.
+///
+/// Timings are machine dependent, so this only runs when asked for with
+/// `--gtest_also_run_disabled_tests`.
+TEST_F(ArenaTests, DISABLED_RequestBenchmark){
+    const int requests = 200000;
+    const std::size_t sizes[] = {64, 256, 48, 1024, 128, 4096, 32, 512};
+    typedef std::chrono::steady_clock clock;
+
+    auto simulate = [&](memory::Arena* arena){
+        std::size_t touched = 0;
+        const auto start = clock::now();
+        for (int i = 0; i < requests; ++i) {
+            std::unique_ptr<memory::ArenaScope> scope;
+            if (arena) {
+                scope.reset(new memory::ArenaScope(*arena));
+            }
+
+            std::vector<memory::Buffer> buffers;
+            buffers.reserve(16);
+            for (const std::size_t size : sizes) {
+                buffers.push_back(arena ? memory::Buffer(size, *arena) : memory::Buffer(size));
+                buffers.back()[0] = (memory::byte)i;
+            }
+            auto state = arena
+                ? std::allocate_shared<int>(memory::ArenaAllocator<int>(*arena), i)
+                : std::make_shared<int>(i);
+            touched += buffers.size() + *state % 2;
+        }
+        const auto elapsed = clock::now() - start;
+        EXPECT_LT(0, touched);
+        return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    };
+
+    memory::Arena arena;
+    const auto malloc_us = simulate(nullptr);
+    const auto arena_us = simulate(&arena);
+
+    std::cout
+        << requests << " requests: malloc " << malloc_us << "us, arena " << arena_us << "us"
+        << std::endl;
+}
+
+}
+}
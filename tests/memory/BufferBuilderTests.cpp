@@ -0,0 +1,95 @@
+
+#include <cstring>
+#include <gtest/gtest.h>
+#include <string>
+
+#include "lw/memory.hpp"
+
+namespace lw {
+namespace tests {
+
+struct BufferBuilderTests : public testing::Test {};
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(BufferBuilderTests, Append){
+    memory::BufferBuilder builder;
+    EXPECT_TRUE(builder.empty());
+    EXPECT_EQ(0, builder.capacity());
+
+    const std::string piece = "0123456789";
+    std::size_t grows = 0;
+    std::size_t last_capacity = builder.capacity();
+    for (int i = 0; i < 100; ++i) {
+        builder.append(piece.data(), piece.size());
+        if (builder.capacity() != last_capacity) {
+            EXPECT_LE(last_capacity * 2, builder.capacity());
+            last_capacity = builder.capacity();
+            ++grows;
+        }
+    }
+
+    EXPECT_EQ(1000, builder.size());
+    EXPECT_GE(builder.capacity(), builder.size());
+    EXPECT_GE(6, grows);
+    EXPECT_EQ(0, std::memcmp(builder.data() + 990, piece.data(), piece.size()));
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(BufferBuilderTests, PrepareCommit){
+    memory::BufferBuilder builder(4);
+    builder.append("ab", 2);
+
+    memory::byte* spare = builder.prepare(10);
+    EXPECT_EQ(builder.data() + 2, spare);
+    EXPECT_LE(12, builder.capacity());
+    std::memcpy(spare, "cdef", 4);
+    EXPECT_EQ(2, builder.size());
+
+    builder.commit(4);
+    EXPECT_EQ(6, builder.size());
+    EXPECT_EQ("abcdef", std::string((const char*)builder.data(), builder.size()));
+
+    EXPECT_THROW(builder.commit(builder.capacity()), memory::MemoryError);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(BufferBuilderTests, Reserve){
+    memory::BufferBuilder builder;
+    builder.reserve(100);
+    EXPECT_EQ(100, builder.capacity());
+
+    const memory::byte* data = builder.data();
+    builder.append(std::string(100, 'x').data(), 100);
+    EXPECT_EQ(data, builder.data());
+
+    // Shrinking is never done.
+    builder.reserve(10);
+    EXPECT_EQ(100, builder.capacity());
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(BufferBuilderTests, Release){
+    memory::AlignedAllocator allocator(64);
+    memory::BufferBuilder builder(10, allocator);
+    builder.append("hello", 5);
+    const memory::byte* data = builder.data();
+
+    memory::Buffer buffer = builder.release();
+
+    EXPECT_EQ(data, buffer.data());
+    EXPECT_EQ(5, buffer.size());
+    EXPECT_EQ("hello", std::string((const char*)buffer.data(), buffer.size()));
+    EXPECT_EQ(0, builder.size());
+    EXPECT_EQ(0, builder.capacity());
+
+    // The builder can carry on with fresh memory.
+    builder.append("again", 5);
+    EXPECT_EQ(5, builder.size());
+}
+
+}
+}
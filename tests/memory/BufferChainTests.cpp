@@ -0,0 +1,111 @@
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+#include "lw/memory.hpp"
+
+namespace lw {
+namespace tests {
+
+struct BufferChainTests : public testing::Test {
+    memory::BufferChain chain;
+
+    memory::Buffer make(const std::string& str){
+        memory::Buffer buffer(str.size());
+        buffer.copy(str.begin(), str.end());
+        return buffer;
+    }
+
+    std::string join(const memory::BufferChain& pieces){
+        std::string str;
+        for (const auto& piece : pieces) {
+            str.append((const char*)piece.data(), piece.size());
+        }
+        return str;
+    }
+
+    void SetUp(void) override {
+        chain.append(make("world"));
+        chain.prepend(make("hello "));
+        chain.append(memory::Buffer());
+        chain.append(make("!"));
+    }
+};
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(BufferChainTests, AppendPrepend){
+    EXPECT_EQ(12, chain.size());
+    EXPECT_EQ(3, chain.count());
+    EXPECT_EQ("hello world!", join(chain));
+
+    memory::BufferChain other;
+    other.append(make(" bye"));
+    chain.append(std::move(other));
+    EXPECT_TRUE(other.empty());
+    EXPECT_EQ("hello world! bye", join(chain));
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(BufferChainTests, SplitAt){
+    const memory::byte* world = (chain.begin() + 1)->data();
+    memory::BufferChain head = chain.split_at(8);
+
+    EXPECT_EQ("hello wo", join(head));
+    EXPECT_EQ("rld!", join(chain));
+    EXPECT_EQ(8, head.size());
+    EXPECT_EQ(4, chain.size());
+
+    // The split piece is shared rather than copied.
+    EXPECT_EQ(world, (head.begin() + 1)->data());
+    EXPECT_EQ(world + 2, chain.begin()->data());
+
+    memory::BufferChain rest = chain.split_at(100);
+    EXPECT_EQ("rld!", join(rest));
+    EXPECT_TRUE(chain.empty());
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(BufferChainTests, Consume){
+    chain.consume(3);
+    EXPECT_EQ("lo world!", join(chain));
+    chain.consume(3);
+    EXPECT_EQ("world!", join(chain));
+    EXPECT_EQ(2, chain.count());
+    chain.consume(100);
+    EXPECT_TRUE(chain.empty());
+    EXPECT_EQ(0, chain.count());
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(BufferChainTests, UvBuffers){
+    std::vector<uv_buf_t> buffers = chain.uv_buffers();
+
+    ASSERT_EQ(3, buffers.size());
+    auto piece = chain.begin();
+    for (const auto& buffer : buffers) {
+        EXPECT_EQ((const char*)piece->data(), buffer.base);
+        EXPECT_EQ(piece->size(), buffer.len);
+        ++piece;
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(BufferChainTests, Linearize){
+    const memory::Buffer& joined = chain.linearize();
+
+    EXPECT_EQ(12, joined.size());
+    EXPECT_EQ("hello world!", std::string((const char*)joined.data(), joined.size()));
+    EXPECT_EQ(1, chain.count());
+
+    // Once linear, there is nothing left to copy.
+    EXPECT_EQ(joined.data(), chain.linearize().data());
+}
+
+}
+}
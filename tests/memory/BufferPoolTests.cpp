@@ -0,0 +1,151 @@
+
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <memory>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "lw/memory.hpp"
+
+namespace lw {
+namespace tests {
+
+struct BufferPoolTests : public testing::Test {};
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(BufferPoolTests, SizeClasses){
+    memory::BufferPool pool;
+    EXPECT_EQ(memory::BufferPool::min_class_size, pool.round_size(0));
+    EXPECT_EQ(memory::BufferPool::min_class_size, pool.round_size(1));
+    EXPECT_EQ(128, pool.round_size(65));
+    EXPECT_EQ(1024, pool.round_size(1024));
+    EXPECT_EQ(2048, pool.round_size(1025));
+
+    const std::size_t largest = memory::BufferPool::max_class_size;
+    const std::size_t huge = largest + 1;
+    EXPECT_EQ(largest, pool.round_size(largest));
+    EXPECT_EQ(huge, pool.round_size(huge));
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(BufferPoolTests, Reuse){
+    memory::BufferPool pool;
+    void* first = pool.allocate(pool.round_size(100));
+    pool.deallocate(first);
+    EXPECT_EQ(first, pool.allocate(pool.round_size(120)));
+    EXPECT_EQ(128, pool.reserved());
+
+    // Other classes get their own blocks.
+    void* other = pool.allocate(pool.round_size(300));
+    EXPECT_NE(first, other);
+    EXPECT_EQ(128 + 512, pool.reserved());
+
+    pool.deallocate(first);
+    pool.deallocate(other);
+    pool.trim();
+    EXPECT_EQ(0, pool.reserved());
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(BufferPoolTests, Buffer){
+    memory::BufferPool pool;
+    memory::byte* data = nullptr;
+    {
+        memory::Buffer buffer(1000, pool);
+        EXPECT_EQ(1024, buffer.size());
+        data = buffer.data();
+
+        // Slices keep the block out of the pool until they are gone too.
+        memory::Buffer slice = buffer.slice(10, 20);
+        memory::Buffer moved(std::move(buffer));
+    }
+
+    memory::Buffer again(1024, pool);
+    EXPECT_EQ(data, again.data());
+    EXPECT_EQ(1024, pool.reserved());
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(BufferPoolTests, ExactBuffer){
+    memory::BufferPool pool;
+    memory::Buffer pooled(1000, &pool);
+    EXPECT_EQ(1000, pooled.size());
+    EXPECT_EQ(1024, pool.reserved());
+
+    memory::Buffer plain(1000, nullptr);
+    EXPECT_EQ(1000, plain.size());
+    EXPECT_EQ(1024, pool.reserved());
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(BufferPoolTests, ThreadCaches){
+    memory::BufferPool pool(0, 4);
+    std::vector<void*> blocks;
+    std::thread worker([&](){
+        for (int i = 0; i < 10; ++i) {
+            blocks.push_back(pool.allocate(256));
+        }
+        for (void* block : blocks) {
+            pool.deallocate(block);
+        }
+    });
+    worker.join();
+
+    // The worker's cache went to the depot when it exited, so nothing new is needed here.
+    EXPECT_EQ(10 * 256, pool.reserved());
+    for (int i = 0; i < 10; ++i) {
+        void* block = pool.allocate(256);
+        EXPECT_NE(blocks.end(), std::find(blocks.begin(), blocks.end(), block));
+    }
+    EXPECT_EQ(10 * 256, pool.reserved());
+
+    for (void* block : blocks) {
+        pool.deallocate(block);
+    }
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(BufferPoolTests, Limit){
+    memory::BufferPool pool(1024);
+    EXPECT_EQ(1024, pool.limit());
+
+    void* first = pool.allocate(512);
+    void* second = pool.allocate(512);
+    EXPECT_THROW(pool.allocate(64), std::bad_alloc);
+    EXPECT_EQ(1024, pool.reserved());
+
+    // Cached blocks are freed to make room before giving up.
+    pool.deallocate(first);
+    void* small = pool.allocate(64);
+    EXPECT_EQ(512 + 64, pool.reserved());
+
+    EXPECT_THROW(memory::Buffer(memory::BufferPool::max_class_size * 2, pool), std::bad_alloc);
+
+    pool.deallocate(second);
+    pool.deallocate(small);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(BufferPoolTests, Oversized){
+    memory::BufferPool pool;
+    const std::size_t huge = memory::BufferPool::max_class_size * 3;
+    {
+        memory::Buffer buffer(huge, pool);
+        EXPECT_EQ(huge, buffer.size());
+        EXPECT_EQ(huge, pool.reserved());
+    }
+
+    // Blocks too big for any class go straight back to the system.
+    EXPECT_EQ(0, pool.reserved());
+}
+
+}
+}
@@ -2,6 +2,7 @@
 #include <algorithm>
 #include <exception>
 #include <gtest/gtest.h>
+#include <memory>
 #include <string>
 #include <tuple>
 
@@ -49,6 +50,8 @@ TEST_F (BufferTests, MoveConstructor) {
 
     EXPECT_EQ(size, buffer2->size());
     EXPECT_EQ((memory::byte*)data, buffer2->data());
+    EXPECT_EQ(0, buffer->size());
+    EXPECT_EQ(nullptr, buffer->data());
 
     EXPECT_NO_THROW({ delete buffer; });
 
@@ -70,6 +73,8 @@ TEST_F (BufferTests, MoveOwnedConstructor) {
 
     EXPECT_EQ(size, buffer2->size());
     EXPECT_EQ((memory::byte*)data, buffer2->data());
+    EXPECT_EQ(0, buffer->size());
+    EXPECT_EQ(nullptr, buffer->data());
 
     EXPECT_NO_THROW({ delete buffer; });
 
@@ -258,5 +263,64 @@ TEST_F (BufferTests, EqualityOperator) {
     EXPECT_EQ(b1, b5);
 }
 
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F (BufferTests, Slice) {
+    struct CountingAllocator : public memory::Allocator {
+        int frees = 0;
+        void* allocate(const std::size_t size) override { return new memory::byte[size]; }
+        void deallocate(void* data) override { delete[] (memory::byte*)data; ++frees; }
+    } allocator;
+
+    memory::Buffer slice;
+    {
+        memory::Buffer buffer(20, allocator);
+        for (std::size_t i = 0; i < buffer.size(); ++i) {
+            buffer[i] = (memory::byte)i;
+        }
+        EXPECT_FALSE(buffer.shared());
+
+        slice = buffer.slice(5, 10);
+        EXPECT_TRUE(buffer.shared());
+        EXPECT_EQ(buffer.data() + 5, slice.data());
+
+        // Slices of slices share the same block, and are cut short at the end.
+        memory::Buffer tail = slice.slice(8, 100);
+        EXPECT_EQ(2, tail.size());
+        EXPECT_EQ(13, tail[0]);
+    }
+
+    // The slice keeps the memory alive after the buffer is gone.
+    EXPECT_EQ(0, allocator.frees);
+    EXPECT_EQ(10, slice.size());
+    EXPECT_EQ(5, slice[0]);
+    EXPECT_EQ(14, slice[9]);
+
+    slice = memory::Buffer();
+    EXPECT_EQ(1, allocator.frees);
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F (BufferTests, View) {
+    bool released = false;
+    memory::Buffer* chunk = new memory::Buffer(16);
+    chunk->set_memory('v');
+    std::shared_ptr<const memory::Buffer> pointer(chunk, [&](memory::Buffer* buffer){
+        released = true;
+        delete buffer;
+    });
+
+    memory::Buffer view = memory::Buffer::view(pointer, 4, 8);
+    pointer.reset();
+
+    EXPECT_FALSE(released);
+    EXPECT_EQ(8, view.size());
+    EXPECT_EQ('v', view[7]);
+
+    view = memory::Buffer();
+    EXPECT_TRUE(released);
+}
+
 }
 }
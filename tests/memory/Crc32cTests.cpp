@@ -0,0 +1,52 @@
+
+#include <algorithm>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <string>
+
+#include "lw/memory.hpp"
+
+namespace lw {
+namespace tests {
+
+struct Crc32cTests : public testing::Test {};
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(Crc32cTests, KnownValues){
+    const std::string check = "123456789";
+    EXPECT_EQ(0x00000000, memory::Crc32c::compute(nullptr, 0));
+    EXPECT_EQ(0xe3069283, memory::Crc32c::compute(check.data(), check.size()));
+
+    memory::Buffer zeros(32);
+    zeros.set_memory(0);
+    memory::Crc32c crc;
+    crc.update(zeros);
+    EXPECT_EQ(0x8a9136aa, crc.value());
+
+    crc.reset();
+    EXPECT_EQ(0x00000000, crc.value());
+}
+
+// ---------------------------------------------------------------------------------------------- //
+
+TEST_F(Crc32cTests, Incremental){
+    memory::Buffer data(1000);
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] = (memory::byte)(i * 31 + 7);
+    }
+    const std::uint32_t expected = memory::Crc32c::compute(data.data(), data.size());
+
+    // Odd split points exercise the unaligned head and tail handling.
+    memory::Crc32c crc;
+    std::size_t offset = 0;
+    for (std::size_t step = 1; offset < data.size(); step += 3) {
+        const std::size_t size = std::min(step, data.size() - offset);
+        crc.update(data.data() + offset, size);
+        offset += size;
+    }
+    EXPECT_EQ(expected, crc.value());
+}
+
+}
+}